@@ -0,0 +1,369 @@
+// reference client for the binary protocol (src/stratum/binary_protocol.hpp):
+// sets up the connection, opens its channel, waits for a job and submits
+// random shares to it, printing every message and the bytes a share cost
+// on the wire.
+//
+// binary_client --port=4445 --user=RSicKPooLFbBeWZEgVrAkCxfAkPRQYwSnC.ref
+//               --shares=10
+//
+// the shares aren't mined, the pool is expected to reject them as low
+// difficulty. one blocking connection, nothing is pipelined.
+#include <arpa/inet.h>
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "binary_protocol.hpp"
+
+using Clock = std::chrono::steady_clock;
+using MsgType = BinaryProtocol::MsgType;
+
+struct ClientConfig
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 4445;
+    std::string user = "RSicKPooLFbBeWZEgVrAkCxfAkPRQYwSnC.ref";
+    uint32_t shares = 10;
+};
+
+struct Frame
+{
+    MsgType type;
+    std::string payload;
+};
+
+class BinaryClient
+{
+   public:
+    explicit BinaryClient(int fd) : fd(fd) {}
+
+    template <typename Msg>
+    bool Send(const Msg& msg)
+    {
+        std::array<char, Msg::MAX_SIZE> frame;
+        const size_t size = BinaryProtocol::Encode(frame.data(), msg);
+        sent_bytes += size;
+
+        for (size_t pos = 0; pos < size;)
+        {
+            const ssize_t sent =
+                send(fd, frame.data() + pos, size - pos, MSG_NOSIGNAL);
+            if (sent == -1)
+            {
+                if (errno == EINTR) continue;
+                fmt::print(stderr, "send: {}\n", std::strerror(errno));
+                return false;
+            }
+            pos += sent;
+        }
+        return true;
+    }
+
+    // blocks for the next frame
+    std::optional<Frame> Read()
+    {
+        while (true)
+        {
+            std::optional<Frame> res;
+            size_t start = 0;
+            const FrameStatus status = BinaryProtocol::Frame(
+                in.data(), start, in.size(),
+                [&](MsgType type, std::string_view payload)
+                {
+                    if (!res) res = Frame{type, std::string(payload)};
+                });
+
+            if (status != FrameStatus::OK)
+            {
+                fmt::print(stderr, "bad frame from the pool\n");
+                return std::nullopt;
+            }
+
+            if (res)
+            {
+                // only the first frame is taken, the rest is split again
+                const size_t size =
+                    BinaryProtocol::HEADER_SIZE + res->payload.size();
+                in.erase(0, size);
+                return res;
+            }
+
+            char buff[4096];
+            const ssize_t got = recv(fd, buff, sizeof(buff), 0);
+            if (got <= 0)
+            {
+                if (got == -1 && errno == EINTR) continue;
+                fmt::print(stderr, "pool closed the connection\n");
+                return std::nullopt;
+            }
+            in.append(buff, got);
+        }
+    }
+
+    size_t SentBytes() const { return sent_bytes; }
+
+   private:
+    const int fd;
+    std::string in;
+    size_t sent_bytes = 0;
+};
+
+template <typename Msg>
+static bool Decode(const Frame& frame, Msg& msg)
+{
+    if (frame.type != Msg::TYPE ||
+        !BinaryProtocol::Decode(frame.payload, msg))
+    {
+        fmt::print(stderr, "unexpected message type {:#04x}\n",
+                   static_cast<uint8_t>(frame.type));
+        return false;
+    }
+    return true;
+}
+
+static std::string TargetHex(const std::array<uint8_t, 32>& target)
+{
+    // big endian, as it's usually shown
+    std::string res;
+    for (auto it = target.rbegin(); it != target.rend(); it++)
+    {
+        fmt::format_to(std::back_inserter(res), "{:02x}", *it);
+    }
+    return res;
+}
+
+// the messages that may arrive at any time after the channel is open
+static bool HandlePush(const Frame& frame,
+                       std::optional<BinaryProtocol::NewMiningJob>& job)
+{
+    if (frame.type == MsgType::NEW_MINING_JOB)
+    {
+        BinaryProtocol::NewMiningJob msg;
+        if (!Decode(frame, msg)) return false;
+        fmt::print("job {:08x}, clean: {}, time: {}, bits: {:08x}\n",
+                   msg.job_id, msg.clean, msg.min_time, msg.bits);
+        job = msg;
+        return true;
+    }
+
+    BinaryProtocol::SetTarget msg;
+    if (!Decode(frame, msg)) return false;
+    fmt::print("target: {}\n", TargetHex(msg.target));
+    return true;
+}
+
+static bool Run(BinaryClient& client, const ClientConfig& cfg)
+{
+    if (!client.Send(BinaryProtocol::SetupConnection{
+            .min_version = BinaryProtocol::VERSION,
+            .max_version = BinaryProtocol::VERSION,
+            .flags = 0,
+            .user_agent = "binary_client/1"}))
+    {
+        return false;
+    }
+
+    auto frame = client.Read();
+    if (!frame) return false;
+    if (frame->type == MsgType::SETUP_CONNECTION_ERROR)
+    {
+        BinaryProtocol::SetupConnectionError err;
+        if (Decode(*frame, err))
+        {
+            fmt::print("setup failed: {}\n", err.error);
+        }
+        return false;
+    }
+
+    BinaryProtocol::SetupConnectionSuccess setup;
+    if (!Decode(*frame, setup)) return false;
+    fmt::print("setup: version {}\n", setup.used_version);
+
+    if (!client.Send(BinaryProtocol::OpenChannel{1, cfg.user})) return false;
+
+    frame = client.Read();
+    if (!frame) return false;
+    if (frame->type == MsgType::OPEN_MINING_CHANNEL_ERROR)
+    {
+        BinaryProtocol::OpenChannelError err;
+        if (Decode(*frame, err))
+        {
+            fmt::print("open channel failed: {}\n", err.error);
+        }
+        return false;
+    }
+
+    BinaryProtocol::OpenChannelSuccess channel;
+    if (!Decode(*frame, channel)) return false;
+    fmt::print("channel: extranonce {:08x}, target: {}\n", channel.extranonce,
+               TargetHex(channel.target));
+
+    std::optional<BinaryProtocol::NewMiningJob> job;
+    while (!job)
+    {
+        frame = client.Read();
+        if (!frame || !HandlePush(*frame, job)) return false;
+    }
+
+    std::mt19937_64 rng(std::random_device{}());
+    std::string nonce2(BinaryProtocol::NONCE2_SIZE, '\0');
+    // compact size of the 1344 byte solution, then the job's prefix
+    std::string solution(BinaryProtocol::SOLUTION_FIELD_SIZE, '\0');
+    solution[0] = static_cast<char>(0xfd);
+    solution[1] = static_cast<char>(0x40);
+    solution[2] = static_cast<char>(0x05);
+
+    const size_t setup_bytes = client.SentBytes();
+    uint32_t accepted = 0;
+    Clock::duration total_latency{};
+
+    for (uint32_t i = 0; i < cfg.shares; i++)
+    {
+        for (auto& c : nonce2) c = static_cast<char>(rng());
+        std::memcpy(solution.data() + 3, job->solution_prefix.data(),
+                    job->solution_prefix.size());
+        for (size_t j = 3 + job->solution_prefix.size(); j < solution.size();
+             j++)
+        {
+            solution[j] = static_cast<char>(rng());
+        }
+
+        const auto sent_time = Clock::now();
+        if (!client.Send(BinaryProtocol::SubmitShare{.sequence = i,
+                                                     .job_id = job->job_id,
+                                                     .time = job->min_time,
+                                                     .nonce2 = nonce2,
+                                                     .solution = solution}))
+        {
+            return false;
+        }
+
+        // jobs and targets may come before the reply
+        while (true)
+        {
+            frame = client.Read();
+            if (!frame) return false;
+
+            if (frame->type == MsgType::SUBMIT_SHARES_SUCCESS)
+            {
+                BinaryProtocol::SubmitSuccess res;
+                if (!Decode(*frame, res)) return false;
+                fmt::print("share {}: accepted\n", res.sequence);
+                accepted++;
+                break;
+            }
+            if (frame->type == MsgType::SUBMIT_SHARES_ERROR)
+            {
+                BinaryProtocol::SubmitError res;
+                if (!Decode(*frame, res)) return false;
+                fmt::print("share {}: rejected ({})\n", res.sequence,
+                           res.error);
+                break;
+            }
+            if (!HandlePush(*frame, job)) return false;
+        }
+        total_latency += Clock::now() - sent_time;
+    }
+
+    if (cfg.shares != 0)
+    {
+        const auto avg_us = std::chrono::duration_cast<
+                                std::chrono::microseconds>(total_latency)
+                                .count() /
+                            cfg.shares;
+        fmt::print(
+            "{}/{} accepted, {} bytes per share, {} us average round trip\n",
+            accepted, cfg.shares,
+            (client.SentBytes() - setup_bytes) / cfg.shares, avg_us);
+    }
+    return true;
+}
+
+static void PrintUsage()
+{
+    fmt::print(
+        "usage: binary_client [--host=127.0.0.1] [--port=4445]\n"
+        "                     [--user=address.worker] [--shares=10]\n");
+}
+
+static bool ParseArgs(int argc, char** argv, ClientConfig& cfg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        const size_t eq = arg.find('=');
+        if (!arg.starts_with("--") || eq == std::string_view::npos)
+            return false;
+
+        const std::string_view key = arg.substr(2, eq - 2);
+        const std::string val(arg.substr(eq + 1));
+
+        if (key == "host") cfg.host = val;
+        else if (key == "port") cfg.port = std::stoi(val);
+        else if (key == "user") cfg.user = val;
+        else if (key == "shares") cfg.shares = std::stoul(val);
+        else return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    ClientConfig cfg;
+    try
+    {
+        if (!ParseArgs(argc, argv, cfg))
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    sockaddr_in pool_addr{};
+    pool_addr.sin_family = AF_INET;
+    pool_addr.sin_port = htons(cfg.port);
+    if (inet_pton(AF_INET, cfg.host.c_str(), &pool_addr.sin_addr) != 1)
+    {
+        fmt::print(stderr, "bad host: {}\n", cfg.host);
+        return 1;
+    }
+
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        fmt::print(stderr, "socket: {}\n", std::strerror(errno));
+        return 1;
+    }
+
+    const int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&pool_addr),
+                sizeof(pool_addr)) == -1)
+    {
+        fmt::print(stderr, "connect: {}\n", std::strerror(errno));
+        close(fd);
+        return 1;
+    }
+
+    BinaryClient client(fd);
+    const bool ok = Run(client, cfg);
+    close(fd);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "line_framer.hpp"
+
+// pipelined mining.submit stream, delivered in MSS sized reads that split
+// requests at arbitrary points
+static std::string MakeSubmitStream(int count)
+{
+    const std::string submit =
+        "{\"id\":4,\"method\":\"mining.submit\",\"params\":[\"RSicKPooLFbBeWZ"
+        "EgVrAkCxfAkPRQYwSnC.worker\",\"000000000000001a\",\"6e3b8b63\","
+        "\"0000000000000000000000000000000000000000000000000000\",\"fd4005" +
+        std::string(2688, 'a') + "\"]}\n";
+
+    std::string stream;
+    for (int i = 0; i < count; i++) stream += submit;
+    return stream;
+}
+
+static constexpr size_t READ_SIZE = 1448;
+static constexpr size_t BUFF_SIZE = 1024 * 24;
+
+// the previous HandleConsumeable: null terminated buffer, strchr from the
+// start after every read, memmove of the leftover after every batch
+static void BM_FrameStrchr(benchmark::State& state)
+{
+    const std::string stream = MakeSubmitStream(state.range(0));
+    std::vector<char> buff(BUFF_SIZE);
+
+    for (auto _ : state)
+    {
+        size_t pos = 0;
+        size_t lines = 0;
+
+        for (size_t off = 0; off < stream.size(); off += READ_SIZE)
+        {
+            const size_t len = std::min(READ_SIZE, stream.size() - off);
+            std::memcpy(buff.data() + pos, stream.data() + off, len);
+            pos += len;
+            buff[pos] = '\0';
+
+            char* buffer = buff.data();
+            const char* last_req_end = nullptr;
+            const char* req_start = buffer;
+            char* req_end = std::strchr(buffer, '\n');
+            while (req_end)
+            {
+                benchmark::DoNotOptimize(
+                    std::string_view(req_start, req_end - req_start));
+                lines++;
+                last_req_end = req_end;
+                req_start = req_end + 1;
+                req_end = std::strchr(req_end + 1, '\n');
+            }
+
+            if (last_req_end)
+            {
+                const size_t next_req_len = pos - (last_req_end - buffer + 1);
+                std::memmove(buffer, last_req_end + 1, next_req_len);
+                buffer[next_req_len] = '\0';
+                pos = next_req_len;
+            }
+        }
+        benchmark::DoNotOptimize(lines);
+    }
+
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+// FrameLines: only new bytes are scanned, compaction only when full
+static void BM_FrameLines(benchmark::State& state)
+{
+    const std::string stream = MakeSubmitStream(state.range(0));
+    std::vector<char> buff(BUFF_SIZE);
+
+    for (auto _ : state)
+    {
+        size_t start = 0, scan = 0, pos = 0;
+        size_t lines = 0;
+
+        for (size_t off = 0; off < stream.size(); off += READ_SIZE)
+        {
+            if (pos + READ_SIZE > buff.size())
+            {
+                std::memmove(buff.data(), buff.data() + start, pos - start);
+                scan -= start;
+                pos -= start;
+                start = 0;
+            }
+
+            const size_t len = std::min(READ_SIZE, stream.size() - off);
+            std::memcpy(buff.data() + pos, stream.data() + off, len);
+            pos += len;
+
+            FrameLines(buff.data(), start, scan, pos, BUFF_SIZE,
+                       [&](std::string_view req)
+                       {
+                           benchmark::DoNotOptimize(req);
+                           lines++;
+                       });
+
+            if (start == pos) start = scan = pos = 0;
+        }
+        benchmark::DoNotOptimize(lines);
+    }
+
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+BENCHMARK(BM_FrameStrchr)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK(BM_FrameLines)->Arg(1)->Arg(8)->Arg(64);
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/hex_utils.hpp"
+
+// 1kb: a block header / solution, 2mb: a full block's transactions
+static std::vector<uint8_t> MakeBytes(size_t size)
+{
+    std::mt19937 gen(1);
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) b = gen();
+    return bytes;
+}
+
+// the previous byte at a time loops
+static void HexlifyScalar(char* dest, const uint8_t* src, size_t size)
+{
+    constexpr const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < size; i++)
+    {
+        dest[i * 2] = hex[src[i] >> 4];
+        dest[i * 2 + 1] = hex[src[i] & 0xf];
+    }
+}
+
+static void UnhexlifyScalar(uint8_t* dest, const char* src, size_t size)
+{
+    for (size_t i = 0; i < size / 2; i++)
+    {
+        dest[i] = GetHex(src[i * 2]) * 16 + GetHex(src[i * 2 + 1]);
+    }
+}
+
+static void BM_HexlifyScalar(benchmark::State& state)
+{
+    const auto bytes = MakeBytes(state.range(0));
+    std::string hex(bytes.size() * 2, '\0');
+
+    for (auto _ : state)
+    {
+        HexlifyScalar(hex.data(), bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(hex.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+static void BM_Hexlify(benchmark::State& state)
+{
+    const auto bytes = MakeBytes(state.range(0));
+    std::string hex(bytes.size() * 2, '\0');
+
+    for (auto _ : state)
+    {
+        Hexlify(hex.data(), bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(hex.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+static void BM_UnhexlifyScalar(benchmark::State& state)
+{
+    const auto bytes = MakeBytes(state.range(0));
+    const std::string hex = HexlifyS(bytes);
+    std::vector<uint8_t> out(bytes.size());
+
+    for (auto _ : state)
+    {
+        UnhexlifyScalar(out.data(), hex.data(), hex.size());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+static void BM_Unhexlify(benchmark::State& state)
+{
+    const auto bytes = MakeBytes(state.range(0));
+    const std::string hex = HexlifyS(bytes);
+    std::vector<uint8_t> out(bytes.size());
+
+    for (auto _ : state)
+    {
+        Unhexlify(out.data(), hex.data(), hex.size());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+// validating as well, what the share path uses
+static void BM_TryUnhexlify(benchmark::State& state)
+{
+    const auto bytes = MakeBytes(state.range(0));
+    const std::string hex = HexlifyS(bytes);
+    std::vector<uint8_t> out(bytes.size());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            TryUnhexlify(out.data(), hex.data(), hex.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+BENCHMARK(BM_HexlifyScalar)->Arg(1024)->Arg(2 * 1024 * 1024);
+BENCHMARK(BM_Hexlify)->Arg(1024)->Arg(2 * 1024 * 1024);
+BENCHMARK(BM_UnhexlifyScalar)->Arg(1024)->Arg(2 * 1024 * 1024);
+BENCHMARK(BM_Unhexlify)->Arg(1024)->Arg(2 * 1024 * 1024);
+BENCHMARK(BM_TryUnhexlify)->Arg(1024)->Arg(2 * 1024 * 1024);
@@ -0,0 +1,200 @@
+// stand-in for the coin daemon's json rpc so the pool can run on a laptop
+// under the swarm. answers every method with a canned response:
+//
+// mock_daemon --port=6004 --response=getblocktemplate=template.json
+//
+// a response file holds the whole json body ({"result":...,"error":null,
+// "id":1}), methods without one get a built in default.
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std::string_view_literals;
+
+static std::map<std::string, std::string, std::less<>> responses;
+static std::atomic<uint64_t> submitted_blocks{0};
+
+static std::string_view FirstStringParam(std::string_view body)
+{
+    const size_t params = body.find("\"params\""sv);
+    if (params == std::string_view::npos) return {};
+    const size_t start = body.find('"', params + "\"params\""sv.size());
+    if (start == std::string_view::npos) return {};
+    const size_t end = body.find('"', start + 1);
+    if (end == std::string_view::npos) return {};
+    return body.substr(start + 1, end - start - 1);
+}
+
+static std::string DefaultResponse(std::string_view method,
+                                   std::string_view body)
+{
+    if (method == "validateaddress")
+    {
+        return fmt::format(
+            "{{\"result\":{{\"isvalid\":true,\"address\":\"{}\"}},"
+            "\"error\":null,\"id\":1}}",
+            FirstStringParam(body));
+    }
+    if (method == "submitblock")
+    {
+        submitted_blocks++;
+        return "{\"result\":null,\"error\":null,\"id\":1}";
+    }
+    if (method == "getidentity")
+    {
+        return "{\"result\":null,\"error\":{\"code\":-5,\"message\":"
+               "\"Identity not found\"},\"id\":1}";
+    }
+    return "{\"result\":null,\"error\":null,\"id\":1}";
+}
+
+static void HandleRpc(int fd)
+{
+    std::string req;
+    char buff[1024 * 16];
+    size_t header_end = std::string::npos;
+    size_t content_length = 0;
+
+    while (true)
+    {
+        const ssize_t len = recv(fd, buff, sizeof(buff), 0);
+        if (len <= 0)
+        {
+            close(fd);
+            return;
+        }
+        req.append(buff, len);
+
+        if (header_end == std::string::npos)
+        {
+            header_end = req.find("\r\n\r\n");
+            if (header_end == std::string::npos) continue;
+            header_end += 4;
+
+            const size_t cl = req.find("Content-Length: ");
+            if (cl != std::string::npos && cl < header_end)
+            {
+                content_length =
+                    std::stoul(req.substr(cl + sizeof("Content-Length: ") - 1));
+            }
+        }
+
+        if (req.size() >= header_end + content_length) break;
+    }
+
+    const std::string_view body =
+        std::string_view(req).substr(header_end, content_length);
+
+    std::string_view method;
+    if (const size_t pos = body.find("\"method\":\""sv);
+        pos != std::string_view::npos)
+    {
+        const size_t start = pos + "\"method\":\""sv.size();
+        method = body.substr(start, body.find('"', start) - start);
+    }
+
+    std::string res_body;
+    if (auto it = responses.find(method); it != responses.end())
+    {
+        res_body = it->second;
+    }
+    else
+    {
+        res_body = DefaultResponse(method, body);
+    }
+
+    const std::string res = fmt::format(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: {}\r\n"
+        "Connection: close\r\n\r\n{}",
+        res_body.size(), res_body);
+
+    size_t sent = 0;
+    while (sent < res.size())
+    {
+        const ssize_t len =
+            send(fd, res.data() + sent, res.size() - sent, MSG_NOSIGNAL);
+        if (len <= 0) break;
+        sent += len;
+    }
+    close(fd);
+}
+
+int main(int argc, char** argv)
+{
+    uint16_t port = 6004;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        if (arg.starts_with("--port="))
+        {
+            port = std::stoi(std::string(arg.substr(sizeof("--port=") - 1)));
+        }
+        else if (arg.starts_with("--response="))
+        {
+            arg.remove_prefix(sizeof("--response=") - 1);
+            const size_t eq = arg.find('=');
+            if (eq == std::string_view::npos)
+            {
+                fmt::print(stderr, "expected --response=<method>=<file>\n");
+                return 1;
+            }
+
+            std::ifstream file{std::string(arg.substr(eq + 1))};
+            if (!file.good())
+            {
+                fmt::print(stderr, "can't read {}\n", arg.substr(eq + 1));
+                return 1;
+            }
+            std::stringstream content;
+            content << file.rdbuf();
+            responses[std::string(arg.substr(0, eq))] = content.str();
+        }
+        else
+        {
+            fmt::print("usage: mock_daemon [--port=6004] "
+                       "[--response=<method>=<file>]...\n");
+            return 1;
+        }
+    }
+
+    const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int yes = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+            -1 ||
+        listen(listen_fd, 128) == -1)
+    {
+        fmt::print(stderr, "failed to listen on {}: {}\n", port,
+                   std::strerror(errno));
+        return 1;
+    }
+
+    fmt::print("mock daemon listening on 127.0.0.1:{} ({} canned methods)\n",
+               port, responses.size());
+
+    while (true)
+    {
+        const int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd == -1) continue;
+        // the pool opens a connection per request
+        std::thread(HandleRpc, fd).detach();
+    }
+}
@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include <simdjson.h>
+
+#include <array>
+#include <string>
+
+#include "stratum/submit_scanner.hpp"
+
+// submit lines as the miners (and the swarm) send them
+static const std::string ZEC_SUBMIT =
+    "{\"id\":4,\"method\":\"mining.submit\",\"params\":[\"RSicKPooLFbBeWZEgVrA"
+    "kCxfAkPRQYwSnC.worker\",\"0000001a\",\"6e3b8b63\",\"00000000000000000000"
+    "000000000000000000000000000000000000\",\"fd4005" +
+    std::string(2688, 'a') + "\"]}";
+static constexpr std::array<size_t, 5> ZEC_SIZES{0, 8, 8, 56, 2694};
+
+static const std::string CN_SUBMIT =
+    "{\"id\":18,\"jsonrpc\":\"2.0\",\"method\":\"eth_submitWork\",\"worker\":"
+    "\"rig1\",\"params\":[\"0x00000000deadbeef\",\"0x9d1b5f1c3a6e8b0f2c4d7a9e"
+    "1b3c5d7f9a0b2c4d6e8f1a3b5c7d9e0f2a4b6c8d\",\"0x0000000000000000000000000"
+    "000000000000000000000000000000000000000\"]}";
+static constexpr std::array<size_t, 3> CN_SIZES{18, 66, 66};
+
+// the current path: on demand iteration of the object, then each param
+// checked for its size as ParseShareParams does
+template <size_t N>
+static bool ParseSimdjson(simdjson::ondemand::parser& parser,
+                          const simdjson::padded_string& req,
+                          const std::array<size_t, N>& sizes, bool has_worker,
+                          ScannedSubmit<N>& res)
+{
+    try
+    {
+        simdjson::ondemand::document doc = parser.iterate(req);
+        simdjson::ondemand::object obj = doc.get_object();
+        res.id = obj["id"].get_int64();
+        std::string_view method = obj["method"].get_string();
+        benchmark::DoNotOptimize(method);
+        if (has_worker) res.worker = obj["worker"].get_string();
+
+        simdjson::ondemand::array params = obj["params"].get_array();
+        size_t i = 0;
+        for (auto param : params)
+        {
+            if (i == N) break;
+            if (param.get_string().get(res.params[i]) != simdjson::SUCCESS ||
+                (sizes[i] != 0 && res.params[i].size() != sizes[i]))
+            {
+                return false;
+            }
+            i++;
+        }
+    }
+    catch (const simdjson::simdjson_error&)
+    {
+        return false;
+    }
+    return true;
+}
+
+static void BM_SubmitSimdjsonZec(benchmark::State& state)
+{
+    simdjson::ondemand::parser parser;
+    const simdjson::padded_string req(ZEC_SUBMIT);
+
+    for (auto _ : state)
+    {
+        ScannedSubmit<5> res;
+        benchmark::DoNotOptimize(
+            ParseSimdjson(parser, req, ZEC_SIZES, false, res));
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetBytesProcessed(state.iterations() * ZEC_SUBMIT.size());
+}
+BENCHMARK(BM_SubmitSimdjsonZec);
+
+static void BM_SubmitScannerZec(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        ScannedSubmit<5> res;
+        benchmark::DoNotOptimize(
+            SubmitScanner::Scan(ZEC_SUBMIT, "mining.submit", ZEC_SIZES, res));
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetBytesProcessed(state.iterations() * ZEC_SUBMIT.size());
+}
+BENCHMARK(BM_SubmitScannerZec);
+
+static void BM_SubmitSimdjsonCn(benchmark::State& state)
+{
+    simdjson::ondemand::parser parser;
+    const simdjson::padded_string req(CN_SUBMIT);
+
+    for (auto _ : state)
+    {
+        ScannedSubmit<3> res;
+        benchmark::DoNotOptimize(
+            ParseSimdjson(parser, req, CN_SIZES, true, res));
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetBytesProcessed(state.iterations() * CN_SUBMIT.size());
+}
+BENCHMARK(BM_SubmitSimdjsonCn);
+
+static void BM_SubmitScannerCn(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        ScannedSubmit<3> res;
+        benchmark::DoNotOptimize(
+            SubmitScanner::Scan(CN_SUBMIT, "eth_submitWork", CN_SIZES, res));
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetBytesProcessed(state.iterations() * CN_SUBMIT.size());
+}
+BENCHMARK(BM_SubmitScannerCn);
@@ -0,0 +1,618 @@
+// synthetic miner swarm: opens many stratum connections to a local pool,
+// runs a subscribe/authorize/submit session on each and measures the time
+// from a share being written until its response arrives.
+//
+// swarm --proto=zec --conns=5000 --rate=0.2 --duration=60
+//
+// every thread owns an epoll set and a slice of the connections, shares are
+// scheduled as a poisson process per connection so the load isn't lockstep.
+#include <arpa/inet.h>
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::string_view_literals;
+using Clock = std::chrono::steady_clock;
+
+enum class Proto
+{
+    ZEC,
+    CN
+};
+
+struct SwarmConfig
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 4444;
+    Proto proto = Proto::ZEC;
+    uint32_t conns = 1000;
+    uint32_t threads = std::max(1U, std::thread::hardware_concurrency() / 2);
+    // shares per second per connection
+    double rate = 0.1;
+    uint32_t duration_sec = 30;
+    // new connections per second
+    uint32_t connect_rate = 2000;
+    uint32_t report_sec = 5;
+    std::string addr = "RSicKPooLFbBeWZEgVrAkCxfAkPRQYwSnC";
+};
+
+enum class Stage
+{
+    CONNECTING,
+    SUBSCRIBING,
+    AUTHORIZING,
+    MINING,
+    CLOSED
+};
+
+struct SwarmConn
+{
+    int fd = -1;
+    uint32_t index = 0;
+    Stage stage = Stage::CONNECTING;
+    bool blocked = false;
+    int64_t next_id = 1;
+    std::string job_id;
+    std::string job_time;
+    std::string out;
+    std::string in;
+    // request id -> time written
+    std::unordered_map<int64_t, Clock::time_point> pending;
+};
+
+// shared by all the threads, read by the reporter
+struct SwarmStats
+{
+    std::atomic<uint64_t> connected{0};
+    std::atomic<uint64_t> mining{0};
+    std::atomic<uint64_t> disconnected{0};
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> jobs{0};
+};
+
+static constexpr uint32_t VRSC_SOLUTION_HEX = (1344 + 3) * 2;
+static constexpr uint32_t VRSC_NONCE2_HEX = (32 - 4) * 2;
+
+static std::atomic<bool> running{true};
+
+// returns the n-th string literal after key, good enough for the handful of
+// flat messages the pool sends
+static std::string_view NthString(std::string_view msg, std::string_view key,
+                                  int n)
+{
+    size_t pos = msg.find(key);
+    if (pos == std::string_view::npos) return {};
+    pos += key.size();
+
+    for (int i = 0; i <= n; i++)
+    {
+        const size_t start = msg.find('"', pos);
+        if (start == std::string_view::npos) return {};
+        const size_t end = msg.find('"', start + 1);
+        if (end == std::string_view::npos) return {};
+        if (i == n) return msg.substr(start + 1, end - start - 1);
+        pos = end + 1;
+    }
+    return {};
+}
+
+static bool GetId(std::string_view msg, int64_t& id)
+{
+    const size_t pos = msg.find("\"id\":"sv);
+    if (pos == std::string_view::npos) return false;
+    const char* start = msg.data() + pos + "\"id\":"sv.size();
+    while (start < msg.data() + msg.size() && *start == ' ') start++;
+    return std::from_chars(start, msg.data() + msg.size(), id).ec ==
+           std::errc();
+}
+
+class SwarmWorker
+{
+   public:
+    SwarmWorker(const SwarmConfig& cfg, SwarmStats& stats, sockaddr_in addr,
+                uint32_t first, uint32_t count, uint32_t seed)
+        : cfg(cfg), stats(stats), pool_addr(addr), rng(seed),
+          share_delay(cfg.rate), conns(count)
+    {
+        for (uint32_t i = 0; i < count; i++) conns[i].index = first + i;
+        solution = "fd4005" + std::string(VRSC_SOLUTION_HEX - 6, '0');
+        epoll_fd = epoll_create1(0);
+    }
+
+    ~SwarmWorker()
+    {
+        for (auto& conn : conns)
+        {
+            if (conn.fd != -1) close(conn.fd);
+        }
+        close(epoll_fd);
+    }
+
+    void Run()
+    {
+        const auto start = Clock::now();
+        const auto end = start + std::chrono::seconds(cfg.duration_sec);
+        const double connect_interval_us =
+            1e6 * cfg.threads / std::max(cfg.connect_rate, 1U);
+        uint32_t opened = 0;
+        epoll_event events[256];
+
+        while (running && Clock::now() < end)
+        {
+            const auto now = Clock::now();
+            const auto elapsed_us =
+                std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                      start)
+                    .count();
+            while (opened < conns.size() &&
+                   opened * connect_interval_us <= elapsed_us)
+            {
+                Open(conns[opened++]);
+            }
+
+            const int count = epoll_wait(epoll_fd, events, 256, 1);
+            for (int i = 0; i < count; i++)
+            {
+                SwarmConn& conn = conns[events[i].data.u32];
+                if (events[i].events & (EPOLLERR | EPOLLHUP))
+                {
+                    Close(conn);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) HandleWritable(conn);
+                if (events[i].events & EPOLLIN) HandleReadable(conn);
+            }
+
+            SubmitDue(Clock::now());
+        }
+    }
+
+    std::vector<uint64_t> latencies_us;
+
+   private:
+    const SwarmConfig& cfg;
+    SwarmStats& stats;
+    const sockaddr_in pool_addr;
+    std::mt19937_64 rng;
+    std::exponential_distribution<double> share_delay;
+    std::vector<SwarmConn> conns;
+    std::string solution;
+    int epoll_fd;
+
+    using Due = std::pair<Clock::time_point, uint32_t>;
+    std::priority_queue<Due, std::vector<Due>, std::greater<>> schedule;
+
+    uint32_t Slot(const SwarmConn& conn) const
+    {
+        return static_cast<uint32_t>(&conn - conns.data());
+    }
+
+    void Open(SwarmConn& conn)
+    {
+        conn.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, IPPROTO_TCP);
+        if (conn.fd == -1)
+        {
+            fmt::print(stderr, "socket: {} (raise ulimit -n?)\n",
+                       std::strerror(errno));
+            conn.stage = Stage::CLOSED;
+            return;
+        }
+
+        const int yes = 1;
+        setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        if (connect(conn.fd, reinterpret_cast<const sockaddr*>(&pool_addr),
+                    sizeof(pool_addr)) == -1 &&
+            errno != EINPROGRESS)
+        {
+            Close(conn);
+            return;
+        }
+
+        // writable once connected
+        conn.blocked = true;
+        Watch(conn, EPOLL_CTL_ADD);
+    }
+
+    void Close(SwarmConn& conn)
+    {
+        if (conn.stage == Stage::CLOSED) return;
+        if (conn.stage == Stage::MINING) stats.mining--;
+        conn.stage = Stage::CLOSED;
+        close(conn.fd);
+        conn.fd = -1;
+        conn.pending.clear();
+        conn.out.clear();
+        stats.disconnected++;
+    }
+
+    void Write(SwarmConn& conn, std::string_view msg)
+    {
+        conn.out.append(msg);
+        Flush(conn);
+    }
+
+    // EPOLLOUT is only armed while there's something the socket didn't take
+    void Flush(SwarmConn& conn)
+    {
+        const bool was_blocked = conn.blocked;
+        while (!conn.out.empty())
+        {
+            const ssize_t sent =
+                send(conn.fd, conn.out.data(), conn.out.size(), MSG_NOSIGNAL);
+            if (sent == -1)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    Close(conn);
+                    return;
+                }
+                break;
+            }
+            conn.out.erase(0, sent);
+        }
+
+        conn.blocked = !conn.out.empty();
+        if (conn.blocked != was_blocked) Watch(conn, EPOLL_CTL_MOD);
+    }
+
+    void Watch(const SwarmConn& conn, int op)
+    {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | (conn.blocked ? EPOLLOUT : 0U);
+        ev.data.u32 = Slot(conn);
+        epoll_ctl(epoll_fd, op, conn.fd, &ev);
+    }
+
+    void HandleWritable(SwarmConn& conn)
+    {
+        if (conn.stage == Stage::CONNECTING)
+        {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0)
+            {
+                Close(conn);
+                return;
+            }
+
+            stats.connected++;
+            StartSession(conn);
+        }
+        Flush(conn);
+    }
+
+    void StartSession(SwarmConn& conn)
+    {
+        if (cfg.proto == Proto::ZEC)
+        {
+            conn.stage = Stage::SUBSCRIBING;
+            Write(conn, fmt::format("{{\"id\":{},\"method\":\"mining."
+                                    "subscribe\",\"params\":[\"SickSwarm/"
+                                    "1.0\",null,\"{}\",{}]}}\n",
+                                    conn.next_id++, cfg.host, cfg.port));
+        }
+        else
+        {
+            conn.stage = Stage::AUTHORIZING;
+            Write(conn,
+                  fmt::format("{{\"id\":{},\"method\":\"eth_submitLogin\","
+                              "\"worker\":\"swarm{}\",\"params\":[\"{}\"]}}\n",
+                              conn.next_id++, conn.index, cfg.addr));
+        }
+    }
+
+    void HandleReadable(SwarmConn& conn)
+    {
+        char buff[1024 * 16];
+        while (conn.stage != Stage::CLOSED)
+        {
+            const ssize_t len = recv(conn.fd, buff, sizeof(buff), 0);
+            if (len == 0 || (len == -1 && errno != EAGAIN))
+            {
+                Close(conn);
+                return;
+            }
+            if (len == -1) break;
+
+            const auto now = Clock::now();
+            conn.in.append(buff, len);
+
+            size_t start = 0;
+            size_t delim;
+            while ((delim = conn.in.find('\n', start)) != std::string::npos)
+            {
+                HandleMessage(
+                    conn, std::string_view(conn.in).substr(start, delim - start),
+                    now);
+                if (conn.stage == Stage::CLOSED) return;
+                start = delim + 1;
+            }
+            conn.in.erase(0, start);
+        }
+    }
+
+    void HandleMessage(SwarmConn& conn, std::string_view msg,
+                       Clock::time_point now)
+    {
+        int64_t id = 0;
+        const bool has_id = GetId(msg, id);
+
+        if (has_id)
+        {
+            if (auto it = conn.pending.find(id); it != conn.pending.end())
+            {
+                latencies_us.push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        now - it->second)
+                        .count());
+                conn.pending.erase(it);
+
+                if (msg.find("\"error\":null"sv) != std::string_view::npos)
+                    stats.accepted++;
+                else
+                    stats.rejected++;
+                return;
+            }
+        }
+
+        if (cfg.proto == Proto::ZEC)
+        {
+            if (msg.find("\"mining.notify\""sv) != std::string_view::npos)
+            {
+                conn.job_id = NthString(msg, "\"params\""sv, 0);
+                conn.job_time = NthString(msg, "\"params\""sv, 5);
+                stats.jobs++;
+                StartMining(conn);
+            }
+            else if (conn.stage == Stage::SUBSCRIBING && has_id)
+            {
+                conn.stage = Stage::AUTHORIZING;
+                Write(conn, fmt::format("{{\"id\":{},\"method\":\"mining."
+                                        "authorize\",\"params\":[\"{}."
+                                        "swarm{}\",\"x\"]}}\n",
+                                        conn.next_id++, cfg.addr,
+                                        conn.index));
+            }
+            return;
+        }
+
+        // cn: jobs come as a bare result array (both eth_getWork replies and
+        // new block pushes)
+        if (msg.find("\"result\":[\""sv) != std::string_view::npos)
+        {
+            conn.job_id = NthString(msg, "\"result\""sv, 0);
+            if (conn.job_id.starts_with("0x")) conn.job_id.erase(0, 2);
+            stats.jobs++;
+            StartMining(conn);
+        }
+        else if (conn.stage == Stage::AUTHORIZING && has_id)
+        {
+            Write(conn, fmt::format("{{\"id\":{},\"method\":\"eth_getWork\","
+                                    "\"params\":[]}}\n",
+                                    conn.next_id++));
+        }
+    }
+
+    void StartMining(SwarmConn& conn)
+    {
+        if (conn.stage == Stage::MINING) return;
+        conn.stage = Stage::MINING;
+        stats.mining++;
+        ScheduleShare(conn, Clock::now());
+    }
+
+    void ScheduleShare(const SwarmConn& conn, Clock::time_point from)
+    {
+        if (cfg.rate <= 0) return;
+        const auto delay = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(share_delay(rng)));
+        schedule.emplace(from + delay, Slot(conn));
+    }
+
+    void SubmitDue(Clock::time_point now)
+    {
+        while (!schedule.empty() && schedule.top().first <= now)
+        {
+            SwarmConn& conn = conns[schedule.top().second];
+            schedule.pop();
+            if (conn.stage != Stage::MINING) continue;
+
+            Submit(conn);
+            ScheduleShare(conn, now);
+        }
+    }
+
+    void Submit(SwarmConn& conn)
+    {
+        const int64_t id = conn.next_id++;
+        const uint64_t nonce = rng();
+        std::string msg;
+
+        if (cfg.proto == Proto::ZEC)
+        {
+            msg = fmt::format(
+                "{{\"id\":{},\"method\":\"mining.submit\",\"params\":[\"{}."
+                "swarm{}\",\"{}\",\"{}\",\"{:0>{}x}\",\"{}\"]}}\n",
+                id, cfg.addr, conn.index, conn.job_id, conn.job_time, nonce,
+                VRSC_NONCE2_HEX, solution);
+        }
+        else
+        {
+            msg = fmt::format(
+                "{{\"id\":{},\"method\":\"eth_submitWork\",\"worker\":"
+                "\"swarm{}\",\"params\":[\"0x{:016x}\",\"0x{}\",\"0x{:064x}"
+                "\"]}}\n",
+                id, conn.index, nonce, conn.job_id, 0);
+        }
+
+        conn.pending.emplace(id, Clock::now());
+        stats.sent++;
+        Write(conn, msg);
+    }
+};
+
+static uint64_t Percentile(const std::vector<uint64_t>& sorted, double percent)
+{
+    if (sorted.empty()) return 0;
+    const auto index = static_cast<size_t>(
+        std::min(sorted.size() - 1.0, sorted.size() * percent / 100.0));
+    return sorted[index];
+}
+
+static void PrintUsage()
+{
+    fmt::print(
+        "usage: swarm [--host=127.0.0.1] [--port=4444] [--proto=zec|cn]\n"
+        "             [--conns=1000] [--threads=N] [--rate=shares/s/conn]\n"
+        "             [--duration=seconds] [--connect-rate=conns/s]\n"
+        "             [--report=seconds] [--addr=payout address]\n");
+}
+
+static bool ParseArgs(int argc, char** argv, SwarmConfig& cfg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        const size_t eq = arg.find('=');
+        if (!arg.starts_with("--") || eq == std::string_view::npos)
+            return false;
+
+        const std::string_view key = arg.substr(2, eq - 2);
+        const std::string val(arg.substr(eq + 1));
+
+        if (key == "host") cfg.host = val;
+        else if (key == "port") cfg.port = std::stoi(val);
+        else if (key == "proto")
+        {
+            if (val != "zec" && val != "cn") return false;
+            cfg.proto = val == "zec" ? Proto::ZEC : Proto::CN;
+        }
+        else if (key == "conns") cfg.conns = std::stoul(val);
+        else if (key == "threads") cfg.threads = std::stoul(val);
+        else if (key == "rate") cfg.rate = std::stod(val);
+        else if (key == "duration") cfg.duration_sec = std::stoul(val);
+        else if (key == "connect-rate") cfg.connect_rate = std::stoul(val);
+        else if (key == "report") cfg.report_sec = std::stoul(val);
+        else if (key == "addr") cfg.addr = val;
+        else return false;
+    }
+    cfg.threads = std::clamp(cfg.threads, 1U, std::max(cfg.conns, 1U));
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    SwarmConfig cfg;
+    signal(SIGINT, [](int) { running = false; });
+    try
+    {
+        if (!ParseArgs(argc, argv, cfg))
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    sockaddr_in pool_addr{};
+    pool_addr.sin_family = AF_INET;
+    pool_addr.sin_port = htons(cfg.port);
+    if (inet_pton(AF_INET, cfg.host.c_str(), &pool_addr.sin_addr) != 1)
+    {
+        fmt::print(stderr, "bad host: {}\n", cfg.host);
+        return 1;
+    }
+
+    fmt::print("swarm: {} {} connections over {} threads, {} shares/s/conn, "
+               "{}s\n",
+               cfg.proto == Proto::ZEC ? "zec" : "cn", cfg.conns, cfg.threads,
+               cfg.rate, cfg.duration_sec);
+
+    SwarmStats stats;
+    std::vector<std::unique_ptr<SwarmWorker>> workers;
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < cfg.threads; i++)
+    {
+        const uint32_t count =
+            cfg.conns / cfg.threads + (i < cfg.conns % cfg.threads);
+        workers.push_back(std::make_unique<SwarmWorker>(cfg, stats, pool_addr,
+                                                        first, count, i + 1));
+        first += count;
+    }
+
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size());
+    for (auto& worker : workers)
+    {
+        threads.emplace_back([&worker] { worker->Run(); });
+    }
+
+    uint64_t last_done = 0;
+    for (uint32_t sec = cfg.report_sec; sec < cfg.duration_sec;
+         sec += cfg.report_sec)
+    {
+        std::this_thread::sleep_until(start + std::chrono::seconds(sec));
+        if (!running) break;
+        const uint64_t done = stats.accepted + stats.rejected;
+        fmt::print("[{:>4}s] connected: {}, mining: {}, dropped: {}, "
+                   "responses/s: {:.1f}\n",
+                   sec, stats.connected.load(), stats.mining.load(),
+                   stats.disconnected.load(),
+                   static_cast<double>(done - last_done) / cfg.report_sec);
+        last_done = done;
+    }
+
+    for (auto& thread : threads) thread.join();
+    const double elapsed =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint64_t> latencies;
+    for (const auto& worker : workers)
+    {
+        latencies.insert(latencies.end(), worker->latencies_us.begin(),
+                         worker->latencies_us.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const uint64_t done = stats.accepted + stats.rejected;
+    fmt::print(
+        "connected: {}, dropped: {}, jobs received: {}\n"
+        "shares sent: {}, answered: {} (accepted: {}, rejected: {})\n"
+        "throughput: {:.1f} shares/s\n"
+        "share response latency: p50={}us p99={}us p999={}us max={}us\n",
+        stats.connected.load(), stats.disconnected.load(), stats.jobs.load(),
+        stats.sent.load(), done, stats.accepted.load(),
+        stats.rejected.load(), done / elapsed, Percentile(latencies, 50),
+        Percentile(latencies, 99), Percentile(latencies, 99.9),
+        latencies.empty() ? 0 : latencies.back());
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#!/bin/bash
+# end to end stratum benchmark on one machine: databases in docker, a mock
+# daemon serving a canned block template, the pool, and the swarm against it.
+#
+# benchmark/swarm/run_swarm.sh <build dir> [swarm args...]
+# e.g. run_swarm.sh build --conns=5000 --rate=0.2 --duration=60
+#
+# VRSC uses tests/vrsc_genesis_blocktemplate.json. for ZANO set SWARM_COIN=ZANO
+# and SWARM_TEMPLATE to a captured getblocktemplate response.
+set -e
+
+SWARM_DIR=$(cd "$(dirname "$0")" && pwd)
+ROOT_DIR=$(cd "$SWARM_DIR/../.." && pwd)
+BUILD_DIR=$(cd "${1:?usage: run_swarm.sh <build dir> [swarm args...]}" && pwd)
+shift
+
+SWARM_COIN=${SWARM_COIN:-VRSC}
+SWARM_TEMPLATE=${SWARM_TEMPLATE:-$ROOT_DIR/tests/vrsc_genesis_blocktemplate.json}
+if [ "$SWARM_COIN" = "ZANO" ]; then
+    PROTO=cn
+else
+    PROTO=zec
+fi
+
+POOL_CONFIG=$SWARM_DIR/${SWARM_COIN}SWARM.json
+# miners mine to the pool's own address, it's known to be valid
+ADDR=$(sed -n 's/.*"pool_addr": "\(.*\)".*/\1/p' "$POOL_CONFIG")
+
+ulimit -n 1048576 2>/dev/null || ulimit -n "$(ulimit -Hn)"
+
+SWARM_DB=$SWARM_COIN docker compose -f "$SWARM_DIR/docker-compose.yml" up -d --wait
+
+"$BUILD_DIR/benchmark/mock_daemon" --port=6004 \
+    --response=getblocktemplate="$SWARM_TEMPLATE" &
+DAEMON_PID=$!
+
+# the pool writes its logs to the working directory
+cd "$SWARM_DIR"
+"$BUILD_DIR/SickPool" "$POOL_CONFIG" > pool.log 2>&1 &
+POOL_PID=$!
+trap 'kill $POOL_PID $DAEMON_PID 2>/dev/null' EXIT
+
+sleep 3
+"$BUILD_DIR/benchmark/swarm" --proto=$PROTO --port=4444 --addr="$ADDR" "$@"
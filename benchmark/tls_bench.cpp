@@ -0,0 +1,230 @@
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tls_acceptor.hpp"
+
+// one connection's steady state on the pool's side: a request of
+// state.range(0) bytes in, a reply out, over loopback. plaintext, tls
+// terminated in the kernel (the tls listener) and tls in userspace (what a
+// terminating proxy or SSL_read / SSL_write in the reactor would do). the
+// miner's side is encrypted in userspace in both tls cases, so the
+// difference between them is the pool's.
+//
+// SickPool_bench --benchmark_filter=Tls
+//
+// needs the tls module (modprobe tls), the ktls case is skipped without it.
+
+static const std::string REPLY = "{\"id\":4,\"result\":true,\"error\":null}\n";
+
+static std::string CertPath()
+{
+    const char* tmp = getenv("TMPDIR");
+    return std::string(tmp ? tmp : "/tmp") + "/tls_bench";
+}
+
+// a self signed p-256 certificate, written once
+static const TlsFiles& GetCertificate()
+{
+    static const TlsFiles files = []
+    {
+        TlsFiles res{CertPath() + ".crt", CertPath() + ".key"};
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* cert = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_set_issuer_name(cert, X509_get_subject_name(cert));
+        X509_sign(cert, key, EVP_sha256());
+
+        FILE* cert_file = fopen(res.cert_file.c_str(), "w");
+        PEM_write_X509(cert_file, cert);
+        fclose(cert_file);
+        FILE* key_file = fopen(res.key_file.c_str(), "w");
+        PEM_write_PrivateKey(key_file, key, nullptr, nullptr, 0, nullptr,
+                             nullptr);
+        fclose(key_file);
+
+        X509_free(cert);
+        EVP_PKEY_free(key);
+        return res;
+    }();
+    return files;
+}
+
+struct SocketPair
+{
+    int client = -1;
+    int server = -1;
+
+    SocketPair()
+    {
+        const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(listen_fd, 1);
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+
+        client = socket(AF_INET, SOCK_STREAM, 0);
+        connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        server = accept(listen_fd, nullptr, nullptr);
+        close(listen_fd);
+
+        const int yes = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+
+    ~SocketPair()
+    {
+        close(client);
+        close(server);
+    }
+};
+
+// blocking sockets, each side's handshake on its own thread
+static bool Handshake(SSL* client, SSL* server)
+{
+    int server_res = 0;
+    std::thread server_thread([&] { server_res = SSL_accept(server); });
+    const int client_res = SSL_connect(client);
+    server_thread.join();
+    return client_res == 1 && server_res == 1;
+}
+
+static void ReadFull(int fd, char* buff, size_t size)
+{
+    for (size_t got = 0; got < size;)
+    {
+        const ssize_t res = recv(fd, buff + got, size - got, 0);
+        if (res <= 0) return;
+        got += res;
+    }
+}
+
+static void SslReadFull(SSL* ssl, char* buff, size_t size)
+{
+    for (size_t got = 0; got < size;)
+    {
+        const int res = SSL_read(ssl, buff + got, size - got);
+        if (res <= 0) return;
+        got += res;
+    }
+}
+
+static void BM_TlsPlaintext(benchmark::State& state)
+{
+    SocketPair pair;
+    const std::string req(state.range(0), 'a');
+    std::vector<char> buff(req.size());
+
+    for (auto _ : state)
+    {
+        send(pair.client, req.data(), req.size(), 0);
+        ReadFull(pair.server, buff.data(), req.size());
+        send(pair.server, REPLY.data(), REPLY.size(), 0);
+        ReadFull(pair.client, buff.data(), REPLY.size());
+    }
+    state.SetBytesProcessed(state.iterations() * (req.size() + REPLY.size()));
+}
+BENCHMARK(BM_TlsPlaintext)->Arg(64)->Arg(2800)->Arg(16 * 1024);
+
+static void BM_TlsKernel(benchmark::State& state)
+{
+    SocketPair pair;
+    TlsAcceptor acceptor(GetCertificate());
+
+    SSL_CTX* client_ctx = SSL_CTX_new(TLS_client_method());
+    SSL* client = SSL_new(client_ctx);
+    SSL_set_fd(client, pair.client);
+    SSL* server = acceptor.Start(pair.server, "127.0.0.1");
+
+    // the acceptor's checks on the finished handshake
+    if (!Handshake(client, server) ||
+        acceptor.Continue(server, "127.0.0.1") !=
+            TlsAcceptor::HandshakeStatus::DONE)
+    {
+        acceptor.Release(server);
+        SSL_free(client);
+        SSL_CTX_free(client_ctx);
+        state.SkipWithError("no kernel tls (modprobe tls)");
+        return;
+    }
+    acceptor.Release(server);
+
+    const std::string req(state.range(0), 'a');
+    std::vector<char> buff(req.size());
+
+    for (auto _ : state)
+    {
+        SSL_write(client, req.data(), req.size());
+        ReadFull(pair.server, buff.data(), req.size());
+        send(pair.server, REPLY.data(), REPLY.size(), 0);
+        SslReadFull(client, buff.data(), REPLY.size());
+    }
+    state.SetBytesProcessed(state.iterations() * (req.size() + REPLY.size()));
+
+    SSL_free(client);
+    SSL_CTX_free(client_ctx);
+}
+BENCHMARK(BM_TlsKernel)->Arg(64)->Arg(2800)->Arg(16 * 1024);
+
+static void BM_TlsUserspace(benchmark::State& state)
+{
+    SocketPair pair;
+
+    SSL_CTX* server_ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate_file(server_ctx, GetCertificate().cert_file.c_str(),
+                                 SSL_FILETYPE_PEM);
+    SSL_CTX_use_PrivateKey_file(server_ctx, GetCertificate().key_file.c_str(),
+                                SSL_FILETYPE_PEM);
+    SSL_CTX* client_ctx = SSL_CTX_new(TLS_client_method());
+
+    SSL* server = SSL_new(server_ctx);
+    SSL_set_fd(server, pair.server);
+    SSL* client = SSL_new(client_ctx);
+    SSL_set_fd(client, pair.client);
+
+    if (!Handshake(client, server))
+    {
+        state.SkipWithError("handshake failed");
+    }
+    else
+    {
+        const std::string req(state.range(0), 'a');
+        std::vector<char> buff(req.size());
+
+        for (auto _ : state)
+        {
+            SSL_write(client, req.data(), req.size());
+            SslReadFull(server, buff.data(), req.size());
+            SSL_write(server, REPLY.data(), REPLY.size());
+            SslReadFull(client, buff.data(), REPLY.size());
+        }
+        state.SetBytesProcessed(state.iterations() *
+                                (req.size() + REPLY.size()));
+    }
+
+    SSL_free(server);
+    SSL_free(client);
+    SSL_CTX_free(server_ctx);
+    SSL_CTX_free(client_ctx);
+}
+BENCHMARK(BM_TlsUserspace)->Arg(64)->Arg(2800)->Arg(16 * 1024);
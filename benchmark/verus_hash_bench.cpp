@@ -1,17 +1,20 @@
 #include <benchmark/benchmark.h>
 
-#include "stratum_client.hpp"
-#include <iostream>
-#include "crypto/utils.hpp"
+#include <vector>
+
 #include "crypto/hash_wrapper.hpp"
-// #include "src/utils.hpp"
+#include "crypto/utils.hpp"
 #define BLOCK_HEADER_SIZE (140 + 3 + 1344)
+// shares differ in the nonce, which changes the clhash key seed. changing only
+// the tail would let the scalar hasher reuse its cached key
+#define NONCE_POS (4 + 32 + 32 + 32 + 4 + 4)
+// version to final sapling root, absorbed once per job
+#define STATIC_HEADER_SIZE (4 + 32 + 32 + 32)
 
-static void BM_HashBH(benchmark::State& state)
+// VRSC block #1900000:
+// 0000000000001e7f39529830644b40953cdd41e0bbb18174fe0e39c2530186c7
+static std::vector<unsigned char> GetHeader()
 {
-    // VRSC block #1900000:
-    // 0000000000001e7f39529830644b40953cdd41e0bbb18174fe0e39c2530186c7
-    HashWrapper::InitVerusHash();
     char data[] =
         "04000100e79e17888885239ed18431c469b68f6a8b1f75f609d91d0593ad0700000000"
         "00f152ad13d884b4f2b43510645c0ca0084d58e3457f334238890db8760e5e8c6f74dd"
@@ -57,18 +60,82 @@ static void BM_HashBH(benchmark::State& state)
         "0000000000000000000000000000000000000000000000000000000000000000000000"
         "0000165355000000000000000000000000";
 
-    unsigned char dataBytes[(sizeof(data)) / 2];
-    Unhexlify(dataBytes, data, sizeof(data) - 1);
+    std::vector<unsigned char> dataBytes(BLOCK_HEADER_SIZE);
+    Unhexlify(dataBytes.data(), data, sizeof(data) - 1);
+    return dataBytes;
+}
+
+// items/s is shares/s on one core
+static void BM_HashBH(benchmark::State& state)
+{
+    HashWrapper::InitVerusHash();
+    std::vector<unsigned char> dataBytes = GetHeader();
+    unsigned char res[32] = {0};
+    CVerusHashV2 hasher(SOLUTION_VERUSHHASH_V2_2);
+
+    for (auto _ : state)
+    {
+        HashWrapper::VerushashV2b2(res, dataBytes.data(), BLOCK_HEADER_SIZE,
+                                   &hasher);
+        benchmark::DoNotOptimize(res);
+        dataBytes[NONCE_POS]++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
 
+// continuing from the job's absorbed static header
+static void BM_HashBHPrefix(benchmark::State& state)
+{
+    HashWrapper::InitVerusHash();
+    std::vector<unsigned char> dataBytes = GetHeader();
     unsigned char res[32] = {0};
-    // Unhexlify()
-    StratumClient cli(0, 0, 0);
+    CVerusHashV2 hasher(SOLUTION_VERUSHHASH_V2_2);
+    const CVerusHashV2Prefix prefix(dataBytes.data(), STATIC_HEADER_SIZE);
+
+    for (auto _ : state)
+    {
+        HashWrapper::VerushashV2b2(res, dataBytes.data(), BLOCK_HEADER_SIZE,
+                                   prefix, &hasher);
+        benchmark::DoNotOptimize(res);
+        dataBytes[NONCE_POS]++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// what a hashing worker does with the shares it picked up at once, with and
+// without the job's static header absorbed
+static void BM_HashBHBatch(benchmark::State& state)
+{
+    HashWrapper::InitVerusHash();
+    const int count = state.range(0);
+    const bool use_prefix = state.range(1);
+    std::vector<std::vector<unsigned char>> headers(count, GetHeader());
+    std::vector<std::array<unsigned char, 32>> res(count);
+    std::vector<uint8_t*> out;
+    std::vector<const uint8_t*> in;
+    for (int i = 0; i < count; i++)
+    {
+        headers[i][NONCE_POS + 1] = i;
+        out.push_back(res[i].data());
+        in.push_back(headers[i].data());
+    }
+    CVerusHashV2Batch hasher(SOLUTION_VERUSHHASH_V2_2);
+    const CVerusHashV2Prefix prefix(headers[0].data(), STATIC_HEADER_SIZE);
+    std::vector<const CVerusHashV2Prefix*> prefixes(count, &prefix);
 
     for (auto _ : state)
     {
-        HashWrapper::VerushashV2b2(res, dataBytes, BLOCK_HEADER_SIZE, cli.GetHasher());
+        HashWrapper::VerushashV2b2Batch(
+            out.data(), in.data(), BLOCK_HEADER_SIZE, count, &hasher,
+            use_prefix ? prefixes.data() : nullptr);
+        benchmark::DoNotOptimize(res.data());
+        for (auto& header : headers) header[NONCE_POS]++;
     }
+    state.SetItemsProcessed(state.iterations() * count);
 }
 
 BENCHMARK(BM_HashBH);
-// BENCHMARK_MAIN();
+BENCHMARK(BM_HashBHPrefix);
+BENCHMARK(BM_HashBHBatch)
+    ->ArgNames({"count", "prefix"})
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1}});
@@ -40,6 +40,13 @@ struct CoinConfig
     double pow_fee;
     double pos_fee;
     uint16_t stratum_port;
+    // binary protocol (BinaryProtocol) listener, 0 = none. vrsc only
+    uint16_t binary_port;
+    // json lines over tls (kTLS, needs WITH_KTLS), 0 = none
+    uint16_t tls_port;
+    // pem, read if tls_port is set
+    std::string tls_cert_file;
+    std::string tls_key_file;
     uint16_t control_port;
     std::vector<RpcConfig> rpcs;
     std::vector<RpcConfig> payment_rpcs;
@@ -50,8 +57,39 @@ struct CoinConfig
     StatsConfig stats;
 
     uint32_t socket_recv_timeout_seconds;
+    // amount of socket reactor threads, 0 = one per core
+    uint32_t reactor_threads;
+    // amount of share hashing threads, 0 = one per core
+    uint32_t share_workers;
+    // pending output per connection before it's dropped as a slow consumer
+    uint32_t socket_send_high_water_kb;
+    // "epoll" or "io_uring" (needs WITH_IO_URING)
+    std::string io_engine;
     uint32_t block_poll_interval;
     uint32_t payment_interval_seconds;
     int64_t min_payout_threshold;
 };
+
+// proxy mode (--proxy): a farm's rigs mine to the proxy, which mines to the
+// pool on a few sessions and forwards the shares meeting the pool's target.
+// vrsc only
+struct ProxyConfig
+{
+    std::string symbol;
+    uint16_t stratum_port;
+    // ip:port of the pool's stratum
+    std::string upstream_host;
+    // what the sessions authorize as, address.worker
+    std::string upstream_user;
+    // connections to the pool, each serves the rigs of some of the reactors
+    uint32_t upstream_sessions;
+
+    DifficultyConfig diff_config;
+
+    // as in CoinConfig
+    uint32_t reactor_threads;
+    uint32_t share_workers;
+    uint32_t socket_send_high_water_kb;
+    std::string io_engine;
+};
 #endif
\ No newline at end of file
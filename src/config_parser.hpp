@@ -71,6 +71,10 @@ void ParseCoinConfig(const simdjson::padded_string& json, CoinConfig& cnfg,
     AssignJson("symbol", cnfg.symbol, configDoc, logger);
 
     AssignJson("stratum_port", cnfg.stratum_port, configDoc, logger);
+    AssignJson("binary_port", cnfg.binary_port, configDoc, logger);
+    AssignJson("tls_port", cnfg.tls_port, configDoc, logger);
+    AssignJson("tls_cert_file", cnfg.tls_cert_file, configDoc, logger);
+    AssignJson("tls_key_file", cnfg.tls_key_file, configDoc, logger);
     AssignJson("control_port", cnfg.control_port, configDoc, logger);
 
     ondemand::object ob = configDoc["redis"].get_object();
@@ -99,6 +103,11 @@ void ParseCoinConfig(const simdjson::padded_string& json, CoinConfig& cnfg,
 
     AssignJson("socket_recv_timeout_seconds", cnfg.socket_recv_timeout_seconds,
                configDoc, logger);
+    AssignJson("reactor_threads", cnfg.reactor_threads, configDoc, logger);
+    AssignJson("share_workers", cnfg.share_workers, configDoc, logger);
+    AssignJson("socket_send_high_water_kb", cnfg.socket_send_high_water_kb,
+               configDoc, logger);
+    AssignJson("io_engine", cnfg.io_engine, configDoc, logger);
     AssignJson("pow_fee", cnfg.pow_fee, configDoc, logger);
     AssignJson("pos_fee", cnfg.pos_fee, configDoc, logger);
 
@@ -153,4 +162,33 @@ void ParseCoinConfig(const simdjson::padded_string& json, CoinConfig& cnfg,
     }
 }
 
+void ParseProxyConfig(const simdjson::padded_string& json, ProxyConfig& cnfg,
+                      const Logger& logger)
+{
+    using namespace simdjson;
+    ondemand::parser confParser;
+    ondemand::document configDoc = confParser.iterate(json);
+
+    AssignJson("symbol", cnfg.symbol, configDoc, logger);
+    AssignJson("stratum_port", cnfg.stratum_port, configDoc, logger);
+    AssignJson("upstream_host", cnfg.upstream_host, configDoc, logger);
+    AssignJson("upstream_user", cnfg.upstream_user, configDoc, logger);
+    AssignJson("upstream_sessions", cnfg.upstream_sessions, configDoc, logger);
+
+    ondemand::object ob = configDoc["difficulty"].get_object();
+
+    AssignJson("default_diff", cnfg.diff_config.default_diff, ob, logger);
+    AssignJson("minimum_diff", cnfg.diff_config.minimum_diff, ob, logger);
+    AssignJson("target_shares_rate", cnfg.diff_config.target_shares_rate, ob,
+               logger);
+    AssignJson("retarget_interval", cnfg.diff_config.retarget_interval, ob,
+               logger);
+
+    AssignJson("reactor_threads", cnfg.reactor_threads, configDoc, logger);
+    AssignJson("share_workers", cnfg.share_workers, configDoc, logger);
+    AssignJson("socket_send_high_water_kb", cnfg.socket_send_high_water_kb,
+               configDoc, logger);
+    AssignJson("io_engine", cnfg.io_engine, configDoc, logger);
+}
+
 #endif
\ No newline at end of file
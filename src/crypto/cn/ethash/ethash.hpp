@@ -160,6 +160,25 @@ const epoch_context& get_global_epoch_context(int epoch_number);
 /// Get global shared epoch context with full dataset initialized.
 std::shared_ptr<epoch_context_full> get_global_epoch_context_full(int epoch_number);
 
+/// Whether the global shared epoch context with full dataset for the epoch is
+/// built.
+bool has_global_epoch_context_full(int epoch_number);
+
+/// Builds the global shared epoch context with full dataset for the epoch
+/// unless it is already, so threads switching to the epoch find it ready.
+/// The contexts of up to three consecutive epochs are kept, an older epoch
+/// never evicts a newer one.
+///
+/// @return  The context or null in case of memory allocation failure.
+std::shared_ptr<epoch_context_full> prepare_global_epoch_context_full(int epoch_number);
+
+/// Releases the global shared epoch contexts with full dataset of the epochs
+/// before the given one, and never shares them again (a later request gets a
+/// context of its own).
+///
+/// @return  Whether a context was released.
+bool release_global_epoch_contexts_full_before(int epoch_number);
+
 typedef int (custom_log_level_function)();
 typedef void (custom_log_function)(const std::string& m, bool add_callstack);
 
@@ -4,6 +4,7 @@
 
 #include "ethash-internal.hpp"
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -27,10 +28,59 @@ std::mutex shared_context_mutex;
 std::shared_ptr<epoch_context> shared_context;
 thread_local std::shared_ptr<epoch_context> thread_local_context;
 
+// up to three epochs, keyed by epoch: the previous one for late shares
+// (until it's released), the current one and the next one built ahead of the
+// boundary. lookups don't lock, the mutex only keeps two threads from
+// building the same epoch
+constexpr int shared_context_full_slots = 3;
 std::mutex shared_context_full_mutex;
-std::shared_ptr<epoch_context_full> shared_context_full;
+std::atomic<std::shared_ptr<epoch_context_full>> shared_contexts_full[shared_context_full_slots];
+// epochs below were released, they aren't shared again
+std::atomic<int> oldest_shared_epoch_full{0};
 thread_local std::shared_ptr<epoch_context_full> thread_local_context_full;
 
+std::atomic<std::shared_ptr<epoch_context_full>>& shared_context_full_slot(int epoch_number)
+{
+    return shared_contexts_full[epoch_number % shared_context_full_slots];
+}
+
+std::shared_ptr<epoch_context_full> find_shared_context_full(int epoch_number)
+{
+    auto context = shared_context_full_slot(epoch_number).load(std::memory_order_acquire);
+    if (context && context->epoch_number == epoch_number)
+        return context;
+    return nullptr;
+}
+
+std::shared_ptr<epoch_context_full> build_shared_context_full(int epoch_number)
+{
+    std::unique_lock<std::mutex> lock{shared_context_full_mutex};
+
+    // built while waiting for the lock
+    if (auto context = find_shared_context_full(epoch_number))
+        return context;
+
+    auto& slot = shared_context_full_slot(epoch_number);
+
+    // a share from epochs ago never evicts a newer (prewarmed) epoch nor
+    // brings a released one back, it gets a context of its own, kept only by
+    // the asking thread
+    if (auto newer = slot.load(std::memory_order_acquire);
+        (newer && newer->epoch_number > epoch_number) ||
+        epoch_number < oldest_shared_epoch_full.load(std::memory_order_relaxed))
+    {
+        lock.unlock();
+        return create_epoch_context_full(epoch_number);
+    }
+
+    // Release the shared pointer of the obsoleted context.
+    slot.store(nullptr, std::memory_order_release);
+
+    std::shared_ptr<epoch_context_full> context = create_epoch_context_full(epoch_number);
+    slot.store(context, std::memory_order_release);
+    return context;
+}
+
 /// Update thread local epoch context.
 ///
 /// This function is on the slow path. It's separated to allow inlining the fast
@@ -64,19 +114,11 @@ void update_local_context_full(int epoch_number)
     // Release the shared pointer of the obsoleted context.
     thread_local_context_full.reset();
 
-    // Local context invalid, check the shared context.
-    std::lock_guard<std::mutex> lock{shared_context_full_mutex};
-
-    if (!shared_context_full || shared_context_full->epoch_number != epoch_number)
-    {
-        // Release the shared pointer of the obsoleted context.
-        shared_context_full.reset();
-
-        // Build new context.
-        shared_context_full = create_epoch_context_full(epoch_number);
-    }
-
-    thread_local_context_full = shared_context_full;
+    // Local context invalid, check the shared contexts, usually prepared
+    // ahead of time.
+    thread_local_context_full = find_shared_context_full(epoch_number);
+    if (!thread_local_context_full)
+        thread_local_context_full = build_shared_context_full(epoch_number);
 }
 }  // namespace
 
@@ -97,4 +139,38 @@ std::shared_ptr<epoch_context_full> get_global_epoch_context_full(int epoch_numb
 
     return thread_local_context_full;
 }
+
+bool has_global_epoch_context_full(int epoch_number)
+{
+    return find_shared_context_full(epoch_number) != nullptr;
+}
+
+std::shared_ptr<epoch_context_full> prepare_global_epoch_context_full(int epoch_number)
+{
+    if (auto context = find_shared_context_full(epoch_number))
+        return context;
+    return build_shared_context_full(epoch_number);
+}
+
+bool release_global_epoch_contexts_full_before(int epoch_number)
+{
+    if (epoch_number <= oldest_shared_epoch_full.load(std::memory_order_relaxed))
+        return false;
+
+    std::lock_guard<std::mutex> lock{shared_context_full_mutex};
+    oldest_shared_epoch_full.store(epoch_number, std::memory_order_relaxed);
+
+    bool released = false;
+    for (auto& slot : shared_contexts_full)
+    {
+        auto context = slot.load(std::memory_order_acquire);
+        if (context && context->epoch_number < epoch_number)
+        {
+            // freed once the workers still holding it switch epochs
+            slot.store(nullptr, std::memory_order_release);
+            released = true;
+        }
+    }
+    return released;
+}
 }  // namespace ethash
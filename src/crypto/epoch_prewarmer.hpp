@@ -0,0 +1,95 @@
+#ifndef EPOCH_PREWARMER_HPP_
+#define EPOCH_PREWARMER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "cn/ethash/ethash.hpp"
+#include "logger.hpp"
+
+// builds the progpow (zano) epoch contexts before shares need them, otherwise
+// the first share of an epoch builds the light cache on a hashing worker
+// while the others wait on it. the current epoch is built before its first
+// job goes out, the next one on a background thread once the chain is
+// PREWARM_BLOCKS from the boundary. the contexts go to ethash's shared slots,
+// where the workers find them without locking. the previous epoch's is
+// released RELEASE_BLOCKS past the boundary, so at most two datasets stay
+// resident.
+class EpochPrewarmer
+{
+   public:
+    static constexpr uint32_t PREWARM_BLOCKS = 100;
+    // a share's job is dropped with its height, the previous epoch's shares
+    // are long stale by then
+    static constexpr uint32_t RELEASE_BLOCKS = 5;
+
+    // with every new job's height, from the job thread
+    void OnHeight(uint32_t height)
+    {
+        const int epoch = ethash::get_epoch_number(static_cast<int>(height));
+
+        // nothing to verify the job's shares with yet, startup or a skipped
+        // prewarm
+        if (!ethash::has_global_epoch_context_full(epoch)) Build(epoch);
+
+        if (height % ethash::epoch_length >= RELEASE_BLOCKS &&
+            ethash::release_global_epoch_contexts_full_before(epoch))
+        {
+            logger.Log<LogType::Info>(
+                "Released the ProgPoW contexts before epoch {}", epoch);
+        }
+
+        if (height % ethash::epoch_length + PREWARM_BLOCKS <
+                ethash::epoch_length ||
+            building.load(std::memory_order_acquire) ||
+            ethash::has_global_epoch_context_full(epoch + 1))
+        {
+            return;
+        }
+
+        building.store(true, std::memory_order_relaxed);
+        // the last build has finished, this join doesn't wait
+        builder = std::jthread(
+            [this, epoch]
+            {
+                Build(epoch + 1);
+                building.store(false, std::memory_order_release);
+            });
+    }
+
+   private:
+    static constexpr std::string_view field_str = "EpochPrewarmer";
+    const Logger logger{field_str};
+
+    std::atomic<bool> building{false};
+    std::jthread builder;
+
+    void Build(int epoch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto context = ethash::prepare_global_epoch_context_full(epoch);
+        const auto took = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        if (!context)
+        {
+            logger.Log<LogType::Critical>(
+                "Failed to allocate ProgPoW epoch {} context", epoch);
+            return;
+        }
+
+        // the dataset is only reserved, items are generated as shares hit them
+        logger.Log<LogType::Info>(
+            "Built ProgPoW epoch {} context in {}ms, light cache: {} MiB, "
+            "dataset: {} MiB reserved",
+            epoch, took.count(),
+            ethash::get_light_cache_size(
+                ethash::calculate_light_cache_num_items(epoch)) >> 20,
+            ethash::get_full_dataset_size(
+                ethash::calculate_full_dataset_num_items(epoch)) >> 20);
+    }
+};
+
+#endif
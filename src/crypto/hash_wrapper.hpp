@@ -12,6 +12,7 @@
 #include "verushash/uint256.h"
 #include "verushash/verus_clhash.h"
 #include "verushash/verus_hash.h"
+#include "verushash/verus_hash_batch.h"
 #include "x25x/x25x.h"
 #include "cn/crypto/hash.h"
 
@@ -27,6 +28,24 @@ class HashWrapper
         hasher->Write(in, size);
         hasher->Finalize2b(dest);
     }
+    // in starts with the bytes prefix absorbed
+    inline static void VerushashV2b2(uint8_t* dest, const uint8_t* in, int size,
+                                     const CVerusHashV2Prefix& prefix,
+                                     CVerusHashV2* hasher)
+    {
+        hasher->Restore(prefix);
+        hasher->Write(in + prefix.len, size - prefix.len);
+        hasher->Finalize2b(dest);
+    }
+    // count headers of the same size at once, same results as VerushashV2b2
+    inline static void VerushashV2b2Batch(uint8_t* const dest[],
+                                          const uint8_t* const in[], int size,
+                                          int count, CVerusHashV2Batch* hasher,
+                                          const CVerusHashV2Prefix* const
+                                              prefixes[] = nullptr)
+    {
+        hasher->Hash(dest, in, size, count, prefixes);
+    }
     inline static void SHA256d(uint8_t* dest, const uint8_t* in, int size)
     {
         // Make sure its initialized before this
@@ -0,0 +1,109 @@
+#ifndef TARGET256_HPP_
+#define TARGET256_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "utils/hex_utils.hpp"
+#include "verushash/arith_uint256.h"
+
+// a 256 bit target as little endian 64 bit words. a hash (little endian, as
+// hashed) meets it if it's not above it, the top word nearly always decides
+class Target256
+{
+   public:
+    // zero, only met by a zero hash
+    Target256() = default;
+
+    explicit Target256(arith_uint256 target)
+    {
+        for (auto& word : words)
+        {
+            word = target.GetLow64();
+            target >>= 64;
+        }
+    }
+
+    static Target256 Max()
+    {
+        Target256 res;
+        res.words.fill(UINT64_MAX);
+        return res;
+    }
+
+    // the target of a difficulty where difficulty 1 is the maximum target,
+    // as for all the supported coins. exact to the double's 53 bits
+    static Target256 FromDiff(double diff)
+    {
+        // also NaN
+        if (!(diff > 1.0)) return Max();
+
+        // 2^256 / diff = frac * 2^exp, frac in [0.5, 1)
+        int exp;
+        const double frac = std::frexp(std::ldexp(1.0, 256) / diff, &exp);
+        if (exp <= 0) return Target256();
+
+        arith_uint256 target(static_cast<uint64_t>(std::ldexp(frac, 53)));
+        exp -= 53;
+        if (exp >= 0)
+        {
+            target <<= exp;
+        }
+        else
+        {
+            target >>= -exp;
+        }
+        return Target256(target);
+    }
+
+    // 64 hex characters, most significant first (as daemons send them)
+    static Target256 FromHex(std::string_view hex)
+    {
+        std::array<uint8_t, 32> bytes;
+        Unhexlify(bytes.data(), hex.data(), bytes.size() * 2);
+
+        Target256 res;
+        for (int i = 0; i < 4; i++)
+        {
+            uint64_t word = 0;
+            for (int b = 0; b < 8; b++) word = (word << 8) | bytes[i * 8 + b];
+            res.words[3 - i] = word;
+        }
+        return res;
+    }
+
+    // little endian bytes, the hash's encoding
+    std::array<uint8_t, 32> ToBytesLE() const
+    {
+        std::array<uint8_t, 32> res;
+        for (int i = 0; i < 4; i++)
+        {
+            for (int b = 0; b < 8; b++)
+            {
+                res[i * 8 + b] = static_cast<uint8_t>(words[i] >> (b * 8));
+            }
+        }
+        return res;
+    }
+
+    bool IsMetBy(const uint8_t* hash) const
+    {
+        for (int i = 3; i >= 0; i--)
+        {
+            uint64_t word;
+            std::memcpy(&word, hash + i * sizeof(word), sizeof(word));
+            if (word != words[i]) return word < words[i];
+        }
+        return true;
+    }
+
+    bool operator==(const Target256&) const = default;
+
+   private:
+    std::array<uint64_t, 4> words{};
+};
+
+#endif
@@ -666,3 +666,185 @@ void haraka512_8x(unsigned char *out, const unsigned char *in) {
   // TRUNCSTORE(out + 192, s[6][0], s[6][1], s[6][2], s[6][3]);
   // TRUNCSTORE(out + 224, s[7][0], s[7][1], s[7][2], s[7][3]);
 }
+
+// 4 independent inputs at once, like the _4x variants but every lane has its
+// own (16 byte aligned) input and output, so chains that don't sit next to
+// each other in memory (one hash state per lane) can still be interleaved.
+void haraka256_4x_lanes(unsigned char *out[4], const unsigned char *in[4]) {
+  __m128i s[4][2], tmp;
+
+  s[0][0] = LOAD(in[0]);
+  s[0][1] = LOAD(in[0] + 16);
+  s[1][0] = LOAD(in[1]);
+  s[1][1] = LOAD(in[1] + 16);
+  s[2][0] = LOAD(in[2]);
+  s[2][1] = LOAD(in[2] + 16);
+  s[3][0] = LOAD(in[3]);
+  s[3][1] = LOAD(in[3] + 16);
+
+  AES2_4x(s[0], s[1], s[2], s[3], 0);
+  MIX2(s[0][0], s[0][1]);
+  MIX2(s[1][0], s[1][1]);
+  MIX2(s[2][0], s[2][1]);
+  MIX2(s[3][0], s[3][1]);
+
+  AES2_4x(s[0], s[1], s[2], s[3], 4);
+  MIX2(s[0][0], s[0][1]);
+  MIX2(s[1][0], s[1][1]);
+  MIX2(s[2][0], s[2][1]);
+  MIX2(s[3][0], s[3][1]);
+
+  AES2_4x(s[0], s[1], s[2], s[3], 8);
+  MIX2(s[0][0], s[0][1]);
+  MIX2(s[1][0], s[1][1]);
+  MIX2(s[2][0], s[2][1]);
+  MIX2(s[3][0], s[3][1]);
+
+  AES2_4x(s[0], s[1], s[2], s[3], 12);
+  MIX2(s[0][0], s[0][1]);
+  MIX2(s[1][0], s[1][1]);
+  MIX2(s[2][0], s[2][1]);
+  MIX2(s[3][0], s[3][1]);
+
+  AES2_4x(s[0], s[1], s[2], s[3], 16);
+  MIX2(s[0][0], s[0][1]);
+  MIX2(s[1][0], s[1][1]);
+  MIX2(s[2][0], s[2][1]);
+  MIX2(s[3][0], s[3][1]);
+
+  s[0][0] = _mm_xor_si128(s[0][0], LOAD(in[0]));
+  s[0][1] = _mm_xor_si128(s[0][1], LOAD(in[0] + 16));
+  s[1][0] = _mm_xor_si128(s[1][0], LOAD(in[1]));
+  s[1][1] = _mm_xor_si128(s[1][1], LOAD(in[1] + 16));
+  s[2][0] = _mm_xor_si128(s[2][0], LOAD(in[2]));
+  s[2][1] = _mm_xor_si128(s[2][1], LOAD(in[2] + 16));
+  s[3][0] = _mm_xor_si128(s[3][0], LOAD(in[3]));
+  s[3][1] = _mm_xor_si128(s[3][1], LOAD(in[3] + 16));
+
+  STORE(out[0], s[0][0]);
+  STORE(out[0] + 16, s[0][1]);
+  STORE(out[1], s[1][0]);
+  STORE(out[1] + 16, s[1][1]);
+  STORE(out[2], s[2][0]);
+  STORE(out[2] + 16, s[2][1]);
+  STORE(out[3], s[3][0]);
+  STORE(out[3] + 16, s[3][1]);
+}
+
+void haraka512_4x_lanes(unsigned char *out[4], const unsigned char *in[4]) {
+  u128 s[4][4], tmp;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    s[i][0] = LOAD(in[i]);
+    s[i][1] = LOAD(in[i] + 16);
+    s[i][2] = LOAD(in[i] + 32);
+    s[i][3] = LOAD(in[i] + 48);
+  }
+
+  AES4_4x(s[0], s[1], s[2], s[3], 0);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_4x(s[0], s[1], s[2], s[3], 8);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_4x(s[0], s[1], s[2], s[3], 16);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_4x(s[0], s[1], s[2], s[3], 24);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_4x(s[0], s[1], s[2], s[3], 32);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  for (i = 0; i < 4; i++) {
+    s[i][0] = _mm_xor_si128(s[i][0], LOAD(in[i]));
+    s[i][1] = _mm_xor_si128(s[i][1], LOAD(in[i] + 16));
+    s[i][2] = _mm_xor_si128(s[i][2], LOAD(in[i] + 32));
+    s[i][3] = _mm_xor_si128(s[i][3], LOAD(in[i] + 48));
+    TRUNCSTORE(out[i], s[i][0], s[i][1], s[i][2], s[i][3]);
+  }
+}
+
+#define AES4_keyed(s0, s1, s2, s3, k, rci) \
+  s0 = _mm_aesenc_si128(s0, k[rci]); \
+  s1 = _mm_aesenc_si128(s1, k[rci + 1]); \
+  s2 = _mm_aesenc_si128(s2, k[rci + 2]); \
+  s3 = _mm_aesenc_si128(s3, k[rci + 3]); \
+  s0 = _mm_aesenc_si128(s0, k[rci + 4]); \
+  s1 = _mm_aesenc_si128(s1, k[rci + 5]); \
+  s2 = _mm_aesenc_si128(s2, k[rci + 6]); \
+  s3 = _mm_aesenc_si128(s3, k[rci + 7]);
+
+#define AES4_keyed_4x(s0, s1, s2, s3, k, rci) \
+  AES4_keyed(s0[0], s0[1], s0[2], s0[3], k[0], rci); \
+  AES4_keyed(s1[0], s1[1], s1[2], s1[3], k[1], rci); \
+  AES4_keyed(s2[0], s2[1], s2[2], s2[3], k[2], rci); \
+  AES4_keyed(s3[0], s3[1], s3[2], s3[3], k[3], rci);
+
+// haraka512_keyed with a different key per lane
+void haraka512_keyed_4x_lanes(unsigned char *out[4], const unsigned char *in[4],
+                              const u128 *keys[4]) {
+  u128 s[4][4], tmp;
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    s[i][0] = LOAD(in[i]);
+    s[i][1] = LOAD(in[i] + 16);
+    s[i][2] = LOAD(in[i] + 32);
+    s[i][3] = LOAD(in[i] + 48);
+  }
+
+  AES4_keyed_4x(s[0], s[1], s[2], s[3], keys, 0);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_keyed_4x(s[0], s[1], s[2], s[3], keys, 8);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_keyed_4x(s[0], s[1], s[2], s[3], keys, 16);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_keyed_4x(s[0], s[1], s[2], s[3], keys, 24);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_keyed_4x(s[0], s[1], s[2], s[3], keys, 32);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  for (i = 0; i < 4; i++) {
+    s[i][0] = _mm_xor_si128(s[i][0], LOAD(in[i]));
+    s[i][1] = _mm_xor_si128(s[i][1], LOAD(in[i] + 16));
+    s[i][2] = _mm_xor_si128(s[i][2], LOAD(in[i] + 32));
+    s[i][3] = _mm_xor_si128(s[i][3], LOAD(in[i] + 48));
+    TRUNCSTORE(out[i], s[i][0], s[i][1], s[i][2], s[i][3]);
+  }
+}
@@ -118,11 +118,15 @@ void haraka256(unsigned char *out, const unsigned char *in);
 void haraka256_keyed(unsigned char *out, const unsigned char *in, const u128 *rc);
 void haraka256_4x(unsigned char *out, const unsigned char *in);
 void haraka256_8x(unsigned char *out, const unsigned char *in);
+void haraka256_4x_lanes(unsigned char *out[4], const unsigned char *in[4]);
 
 void haraka512(unsigned char *out, const unsigned char *in);
 void haraka512_zero(unsigned char *out, const unsigned char *in);
 void haraka512_keyed(unsigned char *out, const unsigned char *in, const u128 *rc);
 void haraka512_4x(unsigned char *out, const unsigned char *in);
 void haraka512_8x(unsigned char *out, const unsigned char *in);
+void haraka512_4x_lanes(unsigned char *out[4], const unsigned char *in[4]);
+void haraka512_keyed_4x_lanes(unsigned char *out[4], const unsigned char *in[4],
+                              const u128 *keys[4]);
 
 #endif
@@ -89,6 +89,31 @@ CVerusHash &CVerusHash::Write(const unsigned char *data, size_t _len)
     return *this;
 }
 
+CVerusHashV2 &CVerusHashV2::Restore(const CVerusHashV2Prefix &prefix)
+{
+    curBuf = buf1;
+    result = buf2;
+    memcpy(buf1, prefix.buf, sizeof(buf1));
+    curPos = prefix.len % 32;
+    return *this;
+}
+
+CVerusHashV2Prefix::CVerusHashV2Prefix(const unsigned char *data, size_t size)
+    : len(size)
+{
+    // as Write(), the bytes after the pending ones are always overwritten
+    // before they are hashed
+    alignas(32) unsigned char result[64];
+    const size_t full = size - size % 32;
+    for (size_t pos = 0; pos < full; pos += 32)
+    {
+        memcpy(buf + 32, data + pos, 32);
+        (*CVerusHashV2::haraka512Function)(result, buf);
+        memcpy(buf, result, 32);
+    }
+    memcpy(buf + 32, data + full, size - full);
+}
+
 // to be declared and accessed from C
 void verus_hash(void *result, const void *data, size_t len)
 {
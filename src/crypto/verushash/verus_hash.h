@@ -76,6 +76,8 @@ class CVerusHash
     size_t curPos = 0;
 };
 
+struct CVerusHashV2Prefix;
+
 class CVerusHashV2
 {
    public:
@@ -114,6 +116,10 @@ class CVerusHashV2
         return *this;
     }
 
+    // same as Reset() and Write()ing the prefix's bytes, Write() the rest of
+    // the input after it
+    CVerusHashV2 &Restore(const CVerusHashV2Prefix &prefix);
+
     inline int64_t *ExtraI64Ptr() { return (int64_t *)(curBuf + 32); }
     inline void ClearExtra()
     {
@@ -252,6 +258,19 @@ class CVerusHashV2
     size_t curPos = 0;
 };
 
+// the Write() state after the leading bytes many inputs have in common (the
+// fields of a block header that only the job sets), so each input only
+// absorbs what follows them
+struct CVerusHashV2Prefix
+{
+    alignas(32) unsigned char buf[64] = {0};
+    size_t len = 0;
+
+    CVerusHashV2Prefix() = default;
+    // needs CVerusHashV2::init()
+    CVerusHashV2Prefix(const unsigned char *data, size_t size);
+};
+
 extern void verus_hash(void *result, const void *data, size_t len);
 extern void verus_hash_v2(void *result, const void *data, size_t len);
 
@@ -0,0 +1,205 @@
+#include "verus_hash_batch.h"
+
+#include <cstdlib>
+#include <utility>
+
+// same as CVerusHashV2::FillExtra
+template <typename T>
+static inline void FillExtra(unsigned char *curBuf, size_t curPos,
+                             const T *_data)
+{
+    const unsigned char *data = (const unsigned char *)_data;
+    int pos = curPos;
+    int left = 32 - pos;
+    do
+    {
+        int len = left > (int)sizeof(T) ? sizeof(T) : left;
+        std::memcpy(curBuf + 32 + pos, data, len);
+        pos += len;
+        left -= len;
+    } while (left > 0);
+}
+
+CVerusHashV2Batch::CVerusHashV2Batch(int solutionVersion)
+    : scalar(solutionVersion)
+{
+    for (auto &key : keys)
+    {
+        key = (unsigned char *)alloc_aligned_buffer(
+            scalar.vclh.keySizeInBytes << 1);
+        if (!key)
+        {
+            printf("ERROR: failed to allocate hash buffer - terminating\n");
+            assert(false);
+        }
+    }
+}
+
+CVerusHashV2Batch::~CVerusHashV2Batch()
+{
+    for (auto key : keys) std::free(key);
+}
+
+void CVerusHashV2Batch::Hash(unsigned char *const out[],
+                             const unsigned char *const in[], size_t len,
+                             int count,
+                             const CVerusHashV2Prefix *const prefixes[])
+{
+    if (!IsCPUVerusOptimized())
+    {
+        for (int i = 0; i < count; i++)
+        {
+            HashScalar(out[i], in[i], len, prefixes ? prefixes[i] : nullptr);
+        }
+        return;
+    }
+
+    int i = 0;
+    for (; count - i >= LANES; i += LANES)
+    {
+        HashLanes(out + i, in + i, len, prefixes ? prefixes + i : nullptr);
+    }
+
+    const int left = count - i;
+    if (left == 1)
+    {
+        HashScalar(out[i], in[i], len, prefixes ? prefixes[i] : nullptr);
+    }
+    else if (left > 1)
+    {
+        // cheaper to run idle lanes than to go scalar
+        unsigned char *lane_out[LANES];
+        const unsigned char *lane_in[LANES];
+        const CVerusHashV2Prefix *lane_prefix[LANES];
+        for (int l = 0; l < LANES; l++)
+        {
+            const int src = l < left ? i + l : i;
+            lane_out[l] = l < left ? out[src] : discard;
+            lane_in[l] = in[src];
+            lane_prefix[l] = prefixes ? prefixes[src] : nullptr;
+        }
+        HashLanes(lane_out, lane_in, len, prefixes ? lane_prefix : nullptr);
+    }
+}
+
+void CVerusHashV2Batch::HashScalar(unsigned char *out, const unsigned char *in,
+                                   size_t len,
+                                   const CVerusHashV2Prefix *prefix)
+{
+    if (prefix)
+    {
+        scalar.Restore(*prefix);
+        scalar.Write(in + prefix->len, len - prefix->len);
+    }
+    else
+    {
+        scalar.Reset();
+        scalar.Write(in, len);
+    }
+    scalar.Finalize2b(out);
+}
+
+void CVerusHashV2Batch::HashLanes(unsigned char *const out[LANES],
+                                  const unsigned char *const in[LANES],
+                                  size_t len,
+                                  const CVerusHashV2Prefix *const prefixes[LANES])
+{
+    unsigned char *curBuf[LANES], *result[LANES];
+    for (int l = 0; l < LANES; l++)
+    {
+        curBuf[l] = bufs[l][0];
+        result[l] = bufs[l][1];
+        if (prefixes)
+        {
+            std::memcpy(curBuf[l], prefixes[l]->buf, 64);
+        }
+        else
+        {
+            std::fill(curBuf[l], curBuf[l] + 64, 0);
+        }
+    }
+
+    // Write(), 32 bytes at a time, the boundaries are the same for all lanes
+    size_t pos = prefixes ? prefixes[0]->len : 0;
+    size_t curPos = pos % 32;
+    while (pos < len)
+    {
+        const size_t room = 32 - curPos;
+
+        if (len - pos >= room)
+        {
+            for (int l = 0; l < LANES; l++)
+            {
+                memcpy(curBuf[l] + 32 + curPos, in[l] + pos, room);
+            }
+            haraka512_4x_lanes(result, (const unsigned char **)curBuf);
+            std::swap(curBuf, result);
+            pos += room;
+            curPos = 0;
+        }
+        else
+        {
+            for (int l = 0; l < LANES; l++)
+            {
+                memcpy(curBuf[l] + 32 + curPos, in[l] + pos, len - pos);
+            }
+            curPos += len - pos;
+            pos = len;
+        }
+    }
+
+    // Finalize2b()
+    for (int l = 0; l < LANES; l++)
+    {
+        FillExtra(curBuf[l], curPos, (u128 *)curBuf[l]);
+    }
+
+    // GenNewCLKey(), every share has a new seed so the key is always
+    // regenerated, nothing reads the refresh copy
+    const int size = scalar.vclh.keySizeInBytes;
+    const int n256blks = size >> 5;
+    const int nbytesExtra = size & 0x1f;
+    unsigned char *pkey[LANES];
+    const unsigned char *psrc[LANES];
+    for (int l = 0; l < LANES; l++)
+    {
+        pkey[l] = keys[l];
+        psrc[l] = curBuf[l];
+    }
+
+    for (int i = 0; i < n256blks; i++)
+    {
+        haraka256_4x_lanes(pkey, psrc);
+        for (int l = 0; l < LANES; l++)
+        {
+            psrc[l] = pkey[l];
+            pkey[l] += 32;
+        }
+    }
+    if (nbytesExtra)
+    {
+        alignas(16) unsigned char extra[LANES][32];
+        unsigned char *pextra[LANES];
+        for (int l = 0; l < LANES; l++) pextra[l] = extra[l];
+
+        haraka256_4x_lanes(pextra, psrc);
+        for (int l = 0; l < LANES; l++)
+        {
+            memcpy(pkey[l], extra[l], nbytesExtra);
+        }
+    }
+
+    const uint64_t refreshsize = scalar.vclh.keyrefreshsize();
+    const u128 *finalKey[LANES];
+    for (int l = 0; l < LANES; l++)
+    {
+        __m128i **pMoveScratch = (__m128i **)(keys[l] + size + refreshsize);
+        uint64_t intermediate = scalar.vclh(curBuf[l], keys[l], pMoveScratch);
+
+        FillExtra(curBuf[l], curPos, &intermediate);
+        finalKey[l] = (u128 *)keys[l] + scalar.IntermediateTo128Offset(intermediate);
+    }
+
+    haraka512_keyed_4x_lanes((unsigned char **)out,
+                             (const unsigned char **)curBuf, finalKey);
+}
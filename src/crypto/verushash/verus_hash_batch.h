@@ -0,0 +1,48 @@
+#ifndef VERUS_HASH_BATCH_H_
+#define VERUS_HASH_BATCH_H_
+
+#include <cstddef>
+
+#include "verus_hash.h"
+
+// VerusHash 2.x over several equally sized inputs at once, every result is
+// identical to Reset() + Write() + Finalize2b() on a CVerusHashV2.
+// the haraka chains (absorbing the input, the key generation and the final
+// keyed hash) of LANES inputs run interleaved so the AES units stay busy,
+// the clhash step branches on its data and runs lane by lane.
+// every lane has its own key, so this doesn't touch the thread's key cache.
+class CVerusHashV2Batch
+{
+   public:
+    static constexpr int LANES = 4;
+
+    explicit CVerusHashV2Batch(int solutionVersion = SOLUTION_VERUSHHASH_V2);
+    ~CVerusHashV2Batch();
+
+    CVerusHashV2Batch(const CVerusHashV2Batch &) = delete;
+    CVerusHashV2Batch &operator=(const CVerusHashV2Batch &) = delete;
+
+    // hashes count inputs of len bytes each into out[i] (32 bytes).
+    // with prefixes, in[i] starts with the bytes prefixes[i] absorbed, those
+    // are skipped. all the prefixes have to be of the same length
+    void Hash(unsigned char *const out[], const unsigned char *const in[],
+              size_t len, int count,
+              const CVerusHashV2Prefix *const prefixes[] = nullptr);
+
+    // the single input path, used for leftovers and cpus without AES-NI
+    CVerusHashV2 &Scalar() { return scalar; }
+
+   private:
+    CVerusHashV2 scalar;
+    unsigned char *keys[LANES] = {nullptr};
+    alignas(32) unsigned char bufs[LANES][2][64];
+    unsigned char discard[32];
+
+    void HashLanes(unsigned char *const out[LANES],
+                   const unsigned char *const in[LANES], size_t len,
+                   const CVerusHashV2Prefix *const prefixes[LANES]);
+    void HashScalar(unsigned char *out, const unsigned char *in, size_t len,
+                    const CVerusHashV2Prefix *prefix);
+};
+
+#endif
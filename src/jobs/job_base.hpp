@@ -3,6 +3,7 @@
 
 #include <ctime>
 #include <iomanip>
+#include <memory>
 #include <shared_mutex>
 #include <sstream>
 #include <string>
@@ -11,6 +12,7 @@
 #include "block_template.hpp"
 #include "merkle_tree.hpp"
 #include "share.hpp"
+#include "share_filter.hpp"
 #include "static_config.hpp"
 #include "utils.hpp"
 
@@ -31,6 +33,12 @@ class JobBase
     // locked when a job is being read from, so it won't be removed.
     const std::string id;
     const bool clean;
+
+    // set by the job manager before the job is published:
+    // publish order, the id of sequentially numbered jobs is its hex
+    uint32_t seq = 0;
+    // duplicate shares of this job's height
+    std::shared_ptr<ShareFilter> share_filter;
 };
 
 #endif
\ No newline at end of file
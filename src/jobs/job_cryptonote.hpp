@@ -23,6 +23,7 @@
 #include "share.hpp"
 #include "static_config.hpp"
 #include "stratum_client.hpp"
+#include "target256.hpp"
 #include "utils.hpp"
 using BlockTemplateResCn = DaemonManagerT<Coin::ZANO>::BlockTemplateRes;
 
@@ -33,6 +34,8 @@ struct BlockTemplateCn
     const std::string seed;
     const uint32_t height;
     const double target_diff;
+    // a hash meeting it is a block, hash * difficulty < 2^256
+    const Target256 block_target;
     const double expected_hashes;
     const uint32_t block_size;
     const uint64_t coinbase_value;
@@ -96,6 +99,7 @@ struct BlockTemplateCn
           seed(btemplate.seed),
           height(btemplate.height),
           target_diff(static_cast<double>(btemplate.difficulty)),
+          block_target(~arith_uint256() / arith_uint256(btemplate.difficulty)),
           expected_hashes(GetHashMultiplier<ZanoStatic>() * target_diff),
           block_size(static_cast<uint32_t>(btemplate.blob.size() / 2)),
           coinbase_value(block.miner_tx.vout[0].amount),
@@ -146,30 +150,38 @@ class Job<StratumProtocol::CN> : public BlockTemplateCn, public JobBase
         return arr;
     }
 
+    // fits the ids, seed and target hex
+    static constexpr size_t MAX_WORK_MESSAGE_SIZE = 512;
+
+    // formatted into buff (MAX_WORK_MESSAGE_SIZE), returns the written size
     template <StaticConf confs>
-    std::string GetWorkMessage(double diff, int64_t id) const
+    size_t GetWorkMessage(char* buff, double diff, int64_t id) const
     {
         auto diff_hex = GetDifficultyHex<confs>(diff);
         std::string_view hex_target_sv(diff_hex.data(), diff_hex.size());
 
-        return fmt::format(
+        const auto res = fmt::format_to_n(
+            buff, MAX_WORK_MESSAGE_SIZE,
             "{{\"jsonrpc\":\"2.0\",\"id\":{},\"result\":[\"0x{"
             "}\",\"0x{}\",\"0x{}\",\"0x{:016x}\"]}}\n",
             id, std::string_view(this->id.data(), this->id.size()), seed,
             hex_target_sv, height);
+        return res.out - buff;
     }
 
     template <StaticConf confs>
-    std::string GetWorkMessage(double diff) const
+    size_t GetWorkMessage(char* buff, double diff) const
     {
         auto diff_hex = GetDifficultyHex<confs>(diff);
         std::string_view hex_target_sv(diff_hex.data(), diff_hex.size());
 
-        return fmt::format(
+        const auto res = fmt::format_to_n(
+            buff, MAX_WORK_MESSAGE_SIZE,
             "{{\"jsonrpc\":\"2.0\",\"result\":[\"0x{"
             "}\",\"0x{}\",\"0x{}\",\"0x{:016x}\"]}}\n",
             std::string_view(this->id.data(), this->id.size()), seed,
             hex_target_sv, height);
+        return res.out - buff;
     }
 
     bool operator==(const Job<StratumProtocol::CN>& other) const
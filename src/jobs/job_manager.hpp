@@ -5,7 +5,6 @@
 #include <algorithm>
 #include <mutex>
 #include <shared_mutex>
-#include <vector>
 
 #include "block_template.hpp"
 #include "daemon_manager_vrsc.hpp"
@@ -54,35 +53,38 @@ class JobManager
         SetNewJob(std::move(new_job));
     }
 
-    // allow concurrect reading while not being modified
-    inline std::shared_ptr<Job> GetJob(std::string_view hexId)
-    {
-        std::shared_lock lock(jobs_mutex);
-        for (const auto& job : jobs)
-        {
-            if (job->id == hexId)
-            {
-                return job;
-            }
-        }
-        return nullptr;
-    }
-
+    // shares look their job up in the reactors' JobTables, which keep the
+    // jobs alive, only the last one is kept here
     inline std::shared_ptr<Job> SetNewJob(std::shared_ptr<Job> job)
     {
-        job_count++;
+        job->seq = job_count++;
 
-        std::unique_lock jobs_lock(jobs_mutex);
-        if (job->clean)
+        // a fresh filter per height, the jobs it shares with are cleared
+        // below and the old one goes with the last of them
+        if (job->clean || !last_job)
         {
-            while (jobs.size())
+            const uint64_t last_size =
+                last_job ? last_job->share_filter->Size() : 0;
+            job->share_filter = std::make_shared<ShareFilter>(
+                ShareFilter::CapacityFor(last_size));
+
+            if (last_job)
             {
-                // incase a job is being used
-                std::shared_ptr<Job> remove_job = std::move(jobs.back());
-                jobs.pop_back();
+                logger.template Log<LogType::Info>(
+                    "Share filter: {} shares ({} overflowed) in "
+                    "{} slots, next height gets {}",
+                    last_size, last_job->share_filter->Overflowed(),
+                    last_job->share_filter->Capacity(),
+                    job->share_filter->Capacity());
             }
         }
-        last_job = jobs.emplace_back(std::move(job));
+        else
+        {
+            job->share_filter = last_job->share_filter;
+        }
+
+        std::unique_lock jobs_lock(jobs_mutex);
+        last_job = std::move(job);
         return last_job;
     }
 
@@ -141,9 +143,6 @@ class JobManager
     uint32_t job_count = 0;
     std::shared_mutex jobs_mutex;
     std::shared_ptr<Job> last_job;
-    // unordered map is not thread safe for modifying and accessing different
-    // elements, but a vector is, so we use other optimization (save last job)
-    std::vector<std::shared_ptr<Job>> jobs;
 
     // multiple jobs can use the same block template, (append transactions only)
     static constexpr std::string_view field_str = "JobManager";
@@ -0,0 +1,82 @@
+#ifndef JOB_TABLE_HPP_
+#define JOB_TABLE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "utils/hex_utils.hpp"
+
+// the jobs a reactor's miners can submit to, a private copy per reactor that
+// is only touched on the reactor's thread: jobs are added as the reactor
+// broadcasts them, so looking one up for a share takes no lock and no
+// atomic. a ring in publish order (JobBase::seq), the oldest job is dropped
+// once it's full.
+// SEQUENTIAL_IDS: the id is the hex of seq, so it indexes the ring directly,
+// otherwise (template hash ids) the slots are matched by their first 8 bytes.
+template <typename JobT, bool SEQUENTIAL_IDS>
+class JobTable
+{
+   public:
+    static constexpr uint32_t SIZE = 64;
+
+    void Add(std::shared_ptr<JobT> job)
+    {
+        if (job->clean && job != last)
+        {
+            for (auto& slot : slots) slot = Slot{};
+        }
+
+        Slot& slot = slots[job->seq % SIZE];
+        slot.key = Key(job->id);
+        slot.job = job;
+        last = std::move(job);
+    }
+
+    // nullptr if it's not one of the last SIZE jobs (of the current height)
+    std::shared_ptr<JobT> Get(std::string_view id) const
+    {
+        const uint64_t key = Key(id);
+        if constexpr (SEQUENTIAL_IDS)
+        {
+            const Slot& slot = slots[key % SIZE];
+            if (slot.key == key && slot.job && slot.job->id == id)
+            {
+                return slot.job;
+            }
+            return nullptr;
+        }
+        else
+        {
+            for (const Slot& slot : slots)
+            {
+                if (slot.key == key && slot.job && slot.job->id == id)
+                {
+                    return slot.job;
+                }
+            }
+            return nullptr;
+        }
+    }
+
+    const std::shared_ptr<JobT>& Last() const { return last; }
+
+   private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        std::shared_ptr<JobT> job;
+    };
+
+    std::array<Slot, SIZE> slots;
+    std::shared_ptr<JobT> last;
+
+    static uint64_t Key(std::string_view id)
+    {
+        return HexToUint(id.data(), std::min<size_t>(id.size(), 16));
+    }
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <string>
 
+#include "binary_protocol.hpp"
 #include "block_template.hpp"
 #include "config_vrsc.hpp"
 #include "constants.hpp"
@@ -18,6 +19,24 @@
 #include "merkle_tree.hpp"
 #include "share.hpp"
 #include "static_config.hpp"
+#include "target256.hpp"
+#include "verushash/verus_hash.h"
+
+// a job as another pool's mining.notify has it (proxy mode), the fields in
+// block encoding
+struct UpstreamNotifyZec
+{
+    std::string job_id;
+    uint32_t version;
+    std::array<uint8_t, HASH_SIZE> prev_block_hash;
+    std::array<uint8_t, HASH_SIZE> merkle_root_hash;
+    std::array<uint8_t, HASH_SIZE> final_sroot_hash;
+    uint32_t time;
+    uint32_t bits;
+    bool clean;
+    // hex, what the miners' solutions start with
+    std::string solution;
+};
 
 struct BlockTemplateZec
 {
@@ -32,6 +51,8 @@ struct BlockTemplateZec
 
     const uint32_t height;
     const double target_diff;
+    // a hash meeting it is a block
+    const Target256 block_target;
     const uint64_t coinbase_value;
     const uint32_t tx_count;
     const double expected_hashes = 0;
@@ -51,11 +72,31 @@ struct BlockTemplateZec
           bits(bTemplate.bits),
           height(bTemplate.height),
           target_diff(HexToDouble(bTemplate.target)),
+          block_target(Target256::FromHex(bTemplate.target)),
           coinbase_value(bTemplate.coinbase_value),
           tx_count(static_cast<uint32_t>(bTemplate.transactions.size()))
     {
     }
 
+    // the pool's target takes the block's place, a share meeting it is
+    // forwarded
+    explicit BlockTemplateZec(const UpstreamNotifyZec& notify,
+                              const Target256& upstream_target,
+                              double upstream_diff)
+        : version(notify.version),
+          prev_block_hash(notify.prev_block_hash),
+          merkle_root_hash(notify.merkle_root_hash),
+          final_sroot_hash(notify.final_sroot_hash),
+          min_time(notify.time),
+          bits(notify.bits),
+          height(0),
+          target_diff(upstream_diff),
+          block_target(upstream_target),
+          coinbase_value(0),
+          tx_count(0)
+    {
+    }
+
     // only generating notify message once for efficiency
     std::string GenerateNotifyMessage(std::string_view jobid,
                                       std::string_view solution,
@@ -73,6 +114,29 @@ struct BlockTemplateZec
             bswap_32(min_time), bswap_32(bits), clean,
             std::string_view(solution.data(), 144));
     }
+
+    // the same job for the binary protocol, its fields in block encoding
+    std::string GenerateBinaryNotifyMessage(std::string_view jobid,
+                                            std::string_view solution,
+                                            bool clean = true) const
+    {
+        BinaryProtocol::NewMiningJob msg{
+            .job_id = static_cast<uint32_t>(
+                HexToUint(jobid.data(), jobid.size())),
+            .clean = clean,
+            .version = version,
+            .prev_hash = prev_block_hash,
+            .merkle_root = merkle_root_hash,
+            .final_sroot = final_sroot_hash,
+            .min_time = min_time,
+            .bits = bits};
+        Unhexlify(msg.solution_prefix.data(), solution.data(),
+                  msg.solution_prefix.size() * 2);
+
+        std::string res(BinaryProtocol::NewMiningJob::MAX_SIZE, '\0');
+        res.resize(BinaryProtocol::Encode(res.data(), msg));
+        return res;
+    }
 };
 
 template <>
@@ -87,8 +151,11 @@ class Job<StratumProtocol::ZEC>
         : BlockTemplateZec(bTemplate),
           JobBaseBtc(std::move(jobId),
                      GenerateNotifyMessage(jobId, bTemplate.solution),
-                     bTemplate.transactions)
-
+                     bTemplate.transactions),
+          hash_prefix(reinterpret_cast<const uint8_t*>(&this->version),
+                      STATIC_HEADER_SIZE),
+          binary_notify_msg(
+              GenerateBinaryNotifyMessage(this->id, bTemplate.solution))
     {
         // difficulty is calculated from opposite byte encoding than in block
 
@@ -99,14 +166,39 @@ class Job<StratumProtocol::ZEC>
         //     ReverseHexArr(bTemplate.finals_root_hash);
     }
 
-    void GetHeaderData(uint8_t* buff, const ShareZec& share,
-                       uint32_t nonce1) const /* override */
+    // relayed from the pool the proxy mines to, under the pool's job id.
+    // the proxy has no binary listener
+    explicit Job<StratumProtocol::ZEC>(const UpstreamNotifyZec& notify,
+                                       const Target256& upstream_target,
+                                       double upstream_diff)
+        : BlockTemplateZec(notify, upstream_target, upstream_diff),
+          JobBaseBtc(std::string(notify.job_id),
+                     GenerateNotifyMessage(notify.job_id, notify.solution,
+                                           notify.clean),
+                     {}, notify.clean),
+          hash_prefix(reinterpret_cast<const uint8_t*>(&this->version),
+                      STATIC_HEADER_SIZE)
+    {
+    }
+
+    // version to final sapling root, the same in every share's header
+    static constexpr size_t STATIC_HEADER_SIZE =
+        VERSION_SIZE + PREVHASH_SIZE + MERKLE_ROOT_SIZE + FINALSROOT_SIZE;
+
+    // the hasher's state after the static header, shares only hash from
+    // their time on
+    const CVerusHashV2Prefix hash_prefix;
+    // notify_msg for the binary protocol's connections
+    const std::string binary_notify_msg;
+
+    // false if the nonce2 or solution aren't hex
+    [[nodiscard]] bool GetHeaderData(uint8_t* buff, const ShareZec& share,
+                                     uint32_t nonce1) const /* override */
     {
         // STATIC HEADER DATA (VERSION TO FINALSROOT)
-        memcpy(buff, &this->version, VERSION_SIZE + HASH_SIZE * 3);
+        memcpy(buff, &this->version, STATIC_HEADER_SIZE);
 
-        constexpr int TIME_POS =
-            VERSION_SIZE + PREVHASH_SIZE + MERKLE_ROOT_SIZE + FINALSROOT_SIZE;
+        constexpr int TIME_POS = STATIC_HEADER_SIZE;
 
         memcpy(buff + TIME_POS, &share.time, TIME_SIZE);
 
@@ -118,12 +210,22 @@ class Job<StratumProtocol::ZEC>
 
         constexpr int NONCE2_POS =
             NONCE1_POS + StratumConstants::EXTRANONCE_SIZE;
-        Unhexlify(buff + NONCE2_POS, share.nonce2_sv.data(),
-                  EXTRANONCE2_SIZE * 2);
-
         constexpr int SOLUTION_POS = NONCE2_POS + EXTRANONCE2_SIZE;
-        Unhexlify(buff + SOLUTION_POS, share.solution.data(),
-                  (SOLUTION_LENGTH_SIZE + SOLUTION_SIZE) * 2);
+
+        if (share.raw)
+        {
+            // sizes checked as the frame was decoded
+            memcpy(buff + NONCE2_POS, share.nonce2_sv.data(),
+                   EXTRANONCE2_SIZE);
+            memcpy(buff + SOLUTION_POS, share.solution.data(),
+                   SOLUTION_LENGTH_SIZE + SOLUTION_SIZE);
+            return true;
+        }
+
+        return TryUnhexlify(buff + NONCE2_POS, share.nonce2_sv.data(),
+                            EXTRANONCE2_SIZE * 2) &&
+               TryUnhexlify(buff + SOLUTION_POS, share.solution.data(),
+                            (SOLUTION_LENGTH_SIZE + SOLUTION_SIZE) * 2);
     }
 
     inline void GetBlockHex(std::string& res, const uint8_t* block_header) const
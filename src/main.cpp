@@ -14,8 +14,10 @@
 #include "stratum/stratum_server.hpp"
 #include "stratum_server_zec.hpp"
 #include "stratum_server_cn.hpp"
+#include "stratum_proxy_zec.hpp"
 
 StratumBase* stratum_bserver_ptr;
+StratumProxyZec<VrscStatic>* stratum_proxy_ptr;
 
 const Logger logger{config_field_str};
 using enum LogType;
@@ -37,6 +39,11 @@ void SigintHandler(int sig)
 
     logger.Log<Info>("Stopping stratum server...");
 
+    if (stratum_proxy_ptr)
+    {
+        stratum_proxy_ptr->Stop();
+        return;
+    }
     stratum_bserver_ptr->Stop();
 }
 
@@ -46,6 +53,46 @@ void PrintStaticStats(StaticConf confs){
         logger.Log<Info>("Share multiplier: {}", pow2d(256) / confs.DIFF1);
 }
 
+// sickpool --proxy <config>: the farm's local stratum, see StratumProxyZec
+int RunProxy(const char* config_path)
+{
+    ProxyConfig proxyConfig;
+    try
+    {
+        if (!std::ifstream(config_path).good())
+        {
+            throw std::invalid_argument("Bad proxy config file specified");
+        }
+
+        simdjson::padded_string json =
+            simdjson::padded_string::load(config_path);
+        ParseProxyConfig(json, proxyConfig, logger);
+
+        logger.Log<Info>("Proxy coin symbol: {}", proxyConfig.symbol);
+
+        // only zec stratum pools for now
+        if (proxyConfig.symbol != "VRSC")
+        {
+            throw std::invalid_argument(
+                fmt::format("Proxy doesn't support coin {}",
+                            proxyConfig.symbol));
+        }
+
+        static constexpr StaticConf confs = VrscStatic;
+        PrintStaticStats(confs);
+
+        StratumProxyZec<confs> stratum_proxy(proxyConfig);
+        stratum_proxy_ptr = &stratum_proxy;
+        stratum_proxy.Listen();
+    }
+    catch (const std::exception& e)
+    {
+        logger.Log<Critical>("START-UP ERROR: {}.", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;  // graceful exit
+}
+
 int main(int argc, char** argv)
 {
     logger.Log<Info>("Starting SickPool!");
@@ -58,6 +105,11 @@ int main(int argc, char** argv)
         logger.Log<Error>("Failed to register SIGINT...");
     }
 
+    if (argc >= 3 && std::string_view(argv[1]) == "--proxy")
+    {
+        return RunProxy(argv[2]);
+    }
+
     CoinConfig coinConfig;
     try
     {
@@ -4,13 +4,17 @@
 #include <ranges>
 #include <array>
 #include <charconv>
+#include <concepts>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "config_vrsc.hpp"
 #include "constants.hpp"
 #include "static_config.hpp"
+#include "verushash/verus_hash.h"
 template <StratumProtocol sp>
 struct StratumShareT
 {
@@ -28,6 +32,8 @@ struct StratumShareT<StratumProtocol::ZEC> : public CoinConstantsZec,
     std::string_view solution;
 
     uint32_t time;
+    // nonce2 and solution are raw bytes (binary protocol) instead of hex
+    bool raw = false;
 };
 using ShareZec = StratumShareT<StratumProtocol::ZEC>;
 
@@ -84,14 +90,44 @@ enum class ResCode
     VALID_SHARE = 30,
     VALID_BLOCK = 31,
 };
+// a reply message known at compile time, kept by pointer. the constructor
+// is consteval, so a buffer filled at runtime doesn't convert to it
+struct RpcLiteral
+{
+    template <size_t N>
+    consteval RpcLiteral(const char (&m)[N]) : msg(m, N - 1)
+    {
+    }
+
+    std::string_view msg;
+};
+
 struct RpcResult
 {
-    RpcResult(ResCode e, std::string m = "true") : code(e), msg(m) {}
+    RpcResult(ResCode e) : code(e), literal_msg("true") {}
+    // literals (the common replies) aren't copied
+    RpcResult(ResCode e, RpcLiteral m) : code(e), literal_msg(m.msg) {}
+    // anything else is copied. char arrays only convert to a literal
+    template <typename S>
+        requires std::convertible_to<S, std::string> &&
+                 (!std::is_array_v<std::remove_cvref_t<S>>)
+    RpcResult(ResCode e, S&& m) : code(e), dynamic_msg(std::forward<S>(m))
+    {
+    }
 
     // static RpcResult Ok = RpcResult(ResCode::OK);
 
+    std::string_view Msg() const
+    {
+        return literal_msg.data() ? literal_msg
+                                  : std::string_view(dynamic_msg);
+    }
+
     ResCode code;
-    std::string msg;
+
+   private:
+    std::string_view literal_msg;
+    std::string dynamic_msg;
 };
 struct ShareResult
 {
@@ -99,6 +135,8 @@ struct ShareResult
     std::string message;
     double difficulty = 0.0;
     std::array<uint8_t, 32> hash_bytes;
+    // into the job's share filter once verified
+    uint64_t fingerprint = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef SHARE_FILTER_HPP_
+#define SHARE_FILTER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+
+// the share fingerprints seen for one block height, shared by all the jobs
+// of that height and freed along with the last of them, so there is nothing
+// to clear on a block change.
+// only verified shares are inserted, junk can't fill it.
+// open addressed with linear probing into a table that never grows, inserts
+// from any reactor are a CAS and never take a lock. if all the probed slots
+// are taken the fingerprint goes to a locked overflow set that grows as
+// needed (counted in Overflowed). sizing from the previous height keeps
+// honest load far from it.
+class ShareFilter
+{
+   public:
+    static constexpr uint32_t MIN_CAPACITY_LOG2 = 16;
+    static constexpr uint32_t MAX_CAPACITY_LOG2 = 22;
+    static constexpr uint32_t MAX_PROBES = 32;
+
+    enum class InsertResult
+    {
+        INSERTED,
+        DUPLICATE
+    };
+
+    explicit ShareFilter(uint32_t capacity_log2)
+        : mask((uint64_t{1} << capacity_log2) - 1),
+          // zero pages are only backed once written to
+          slots(static_cast<uint64_t*>(
+                    std::calloc(mask + 1, sizeof(uint64_t))),
+                &std::free)
+    {
+        if (!slots) throw std::bad_alloc();
+    }
+
+    // room for 8x the shares of the last height, blocks can take much longer
+    // than their target time
+    static uint32_t CapacityFor(uint64_t last_size)
+    {
+        const uint32_t log2 = std::bit_width(last_size * 8);
+        return std::clamp(log2, MIN_CAPACITY_LOG2, MAX_CAPACITY_LOG2);
+    }
+
+    InsertResult Insert(uint64_t fingerprint)
+    {
+        // zero marks an empty slot
+        if (fingerprint == 0) fingerprint = 1;
+
+        // the fingerprint is already well mixed
+        uint64_t i = fingerprint & mask;
+        for (uint32_t probe = 0; probe < MAX_PROBES; probe++)
+        {
+            std::atomic_ref<uint64_t> slot(slots[i]);
+            uint64_t cur = slot.load(std::memory_order_relaxed);
+
+            if (cur == 0 &&
+                slot.compare_exchange_strong(cur, fingerprint,
+                                             std::memory_order_relaxed))
+            {
+                size.fetch_add(1, std::memory_order_relaxed);
+                return InsertResult::INSERTED;
+            }
+            // cur is the slot's value if the exchange lost
+            if (cur == fingerprint) return InsertResult::DUPLICATE;
+
+            i = (i + 1) & mask;
+        }
+
+        // slots are never freed, a fingerprint that got here once always
+        // does
+        std::scoped_lock lock(overflow_mutex);
+        if (!overflow.insert(fingerprint).second)
+        {
+            return InsertResult::DUPLICATE;
+        }
+        size.fetch_add(1, std::memory_order_relaxed);
+        overflowed.fetch_add(1, std::memory_order_relaxed);
+        return InsertResult::INSERTED;
+    }
+
+    // a replay of a share that was already accepted, checked before hashing
+    bool Contains(uint64_t fingerprint) const
+    {
+        if (fingerprint == 0) fingerprint = 1;
+
+        uint64_t i = fingerprint & mask;
+        for (uint32_t probe = 0; probe < MAX_PROBES; probe++)
+        {
+            const uint64_t cur =
+                std::atomic_ref<uint64_t>(slots[i]).load(
+                    std::memory_order_relaxed);
+            if (cur == fingerprint) return true;
+            if (cur == 0) return false;
+
+            i = (i + 1) & mask;
+        }
+
+        if (Overflowed() == 0) return false;
+        std::scoped_lock lock(overflow_mutex);
+        return overflow.contains(fingerprint);
+    }
+
+    uint64_t Size() const { return size.load(std::memory_order_relaxed); }
+    uint64_t Capacity() const { return mask + 1; }
+    uint64_t Overflowed() const
+    {
+        return overflowed.load(std::memory_order_relaxed);
+    }
+
+   private:
+    const uint64_t mask;
+    const std::unique_ptr<uint64_t[], decltype(&std::free)> slots;
+    std::atomic<uint64_t> size{0};
+    std::atomic<uint64_t> overflowed{0};
+
+    mutable std::mutex overflow_mutex;
+    std::unordered_set<uint64_t> overflow;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define SHARE_PROCESSOR_HPP_
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iostream>
@@ -12,11 +13,13 @@
 #include "jobs/job_manager.hpp"
 #include "logger.hpp"
 #include "share.hpp"
+#include "share_fingerprint.hpp"
 #include "static_config/static_config.hpp"
 #include "stratum_client.hpp"
 #include "stratum_server.hpp"
 #include "utils.hpp"
 #include "verushash/verus_hash.h"
+#include "verushash/verus_hash_batch.h"
 
 class ShareProcessor
 {
@@ -24,10 +27,23 @@ class ShareProcessor
     static constexpr std::string_view field_str = "ShareProcessor";
     static const Logger logger;
 
+    // cheap checks and the header assembly, on the connection's reactor as
+    // they read the request buffer and the client. false if rejected
     template <StaticConf confs>
-    inline static void Process(
-        ShareResult& result, StratumClient* cli,
-        WorkerContext<confs.BLOCK_HEADER_SIZE>* wc,
+    inline static bool Prepare(
+        ShareResult& result, const StratumClient* cli, uint8_t* block_header,
+        const Job<confs.STRATUM_PROTOCOL>* job,
+        const StratumShareT<confs.STRATUM_PROTOCOL>& share, int64_t curTime)
+    {
+        return Prepare<confs>(result, cli->extra_nonce, block_header, job,
+                              share, curTime);
+    }
+
+    // nonce1 is the header's, not the client's own when its nonce space is a
+    // slice of the pool's (proxy mode)
+    template <StaticConf confs>
+    inline static bool Prepare(
+        ShareResult& result, uint32_t nonce1, uint8_t* block_header,
         const Job<confs.STRATUM_PROTOCOL>* job,
         const StratumShareT<confs.STRATUM_PROTOCOL>& share, int64_t curTime)
     {
@@ -43,71 +59,126 @@ class ShareProcessor
                 result.message =
                     fmt::format("Invalid nTime (min: {}, max: {}, given: {})",
                                 job->min_time, max_time, share.time);
-                return;
+                return false;
             }
         }
 
         // HASH NEEDS TO BE IN LE
         if constexpr (confs.STRATUM_PROTOCOL != StratumProtocol::CN)
         {
-            job->GetHeaderData(wc->block_header.data(), share,
-                               cli->extra_nonce);
+            if (!job->GetHeaderData(block_header, share, nonce1))
+            {
+                result.code = ResCode::UNKNOWN;
+                result.message = "Malformed share";
+                return false;
+            }
         }
 
+        // a replay of an accepted share never reaches the hashing workers,
+        // the share is only inserted once verified
+        result.fingerprint = ShareFingerprint<confs>(block_header, share);
+        if (job->share_filter->Contains(result.fingerprint))
+        {
+            result.code = ResCode::DUPLICATE_SHARE;
+            result.message = "Duplicate share";
+            return false;
+        }
+        return true;
+    }
+
+    // the expensive part, on a hashing worker, for all the tasks it picked up
+    // at once. only reads the jobs and the prepared headers
+    template <StaticConf confs, typename TaskT>
+    inline static void Hash(TaskT* const* tasks, uint32_t count,
+                            CVerusHashV2Batch* hasher)
+    {
         if constexpr (confs.HASH_ALGO == HashAlgo::PROGPOWZ)
         {
-            currency::get_block_longhash_sick(
-                result.hash_bytes.data(), static_cast<uint64_t>(job->height),
-                job->template_hash.data(), share.nonce);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                currency::get_block_longhash_sick(
+                    tasks[i]->result.hash_bytes.data(),
+                    static_cast<uint64_t>(tasks[i]->job->height),
+                    tasks[i]->job->template_hash.data(), tasks[i]->nonce);
+            }
         }
         else if constexpr (confs.HASH_ALGO == HashAlgo::VERUSHASH_V2b2)
         {
-            // takes about 6-8 microseconds vs 8-12 on snomp
-            HashWrapper::VerushashV2b2(
-                result.hash_bytes.data(), wc->block_header.data(),
-                CoinConstantsZec::BLOCK_HEADER_SIZE, &wc->hasher);
+            // the haraka rounds of a batch interleave, about 2x the
+            // shares/s of hashing them one by one (verus_hash_bench).
+            // each header continues from its job's absorbed static part
+            constexpr int lanes = CVerusHashV2Batch::LANES;
+            uint8_t* out[lanes];
+            const uint8_t* in[lanes];
+            const CVerusHashV2Prefix* prefixes[lanes];
+
+            for (uint32_t i = 0; i < count; i += lanes)
+            {
+                const int n = std::min<uint32_t>(lanes, count - i);
+                for (int l = 0; l < n; l++)
+                {
+                    out[l] = tasks[i + l]->result.hash_bytes.data();
+                    in[l] = tasks[i + l]->block_header.data();
+                    prefixes[l] = &tasks[i + l]->job->hash_prefix;
+                }
+                HashWrapper::VerushashV2b2Batch(
+                    out, in, CoinConstantsZec::BLOCK_HEADER_SIZE, n, hasher,
+                    prefixes);
+            }
         }
         else
         {
             throw std::invalid_argument("Missing hash function");
         }
-        // convert to uint32, (this will lose data)
-        // LE, least significant are first (NOT ZEROS)
-        uint32_t share_start = 0;
-        std::memcpy(&share_start, result.hash_bytes.begin(),
-                    sizeof(share_start));
+    }
+
+    // back on the connection's reactor, judges the hashed share against the
+    // client's state
+    template <StaticConf confs>
+    inline static void Verify(ShareResult& result, StratumClient* cli,
+                              const Job<confs.STRATUM_PROTOCOL>* job,
+                              int64_t curTime)
+    {
+        // the client's share target is relative to the maximum target
+        static_assert(confs.DIFF1 == 0x1p256, "DIFF1 isn't the max target");
+
+        cli->SetLastShare(curTime);
+
+        // a compare or two decide, no double math for rejected shares
+        const uint8_t* hash = result.hash_bytes.data();
+        if (job->block_target.IsMetBy(hash)) [[unlikely]]
+        {
+            result.code = ResCode::VALID_BLOCK;
+        }
+        else if (cli->GetShareTarget().IsMetBy(hash)) [[likely]]
+        {
+            result.code = ResCode::VALID_SHARE;
+        }
+        else
+        {
+            result.code = ResCode::LOW_DIFFICULTY_SHARE;
+            result.message = fmt::format("Low difficulty share (Expected: {})",
+                                         cli->GetDifficulty());
+            return;
+        }
 
-        if (!cli->SetLastShare(share_start, curTime))
+        // a copy hashed alongside it loses here
+        if (job->share_filter->Insert(result.fingerprint) ==
+            ShareFilter::InsertResult::DUPLICATE)
         {
             result.code = ResCode::DUPLICATE_SHARE;
             result.message = "Duplicate share";
             return;
         }
 
-        double raw_diff = BytesToDoubleLE(result.hash_bytes);
-        result.difficulty = confs.DIFF1 / raw_diff;
+        // for the round and the stats
+        result.difficulty = confs.DIFF1 / BytesToDoubleLE(result.hash_bytes);
 
 #ifdef DEBUG
         logger.Log<LogType::Debug>("Share hash: {}, diff: {}",
                                    HexlifyS(result.hash_bytes),
                                    result.difficulty);
 #endif
-
-        if (result.difficulty >= job->target_diff) [[unlikely]]
-        {
-            result.code = ResCode::VALID_BLOCK;
-            return;
-        }
-        else if (result.difficulty / cli->GetDifficulty() <
-                 0.99)  // allow 1% below
-        {
-            result.code = ResCode::LOW_DIFFICULTY_SHARE;
-            result.message =
-                fmt::format("Low difficulty share of {} (Expected: {})",
-                            result.difficulty, cli->GetDifficulty());
-        }
-
-        result.code = ResCode::VALID_SHARE;
     }
 };
 #endif
\ No newline at end of file
@@ -30,10 +30,17 @@ struct ServerConstants
 {
 static constexpr uint32_t MAX_CONNECTIONS_QUEUE = 64;
 static constexpr uint32_t MAX_CONNECTION_EVENTS = 32;
-static constexpr uint32_t REQ_BUFF_SIZE = 1024 * 24;
-static constexpr uint32_t REQ_BUFF_SIZE_REAL =
-    ServerConstants::REQ_BUFF_SIZE - simdjson::SIMDJSON_PADDING;
+static constexpr uint32_t MAX_CONNECTIONS_PER_REACTOR = 1 << 16;
+static constexpr uint32_t REQ_BUFF_SIZE = 1024 * 24;  // largest class
+static constexpr uint32_t RECV_BUFF_CACHE_PER_CLASS = 256;
+static constexpr uint32_t MAX_REQ_LINE_LEN = 1024 * 16;
 static constexpr uint32_t EPOLL_TIMEOUT = 1000;  // ms
+static constexpr uint32_t TIMER_TICK_MS = 100;
+static constexpr uint32_t TIMER_WHEEL_SLOTS = 512;  // ~51s per revolution
+// io_uring engine
+static constexpr uint32_t URING_ENTRIES = 4096;
+static constexpr uint32_t URING_BUF_COUNT = 4096;  // per reactor, power of 2
+static constexpr uint32_t URING_BUF_SIZE = 1024 * 2;
 };
 
 struct StratumConstants
@@ -0,0 +1,446 @@
+#ifndef BINARY_PROTOCOL_HPP_
+#define BINARY_PROTOCOL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "line_framer.hpp"
+
+// a compact binary alternative to the json line protocol, modelled on stratum
+// v2's standard channels but not wire compatible with it. frames have sv2's
+// 6 byte header, fields are fixed size little endian integers and raw bytes
+// where json carries hex (the vrsc solution is 1347 bytes instead of 2694 hex
+// characters). a connection is a single channel, so sv2's channel ids are
+// left out, and a job's clean flag does what sv2's SetNewPrevHash does.
+// only depends on the standard library, the reference client
+// (benchmark/binary_client.cpp) includes it as is.
+class BinaryProtocol
+{
+   public:
+    static constexpr uint16_t VERSION = 1;
+
+    // extension type (u16, always 0), message type (u8), payload size (u24)
+    static constexpr size_t HEADER_SIZE = 6;
+    // the biggest message is a submit, anything above is a protocol error
+    static constexpr size_t MAX_PAYLOAD_SIZE = 2048;
+
+    // equihash-style header (vrsc) fields
+    static constexpr size_t HEADER_HASH_SIZE = 32;
+    static constexpr size_t TARGET_SIZE = 32;
+    static constexpr size_t NONCE2_SIZE = 28;
+    // with its 3 byte length prefix
+    static constexpr size_t SOLUTION_FIELD_SIZE = 1347;
+    // the part of the solution the template fixes
+    static constexpr size_t SOLUTION_PREFIX_SIZE = 72;
+    // STR0_255
+    static constexpr size_t MAX_STR_SIZE = 255;
+
+    enum class MsgType : uint8_t
+    {
+        SETUP_CONNECTION = 0x00,
+        SETUP_CONNECTION_SUCCESS = 0x01,
+        SETUP_CONNECTION_ERROR = 0x02,
+        OPEN_STANDARD_MINING_CHANNEL = 0x10,
+        OPEN_STANDARD_MINING_CHANNEL_SUCCESS = 0x11,
+        OPEN_MINING_CHANNEL_ERROR = 0x12,
+        NEW_MINING_JOB = 0x15,
+        SET_TARGET = 0x18,
+        SUBMIT_SHARES_STANDARD = 0x1a,
+        SUBMIT_SHARES_SUCCESS = 0x1c,
+        SUBMIT_SHARES_ERROR = 0x1d,
+    };
+
+    // sequential little endian writes, the buffer is sized by the message's
+    // MAX_SIZE
+    class Writer
+    {
+       public:
+        explicit Writer(char* pos) : pos(pos) {}
+
+        template <typename IntT>
+        void Int(IntT value)
+        {
+            for (size_t i = 0; i < sizeof(IntT); i++)
+            {
+                *pos++ = static_cast<char>(value >> (i * 8));
+            }
+        }
+
+        void Bytes(const void* data, size_t size)
+        {
+            std::memcpy(pos, data, size);
+            pos += size;
+        }
+
+        // truncated to MAX_STR_SIZE
+        void Str(std::string_view str)
+        {
+            const size_t size = std::min(str.size(), MAX_STR_SIZE);
+            Int(static_cast<uint8_t>(size));
+            Bytes(str.data(), size);
+        }
+
+        char* pos;
+    };
+
+    // sequential little endian reads, every read fails past the end
+    class Reader
+    {
+       public:
+        explicit Reader(std::string_view payload)
+            : pos(payload.data()), end(payload.data() + payload.size())
+        {
+        }
+
+        template <typename IntT>
+        bool Int(IntT& value)
+        {
+            if (static_cast<size_t>(end - pos) < sizeof(IntT)) return false;
+
+            value = 0;
+            for (size_t i = 0; i < sizeof(IntT); i++)
+            {
+                value |= static_cast<IntT>(static_cast<IntT>(
+                                               static_cast<uint8_t>(*pos++))
+                                           << (i * 8));
+            }
+            return true;
+        }
+
+        // a view into the payload
+        bool Bytes(std::string_view& value, size_t size)
+        {
+            if (static_cast<size_t>(end - pos) < size) return false;
+            value = std::string_view(pos, size);
+            pos += size;
+            return true;
+        }
+
+        template <size_t N>
+        bool Bytes(std::array<uint8_t, N>& value)
+        {
+            std::string_view bytes;
+            if (!Bytes(bytes, N)) return false;
+            std::memcpy(value.data(), bytes.data(), N);
+            return true;
+        }
+
+        bool Str(std::string_view& value)
+        {
+            uint8_t size;
+            return Int(size) && Bytes(value, size);
+        }
+
+        bool Done() const { return pos == end; }
+
+       private:
+        const char* pos;
+        const char* const end;
+    };
+
+    struct SetupConnection
+    {
+        static constexpr MsgType TYPE = MsgType::SETUP_CONNECTION;
+        static constexpr size_t MAX_SIZE =
+            HEADER_SIZE + 2 + 2 + 4 + 1 + MAX_STR_SIZE;
+
+        uint16_t min_version;
+        uint16_t max_version;
+        uint32_t flags;
+        std::string_view user_agent;
+
+        void Write(Writer& w) const
+        {
+            w.Int(min_version);
+            w.Int(max_version);
+            w.Int(flags);
+            w.Str(user_agent);
+        }
+
+        bool Read(Reader& r)
+        {
+            return r.Int(min_version) && r.Int(max_version) &&
+                   r.Int(flags) && r.Str(user_agent);
+        }
+    };
+
+    struct SetupConnectionSuccess
+    {
+        static constexpr MsgType TYPE = MsgType::SETUP_CONNECTION_SUCCESS;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 2 + 4;
+
+        uint16_t used_version;
+        uint32_t flags;
+
+        void Write(Writer& w) const
+        {
+            w.Int(used_version);
+            w.Int(flags);
+        }
+
+        bool Read(Reader& r) { return r.Int(used_version) && r.Int(flags); }
+    };
+
+    struct SetupConnectionError
+    {
+        static constexpr MsgType TYPE = MsgType::SETUP_CONNECTION_ERROR;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 + 1 + MAX_STR_SIZE;
+
+        uint32_t flags;
+        std::string_view error;
+
+        void Write(Writer& w) const
+        {
+            w.Int(flags);
+            w.Str(error);
+        }
+
+        bool Read(Reader& r) { return r.Int(flags) && r.Str(error); }
+    };
+
+    // authorizes the user ("address.worker") for the connection
+    struct OpenChannel
+    {
+        static constexpr MsgType TYPE = MsgType::OPEN_STANDARD_MINING_CHANNEL;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 + 1 + MAX_STR_SIZE;
+
+        uint32_t request_id;
+        std::string_view user;
+
+        void Write(Writer& w) const
+        {
+            w.Int(request_id);
+            w.Str(user);
+        }
+
+        bool Read(Reader& r) { return r.Int(request_id) && r.Str(user); }
+    };
+
+    struct OpenChannelSuccess
+    {
+        static constexpr MsgType TYPE =
+            MsgType::OPEN_STANDARD_MINING_CHANNEL_SUCCESS;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 + TARGET_SIZE + 4;
+
+        uint32_t request_id;
+        // little endian, the share target until a SetTarget
+        std::array<uint8_t, TARGET_SIZE> target;
+        // goes right after the bits in the header (json's nonce1)
+        uint32_t extranonce;
+
+        void Write(Writer& w) const
+        {
+            w.Int(request_id);
+            w.Bytes(target.data(), target.size());
+            w.Int(extranonce);
+        }
+
+        bool Read(Reader& r)
+        {
+            return r.Int(request_id) && r.Bytes(target) && r.Int(extranonce);
+        }
+    };
+
+    struct OpenChannelError
+    {
+        static constexpr MsgType TYPE = MsgType::OPEN_MINING_CHANNEL_ERROR;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 + 1 + MAX_STR_SIZE;
+
+        uint32_t request_id;
+        std::string_view error;
+
+        void Write(Writer& w) const
+        {
+            w.Int(request_id);
+            w.Str(error);
+        }
+
+        bool Read(Reader& r) { return r.Int(request_id) && r.Str(error); }
+    };
+
+    // the header fields in block encoding, they are copied into the header
+    // as they are
+    struct NewMiningJob
+    {
+        static constexpr MsgType TYPE = MsgType::NEW_MINING_JOB;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 + 1 + 4 +
+                                           HEADER_HASH_SIZE * 3 + 4 + 4 +
+                                           SOLUTION_PREFIX_SIZE;
+
+        uint32_t job_id;
+        // the previous jobs are void
+        bool clean;
+        uint32_t version;
+        std::array<uint8_t, HEADER_HASH_SIZE> prev_hash;
+        std::array<uint8_t, HEADER_HASH_SIZE> merkle_root;
+        std::array<uint8_t, HEADER_HASH_SIZE> final_sroot;
+        uint32_t min_time;
+        uint32_t bits;
+        std::array<uint8_t, SOLUTION_PREFIX_SIZE> solution_prefix;
+
+        void Write(Writer& w) const
+        {
+            w.Int(job_id);
+            w.Int(static_cast<uint8_t>(clean));
+            w.Int(version);
+            w.Bytes(prev_hash.data(), prev_hash.size());
+            w.Bytes(merkle_root.data(), merkle_root.size());
+            w.Bytes(final_sroot.data(), final_sroot.size());
+            w.Int(min_time);
+            w.Int(bits);
+            w.Bytes(solution_prefix.data(), solution_prefix.size());
+        }
+
+        bool Read(Reader& r)
+        {
+            uint8_t clean_byte;
+            if (!r.Int(job_id) || !r.Int(clean_byte) || !r.Int(version) ||
+                !r.Bytes(prev_hash) || !r.Bytes(merkle_root) ||
+                !r.Bytes(final_sroot) || !r.Int(min_time) || !r.Int(bits) ||
+                !r.Bytes(solution_prefix))
+            {
+                return false;
+            }
+            clean = clean_byte != 0;
+            return true;
+        }
+    };
+
+    struct SetTarget
+    {
+        static constexpr MsgType TYPE = MsgType::SET_TARGET;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + TARGET_SIZE;
+
+        // little endian
+        std::array<uint8_t, TARGET_SIZE> target;
+
+        void Write(Writer& w) const { w.Bytes(target.data(), target.size()); }
+
+        bool Read(Reader& r) { return r.Bytes(target); }
+    };
+
+    struct SubmitShare
+    {
+        static constexpr MsgType TYPE = MsgType::SUBMIT_SHARES_STANDARD;
+        static constexpr size_t MAX_SIZE =
+            HEADER_SIZE + 4 + 4 + 4 + NONCE2_SIZE + SOLUTION_FIELD_SIZE;
+
+        // echoed in the reply
+        uint32_t sequence;
+        uint32_t job_id;
+        uint32_t time;
+        // views into the payload
+        std::string_view nonce2;
+        std::string_view solution;
+
+        void Write(Writer& w) const
+        {
+            w.Int(sequence);
+            w.Int(job_id);
+            w.Int(time);
+            w.Bytes(nonce2.data(), NONCE2_SIZE);
+            w.Bytes(solution.data(), SOLUTION_FIELD_SIZE);
+        }
+
+        bool Read(Reader& r)
+        {
+            return r.Int(sequence) && r.Int(job_id) && r.Int(time) &&
+                   r.Bytes(nonce2, NONCE2_SIZE) &&
+                   r.Bytes(solution, SOLUTION_FIELD_SIZE);
+        }
+    };
+
+    struct SubmitSuccess
+    {
+        static constexpr MsgType TYPE = MsgType::SUBMIT_SHARES_SUCCESS;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4;
+
+        uint32_t sequence;
+
+        void Write(Writer& w) const { w.Int(sequence); }
+
+        bool Read(Reader& r) { return r.Int(sequence); }
+    };
+
+    struct SubmitError
+    {
+        static constexpr MsgType TYPE = MsgType::SUBMIT_SHARES_ERROR;
+        static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 + 1 + MAX_STR_SIZE;
+
+        uint32_t sequence;
+        std::string_view error;
+
+        void Write(Writer& w) const
+        {
+            w.Int(sequence);
+            w.Str(error);
+        }
+
+        bool Read(Reader& r) { return r.Int(sequence) && r.Str(error); }
+    };
+
+    // the whole frame, out must hold Msg::MAX_SIZE
+    template <typename Msg>
+    static size_t Encode(char* out, const Msg& msg)
+    {
+        Writer payload(out + HEADER_SIZE);
+        msg.Write(payload);
+        const size_t payload_size = payload.pos - out - HEADER_SIZE;
+
+        Writer header(out);
+        header.Int(uint16_t{0});
+        header.Int(static_cast<uint8_t>(Msg::TYPE));
+        for (size_t i = 0; i < 3; i++)
+        {
+            header.Int(static_cast<uint8_t>(payload_size >> (i * 8)));
+        }
+        return payload_size + HEADER_SIZE;
+    }
+
+    // false unless the payload is exactly the message
+    template <typename Msg>
+    static bool Decode(std::string_view payload, Msg& msg)
+    {
+        Reader reader(payload);
+        return msg.Read(reader) && reader.Done();
+    }
+
+    // splits the frames out of [start, end) of a buffer, like FrameLines.
+    // BAD_FRAME on an extension or a payload above MAX_PAYLOAD_SIZE, nothing
+    // after it can be trusted
+    template <typename Func>
+    static FrameStatus Frame(const char* buff, size_t& start, size_t end,
+                             Func&& on_frame)
+    {
+        while (end - start >= HEADER_SIZE)
+        {
+            const auto* header =
+                reinterpret_cast<const uint8_t*>(buff + start);
+            const uint16_t extension = header[0] | (header[1] << 8);
+            const size_t size = header[3] | (header[4] << 8) | (header[5] << 16);
+
+            if (extension != 0 || size > MAX_PAYLOAD_SIZE)
+            {
+                return FrameStatus::BAD_FRAME;
+            }
+
+            if (end - start - HEADER_SIZE < size) break;
+
+            on_frame(static_cast<MsgType>(header[2]),
+                     std::string_view(buff + start + HEADER_SIZE, size));
+            start += HEADER_SIZE + size;
+        }
+        return FrameStatus::OK;
+    }
+};
+
+static_assert(BinaryProtocol::SubmitShare::MAX_SIZE -
+                      BinaryProtocol::HEADER_SIZE <=
+                  BinaryProtocol::MAX_PAYLOAD_SIZE,
+              "A submit doesn't fit a frame");
+
+#endif
@@ -3,31 +3,59 @@
 
 #include <arpa/inet.h>
 
-#include <string>
-#include <list>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include "constants.hpp"
 
+#include "output_queue.hpp"
 #include "static_config.hpp"
+#include "timing_wheel.hpp"
+
+// slot generation << 32 | slot index, see ConnectionSlab
+using ConnectionHandle = uint64_t;
+
+// openssl's session, see TlsAcceptor
+struct ssl_st;
 
 template <typename T>
 struct Connection
 {
     public: 
-    explicit Connection(const int sfd, const in_addr& addr, const int tfd = 0) : sockfd(sfd), timerfd(tfd), ip(ip_str, sizeof(ip_str))
+    explicit Connection(const int sfd, const in_addr& addr,
+                        const uint32_t reactor = 0, const uint8_t listener = 0)
+        : sockfd(sfd),
+          reactor_id(reactor),
+          listener(listener),
+          ip(ip_str, sizeof(ip_str))
     {
         inet_ntop(AF_INET, &addr, ip_str, sizeof(ip_str));
     }
     
     const int sockfd;
-    const int timerfd;
+    ConnectionHandle handle = 0;
+    // the reactor (thread) that owns this connection for its whole life
+    const uint32_t reactor_id;
+    // index of the port it was accepted on, see Server's ports
+    const uint8_t listener;
     const std::string_view ip;
     int expiration_count = 0;
+    // idle timeout, reset on every readable event
+    TimerNode timer;
 
+    // pooled, only held while a partial request is pending (nullptr if none)
+    char* req_buff = nullptr;
+    // [req_start, req_pos) is unconsumed, [req_start, req_scan) holds no '\n'
+    size_t req_start = 0;
+    size_t req_scan = 0;
     size_t req_pos = 0;
-    char req_buff[ServerConstants::REQ_BUFF_SIZE];
+    uint32_t req_cap = 0;
+    uint8_t req_class = 0;
+    OutputQueue output;
+    // the handshake of a tls listener's connection, nullptr once the kernel
+    // has its keys (the output is corked until then)
+    ssl_st* tls = nullptr;
     std::shared_ptr<T> ptr;
-    std::list<std::shared_ptr<Connection<T>>>::iterator it;
 
     // private:
      char ip_str[INET_ADDRSTRLEN] = {0};
@@ -0,0 +1,140 @@
+#ifndef CONNECTION_SLAB_HPP_
+#define CONNECTION_SLAB_HPP_
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "connection.hpp"
+
+// preallocated connection table, a slot is found from its handle in O(1) and
+// a handle that outlived its connection (stale epoll event, slot reused) is
+// detected by its generation. single threaded, owned by a reactor.
+template <typename T>
+class ConnectionSlab
+{
+   public:
+    explicit ConnectionSlab(uint32_t capacity) : capacity(capacity)
+    {
+        // anonymous mappings are zeroed and only backed on first touch, so
+        // unused slots cost no memory (generation 0, unused)
+        void* mem = mmap(nullptr, sizeof(Slot) * capacity,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if (mem == MAP_FAILED)
+        {
+            throw std::invalid_argument("Failed to map connection slab");
+        }
+
+        slots = static_cast<Slot*>(mem);
+        free_list.reserve(capacity);
+    }
+
+    ~ConnectionSlab()
+    {
+        ForEach([](Connection<T>* conn) { conn->~Connection<T>(); });
+        munmap(slots, sizeof(Slot) * capacity);
+    }
+
+    ConnectionSlab(const ConnectionSlab&) = delete;
+    ConnectionSlab& operator=(const ConnectionSlab&) = delete;
+
+    // returns nullptr when the slab is full
+    template <typename... Args>
+    Connection<T>* Allocate(Args&&... args)
+    {
+        uint32_t index;
+        if (!free_list.empty())
+        {
+            // LIFO, reuse the hottest slot
+            index = free_list.back();
+            free_list.pop_back();
+        }
+        else if (high_water < capacity)
+        {
+            index = high_water++;
+        }
+        else
+        {
+            return nullptr;
+        }
+
+        Slot& slot = slots[index];
+        // never 0, so a handle can't be mistaken for a null pointer
+        if (++slot.generation == 0) slot.generation = 1;
+        slot.used = true;
+
+        auto* conn = new (slot.storage) Connection<T>(std::forward<Args>(args)...);
+        conn->handle = MakeHandle(slot.generation, index);
+        used_count++;
+
+        return conn;
+    }
+
+    // nullptr if the handle is stale
+    Connection<T>* Get(ConnectionHandle handle) const
+    {
+        const uint32_t index = static_cast<uint32_t>(handle);
+        const uint32_t generation = static_cast<uint32_t>(handle >> 32);
+
+        if (index >= high_water) return nullptr;
+
+        Slot& slot = slots[index];
+        if (!slot.used || slot.generation != generation) return nullptr;
+
+        return slot.Get();
+    }
+
+    void Free(Connection<T>* conn)
+    {
+        const auto index = static_cast<uint32_t>(conn->handle);
+
+        conn->~Connection<T>();
+        slots[index].used = false;
+        free_list.push_back(index);
+        used_count--;
+    }
+
+    template <typename Func>
+    void ForEach(Func&& func)
+    {
+        for (uint32_t i = 0; i < high_water; i++)
+        {
+            if (slots[i].used) func(slots[i].Get());
+        }
+    }
+
+    uint32_t Size() const { return used_count; }
+
+    static constexpr ConnectionHandle MakeHandle(uint32_t generation,
+                                                 uint32_t index)
+    {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+   private:
+    struct alignas(64) Slot
+    {
+        uint32_t generation;
+        bool used;
+        alignas(Connection<T>) unsigned char storage[sizeof(Connection<T>)];
+
+        Connection<T>* Get()
+        {
+            return std::launder(reinterpret_cast<Connection<T>*>(storage));
+        }
+    };
+
+    const uint32_t capacity;
+    Slot* slots;
+    // slots below have been constructed at least once
+    uint32_t high_water = 0;
+    uint32_t used_count = 0;
+    std::vector<uint32_t> free_list;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef HASHING_POOL_HPP_
+#define HASHING_POOL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.hpp"
+#include "mpsc_queue.hpp"
+
+// share verification workers, so a burst of submits costs hashing cores and
+// not reactor time. reactors hand tasks in without locking (every worker has
+// its own mpsc queue, picked round robin), a task is passed back through
+// on_hashed on the worker's thread. ContextT is the per worker hashing state.
+// a worker hands everything already queued for it (up to MAX_BATCH) to hash
+// in one call, so multi buffer hashing can fill its lanes under load without
+// ever waiting for more work.
+template <typename TaskT, typename ContextT>
+class HashingPool
+{
+   public:
+    static constexpr uint32_t MAX_BATCH = 8;
+
+    using HashFn = std::function<void(TaskT* const*, uint32_t, ContextT*)>;
+    using DoneFn = std::function<void(TaskT*)>;
+
+    HashingPool(uint32_t worker_count, HashFn hash, DoneFn on_hashed)
+        : hash(std::move(hash)), on_hashed(std::move(on_hashed))
+    {
+        workers.reserve(worker_count);
+        for (uint32_t i = 0; i < worker_count; i++)
+        {
+            auto& worker = workers.emplace_back(std::make_unique<Worker>());
+            worker->thread = std::jthread(
+                std::bind_front(&HashingPool::Work, this), worker.get());
+        }
+    }
+
+    ~HashingPool()
+    {
+        for (auto& worker : workers)
+        {
+            worker->thread.request_stop();
+            worker->ready.release();
+        }
+
+        for (auto& worker : workers)
+        {
+            worker->thread.join();
+            while (TaskT* task = worker->queue.Pop()) delete task;
+        }
+    }
+
+    HashingPool(const HashingPool&) = delete;
+    HashingPool& operator=(const HashingPool&) = delete;
+
+    // takes ownership until on_hashed, any thread
+    void Submit(TaskT* task) { Submit(&task, 1); }
+
+    // all to the same worker, which takes up to MAX_BATCH of them in one go
+    void Submit(TaskT* const* tasks, uint32_t count)
+    {
+        const uint32_t i =
+            next_worker.fetch_add(1, std::memory_order_relaxed) %
+            workers.size();
+        Worker* worker = workers[i].get();
+
+        const auto now = std::chrono::steady_clock::now();
+        depth.fetch_add(count, std::memory_order_relaxed);
+        for (uint32_t j = 0; j < count; j++)
+        {
+            tasks[j]->queued = now;
+            worker->queue.Push(tasks[j]);
+        }
+        worker->ready.release(count);
+    }
+
+    uint32_t WorkerCount() const { return workers.size(); }
+    // submitted but not picked up by a worker yet
+    uint64_t Depth() const { return depth.load(std::memory_order_relaxed); }
+
+    // submitted -> picked up, picked up -> hashed
+    LatencyHistogram queue_latency;
+    LatencyHistogram hash_latency;
+
+   private:
+    struct Worker
+    {
+        MpscQueue<TaskT> queue;
+        std::counting_semaphore<> ready{0};
+        std::jthread thread;
+    };
+
+    const HashFn hash;
+    const DoneFn on_hashed;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint32_t> next_worker{0};
+    std::atomic<uint64_t> depth{0};
+
+    void Work(std::stop_token st, Worker* worker)
+    {
+        using namespace std::chrono;
+        ContextT ctx;
+
+        TaskT* batch[MAX_BATCH];
+
+        while (true)
+        {
+            // one release per task, so a task is always there once acquired
+            worker->ready.acquire();
+            uint32_t count = 1;
+            while (count < MAX_BATCH && worker->ready.try_acquire()) count++;
+            // the stop release may have been taken by either
+            if (st.stop_requested()) break;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                // the producer may be between its exchange and its link
+                while ((batch[i] = worker->queue.Pop()) == nullptr)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            depth.fetch_sub(count, std::memory_order_relaxed);
+
+            const auto start = steady_clock::now();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                queue_latency.Record(
+                    duration_cast<microseconds>(start - batch[i]->queued)
+                        .count());
+            }
+
+            hash(batch, count, &ctx);
+
+            const auto hashed = steady_clock::now();
+            const auto hash_us =
+                duration_cast<microseconds>(hashed - start).count();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                batch[i]->hashed = hashed;
+                hash_latency.Record(hash_us);
+                on_hashed(batch[i]);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef LATENCY_HISTOGRAM_HPP_
+#define LATENCY_HISTOGRAM_HPP_
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+// log2 buckets of microseconds (bucket i holds [2^(i-1), 2^i) us), lock free
+// so every reactor can record into the same one
+class LatencyHistogram
+{
+   public:
+    static constexpr uint32_t BUCKETS = 32;
+
+    void Record(uint64_t us)
+    {
+        const uint32_t bucket =
+            std::min(static_cast<uint32_t>(std::bit_width(us)), BUCKETS - 1);
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t prev_max = max.load(std::memory_order_relaxed);
+        while (us > prev_max &&
+               !max.compare_exchange_weak(prev_max, us,
+                                          std::memory_order_relaxed))
+        {
+        }
+    }
+
+    uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return max.load(std::memory_order_relaxed); }
+
+    // upper bound of the bucket the percentile falls in
+    uint64_t Percentile(double percent) const
+    {
+        const uint64_t total = Count();
+        if (total == 0) return 0;
+
+        const auto target = static_cast<uint64_t>(total * percent / 100.0);
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; i++)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen > target) return i == 0 ? 0 : (1ULL << i) - 1;
+        }
+        return Max();
+    }
+
+    // starts a new window, records racing with it may land in either
+    void Reset()
+    {
+        for (auto& bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    std::string ToString() const
+    {
+        return fmt::format("n={} p50<={}us p90<={}us p99<={}us max={}us",
+                           Count(), Percentile(50), Percentile(90),
+                           Percentile(99), Max());
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> max{0};
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef LINE_FRAMER_HPP_
+#define LINE_FRAMER_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+enum class FrameStatus
+{
+    OK,
+    LINE_TOO_LONG,
+    // binary protocol, see BinaryProtocol::Frame
+    BAD_FRAME
+};
+
+// splits newline delimited requests out of [start, end) of a buffer. only the
+// bytes past scan (never seen before) are searched, with memchr which glibc
+// vectorizes (AVX2/SSE2). [start, scan) is known to hold no delimiter, so a
+// partial request is never rescanned and its length is checked in O(1).
+template <typename Func>
+inline FrameStatus FrameLines(const char* buff, size_t& start, size_t& scan,
+                              size_t end, size_t max_line, Func&& on_line)
+{
+    while (scan < end)
+    {
+        const auto* delim = static_cast<const char*>(
+            std::memchr(buff + scan, '\n', end - scan));
+
+        if (delim == nullptr)
+        {
+            scan = end;
+            break;
+        }
+
+        const size_t delim_pos = delim - buff;
+        on_line(std::string_view(buff + start, delim_pos - start));
+        start = delim_pos + 1;
+        scan = start;
+    }
+
+    if (end - start > max_line)
+    {
+        return FrameStatus::LINE_TOO_LONG;
+    }
+    return FrameStatus::OK;
+}
+
+#endif
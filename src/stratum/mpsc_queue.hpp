@@ -0,0 +1,80 @@
+#ifndef MPSC_QUEUE_HPP_
+#define MPSC_QUEUE_HPP_
+
+#include <atomic>
+
+struct MpscNode
+{
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+// intrusive multi producer single consumer queue (Vyukov). a push is a single
+// atomic exchange and never waits, so producers (reactors, hashing workers)
+// don't contend on a lock. T derives from MpscNode, the queue doesn't own it.
+template <typename T>
+class MpscQueue
+{
+   public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T* item) { Push(static_cast<MpscNode*>(item)); }
+
+    // consumer only. nullptr if empty, or if a push is half way through (it
+    // exchanged head but hasn't linked yet), in which case retry shortly
+    T* Pop()
+    {
+        MpscNode* first = tail;
+        MpscNode* next = first->next.load(std::memory_order_acquire);
+
+        if (first == &stub)
+        {
+            if (next == nullptr) return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail = next;
+            return static_cast<T*>(first);
+        }
+
+        if (first != head.load(std::memory_order_acquire)) return nullptr;
+
+        // first is the last item, put the stub behind it so it can be taken
+        Push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            tail = next;
+            return static_cast<T*>(first);
+        }
+        return nullptr;
+    }
+
+    // consumer only
+    bool Empty() const
+    {
+        return tail == &stub &&
+               stub.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+   private:
+    void Push(MpscNode* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // producers and the consumer on separate cache lines
+    alignas(64) std::atomic<MpscNode*> head;
+    alignas(64) MpscNode* tail;
+    MpscNode stub;
+};
+
+#endif
@@ -0,0 +1,311 @@
+#ifndef OUTPUT_QUEUE_HPP_
+#define OUTPUT_QUEUE_HPP_
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// bytes still pending after the operation, or SEND_ERROR if the socket failed
+// (the queue is then closed and drops everything)
+static constexpr int64_t SEND_ERROR = -1;
+
+// a reserved place in the output for a reply that isn't known yet
+using ReplySlot = uint64_t;
+
+// per connection pending output. writes go straight to the socket while
+// nothing is queued, otherwise (kernel buffer full / corked) they are queued
+// and sent together in one write once the socket is writable again
+// (EPOLLOUT) or the connection is uncorked. queued bytes are appended to one
+// contiguous buffer that is kept between bursts, so queueing doesn't allocate
+// once it has grown to the connection's usual burst. a reply that is only
+// known later (a share being hashed) reserves its slot, whatever is written
+// after it waits until it's filled in, so replies keep the requests' order.
+// with external sends (io_uring) it never touches the socket, the owner
+// takes what's sendable and reports back how much of it went.
+// single threaded, only written by the connection's reactor.
+class OutputQueue
+{
+   public:
+    // a drained buffer bigger than this is released, a slow reader's backlog
+    // isn't kept for the connection's lifetime
+    static constexpr size_t MAX_IDLE_CAPACITY = 64 * 1024;
+
+    int64_t Write(int sockfd, std::string_view msg)
+    {
+        if (closed) return SEND_ERROR;
+
+        if (corked || external_send || Pending() != 0 || HasOpenSlot())
+        {
+            Append(msg);
+            return static_cast<int64_t>(Pending());
+        }
+
+        // fast path, no copy
+        ssize_t sent = send(sockfd, msg.data(), msg.size(),
+                            MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (sent == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return Discard();
+            sent = 0;
+        }
+
+        if (static_cast<size_t>(sent) < msg.size())
+        {
+            // wait for EPOLLOUT
+            Append(msg.substr(sent));
+        }
+
+        return static_cast<int64_t>(Pending());
+    }
+
+    // everything written from now on waits for the slot's Fill
+    ReplySlot Reserve()
+    {
+        const ReplySlot slot = first_slot + (slots.size() - slots_head);
+        slots.push_back(Slot{base + buff.size(), false});
+        return slot;
+    }
+
+    // the reply in its reserved place, sent with what it held back unless
+    // corked
+    int64_t Fill(int sockfd, ReplySlot slot, std::string_view msg)
+    {
+        if (closed) return SEND_ERROR;
+
+        const size_t index = slots_head + (slot - first_slot);
+        const size_t offset = slots[index].pos - base;
+        buff.insert(buff.begin() + offset, msg.begin(), msg.end());
+
+        slots[index].filled = true;
+        for (size_t i = index + 1; i < slots.size(); i++)
+        {
+            slots[i].pos += msg.size();
+        }
+        PopFilledSlots();
+
+        if (corked) return static_cast<int64_t>(Pending());
+        return Flush(sockfd);
+    }
+
+    int64_t Flush(int sockfd)
+    {
+        if (closed) return SEND_ERROR;
+        if (external_send) return static_cast<int64_t>(Pending());
+
+        // up to the first reply that isn't filled in
+        while (head != Sendable())
+        {
+            ssize_t sent = send(sockfd, buff.data() + head, Sendable() - head,
+                                MSG_NOSIGNAL | MSG_DONTWAIT);
+
+            if (sent == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return Discard();
+            }
+
+            Consume(static_cast<size_t>(sent));
+        }
+
+        return static_cast<int64_t>(Pending());
+    }
+
+    // hold writes until Uncork, so a burst of replies costs one syscall
+    void Cork() { corked = true; }
+    bool IsCorked() const { return corked; }
+
+    int64_t Uncork(int sockfd)
+    {
+        corked = false;
+        return Flush(sockfd);
+    }
+
+    // drop everything pending and refuse further writes
+    void Shutdown() { Discard(); }
+
+    // writes only queue, the owner sends with TakeSend and SendDone
+    void SetExternalSend() { external_send = true; }
+
+    // one external send at a time, so they keep their order
+    bool CanTakeSend() const
+    {
+        return external_send && !sending && !closed &&
+               (sending_head != in_flight.size() ||
+                (!corked && head != Sendable()));
+    }
+
+    // the rest of a partial send, or whatever is sendable now. stays valid
+    // until SendDone, writes meanwhile queue behind it
+    std::string_view TakeSend()
+    {
+        if (sending_head == in_flight.size())
+        {
+            in_flight.clear();
+            sending_head = 0;
+            if (!HasOpenSlot())
+            {
+                // all of it, the buffers trade places
+                in_flight.swap(buff);
+                in_flight.erase(in_flight.begin(), in_flight.begin() + head);
+                base += head + in_flight.size();
+                head = 0;
+            }
+            else
+            {
+                in_flight.assign(buff.begin() + head,
+                                 buff.begin() + Sendable());
+                Consume(in_flight.size());
+            }
+        }
+
+        sending = true;
+        return std::string_view(in_flight.data() + sending_head,
+                                in_flight.size() - sending_head);
+    }
+
+    // res as the send returned it, -errno if it failed
+    int64_t SendDone(int res)
+    {
+        sending = false;
+        // whoever closed it is already disconnecting the client
+        if (closed) return 0;
+        if (res < 0)
+        {
+            errno = -res;
+            return Discard();
+        }
+
+        sending_head += static_cast<size_t>(res);
+        if (sending_head == in_flight.size())
+        {
+            sending_head = 0;
+            if (in_flight.capacity() > MAX_IDLE_CAPACITY)
+            {
+                std::vector<char>().swap(in_flight);
+            }
+            else
+            {
+                in_flight.clear();
+            }
+        }
+        return static_cast<int64_t>(Pending());
+    }
+
+    bool IsSending() const { return sending; }
+
+    // the taken bytes, for a connection freed while its send is in flight.
+    // the kernel may still read them
+    std::vector<char> ReleaseInFlight() { return std::move(in_flight); }
+
+   private:
+    struct Slot
+    {
+        // in bytes ever queued, see base
+        uint64_t pos;
+        bool filled;
+    };
+
+    std::vector<char> buff;
+    // bytes of buff already sent
+    size_t head = 0;
+    // bytes queued before buff[0]
+    uint64_t base = 0;
+    // [slots_head, end) from the oldest slot not filled in yet
+    std::vector<Slot> slots;
+    size_t slots_head = 0;
+    ReplySlot first_slot = 0;
+    bool corked = false;
+    bool closed = false;
+
+    bool external_send = false;
+    // taken by the external send, [sending_head, end) not sent yet
+    std::vector<char> in_flight;
+    size_t sending_head = 0;
+    bool sending = false;
+
+    size_t Pending() const
+    {
+        return buff.size() - head + in_flight.size() - sending_head;
+    }
+
+    bool HasOpenSlot() const { return slots_head != slots.size(); }
+
+    size_t Sendable() const
+    {
+        return HasOpenSlot() ? slots[slots_head].pos - base : buff.size();
+    }
+
+    int64_t Discard()
+    {
+        closed = true;
+        // a send in flight still reads it
+        if (!sending)
+        {
+            std::vector<char>().swap(in_flight);
+            sending_head = 0;
+        }
+        std::vector<char>().swap(buff);
+        std::vector<Slot>().swap(slots);
+        head = 0;
+        slots_head = 0;
+        return SEND_ERROR;
+    }
+
+    void Append(std::string_view msg)
+    {
+        // move the unsent tail to the front instead of growing
+        if (head != 0 && buff.size() + msg.size() > buff.capacity())
+        {
+            std::memmove(buff.data(), buff.data() + head, Pending());
+            buff.resize(Pending());
+            base += head;
+            head = 0;
+        }
+        buff.insert(buff.end(), msg.begin(), msg.end());
+    }
+
+    void Consume(size_t sent)
+    {
+        head += sent;
+        if (head != buff.size()) return;
+
+        base += head;
+        head = 0;
+        if (buff.capacity() > MAX_IDLE_CAPACITY)
+        {
+            std::vector<char>().swap(buff);
+        }
+        else
+        {
+            buff.clear();
+        }
+    }
+
+    void PopFilledSlots()
+    {
+        while (HasOpenSlot() && slots[slots_head].filled)
+        {
+            slots_head++;
+            first_slot++;
+        }
+
+        if (!HasOpenSlot())
+        {
+            slots.clear();
+            slots_head = 0;
+        }
+        else if (slots_head >= 64 && slots_head * 2 >= slots.size())
+        {
+            // a pipeline that never fully drains
+            slots.erase(slots.begin(), slots.begin() + slots_head);
+            slots_head = 0;
+        }
+    }
+};
+
+#endif
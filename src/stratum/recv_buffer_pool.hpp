@@ -0,0 +1,108 @@
+#ifndef RECV_BUFFER_POOL_HPP_
+#define RECV_BUFFER_POOL_HPP_
+
+#include <simdjson/simdjson.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "constants.hpp"
+
+struct RecvBufferStats
+{
+    uint64_t in_use = 0;
+    uint64_t in_use_bytes = 0;
+    uint64_t cached = 0;
+};
+
+// size classed receive buffers, a connection only holds one while it has a
+// partial request pending. every class keeps simdjson padding past its usable
+// size. allocation and release are single threaded (owned by a reactor), the
+// occupancy counters may be read from any thread.
+class RecvBufferPool
+{
+   public:
+    static constexpr std::array<uint32_t, 3> SIZE_CLASSES = {
+        1024 * 2, 1024 * 8, ServerConstants::REQ_BUFF_SIZE};
+    static constexpr uint8_t CLASS_COUNT = SIZE_CLASSES.size();
+
+    static_assert(SIZE_CLASSES.back() == ServerConstants::REQ_BUFF_SIZE,
+                  "Largest class must match the max request buffer");
+
+    RecvBufferPool() = default;
+    RecvBufferPool(const RecvBufferPool&) = delete;
+    RecvBufferPool& operator=(const RecvBufferPool&) = delete;
+
+    ~RecvBufferPool()
+    {
+        for (auto& list : free_lists)
+        {
+            for (char* buf : list) delete[] buf;
+        }
+    }
+
+    // usable bytes, excluding the padding
+    static constexpr uint32_t Capacity(uint8_t size_class)
+    {
+        return SIZE_CLASSES[size_class] - simdjson::SIMDJSON_PADDING;
+    }
+
+    char* Acquire(uint8_t size_class)
+    {
+        char* buf;
+        auto& list = free_lists[size_class];
+
+        if (!list.empty())
+        {
+            buf = list.back();
+            list.pop_back();
+            cached.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            buf = new char[SIZE_CLASSES[size_class]];
+        }
+
+        in_use.fetch_add(1, std::memory_order_relaxed);
+        in_use_bytes.fetch_add(SIZE_CLASSES[size_class],
+                               std::memory_order_relaxed);
+        return buf;
+    }
+
+    void Release(char* buf, uint8_t size_class)
+    {
+        in_use.fetch_sub(1, std::memory_order_relaxed);
+        in_use_bytes.fetch_sub(SIZE_CLASSES[size_class],
+                               std::memory_order_relaxed);
+
+        // don't hold on to a burst forever
+        auto& list = free_lists[size_class];
+        if (list.size() >= ServerConstants::RECV_BUFF_CACHE_PER_CLASS)
+        {
+            delete[] buf;
+            return;
+        }
+
+        list.push_back(buf);
+        cached.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    RecvBufferStats GetStats() const
+    {
+        return RecvBufferStats{
+            .in_use = in_use.load(std::memory_order_relaxed),
+            .in_use_bytes = in_use_bytes.load(std::memory_order_relaxed),
+            .cached = cached.load(std::memory_order_relaxed)};
+    }
+
+   private:
+    std::array<std::vector<char*>, CLASS_COUNT> free_lists;
+
+    std::atomic<uint64_t> in_use{0};
+    std::atomic<uint64_t> in_use_bytes{0};
+    std::atomic<uint64_t> cached{0};
+};
+
+#endif
@@ -1,75 +1,224 @@
 #include "server.hpp"
 
+#include <algorithm>
+
 template class Server<StratumClient>;
 
 template <class T>
-Server<T>::Server(int port, int timeout_sec)
-    : timeout_sec(timeout_sec),
-      tspec({.it_interval = timespec{.tv_sec = timeout_sec, .tv_nsec = 0},
-             .it_value = timespec{.tv_sec = timeout_sec, .tv_nsec = 0}})
+Server<T>::Server(const std::vector<ListenPort> &ports, int timeout_sec,
+                  uint32_t reactor_count, uint64_t output_high_water,
+                  IoEngine io_engine, const TlsFiles &tls_files)
+    : ports(ports),
+      timeout_ms(static_cast<uint64_t>(timeout_sec) * 1000),
+      output_high_water(output_high_water),
+      io_engine(io_engine)
 {
-    epoll_fd = epoll_create1(0);
-    timers_epoll_fd = epoll_create1(0);
+    if (reactor_count == 0)
+    {
+        throw std::invalid_argument("Reactor count must be at least 1.");
+    }
 
-    if (epoll_fd == -1)
+    if (ports.empty() || ports.size() > UINT8_MAX)
     {
-        throw std::invalid_argument(fmt::format(
-            "Failed to create epoll: {} -> {}.", errno, std::strerror(errno)));
+        throw std::invalid_argument("Invalid amount of ports to listen on.");
     }
 
-    InitListeningSock(port);
+#ifndef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
+    {
+        throw std::invalid_argument(
+            "io_uring engine requested but not compiled in (WITH_IO_URING).");
+    }
+#endif
 
-    if (listen(listening_fd, MAX_CONNECTIONS_QUEUE) == -1)
+    if (std::any_of(ports.begin(), ports.end(),
+                    [](const ListenPort &p) { return p.port != 0 && p.tls; }))
+    {
+#ifdef WITH_KTLS
+        // the handshake waits for readiness, which the uring engine's
+        // multishot recv doesn't give
+        if (io_engine != IoEngine::EPOLL)
+        {
+            throw std::invalid_argument(
+                "tls listeners are only supported by the epoll engine.");
+        }
+        tls_acceptor = std::make_unique<TlsAcceptor>(tls_files);
+#else
         throw std::invalid_argument(
-            "Stratum server failed to enter listenning state.");
+            "tls listener requested but not compiled in (WITH_KTLS).");
+#endif
+    }
 
-    logger.Log<LogType::Info>("Created listening socket on port: {}", port);
+    reactors.reserve(reactor_count);
+    for (uint32_t i = 0; i < reactor_count; i++)
+    {
+        auto &reactor = reactors.emplace_back(std::make_unique<Reactor<T>>(i));
+        InitReactor(reactor.get());
+    }
+
+    std::string port_list;
+    for (const ListenPort &p : ports)
+    {
+        if (p.port == 0) continue;
+        fmt::format_to(std::back_inserter(port_list), "{}{}{}",
+                       port_list.empty() ? "" : ", ", p.port,
+                       p.tls ? " (tls)" : "");
+    }
+
+    logger.Log<LogType::Info>(
+        "Created {} {} reactor(s) listening on port(s): {}", reactor_count,
+        io_engine == IoEngine::IO_URING ? "io_uring" : "epoll", port_list);
 }
 
 template <class T>
 Server<T>::~Server()
 {
-    for (auto &it : connections)
+    for (auto &reactor : reactors)
     {
-        close(it->sockfd);
+        reactor->connections.ForEach(
+            [this, &reactor](Connection<T> *conn)
+            {
+#ifdef WITH_KTLS
+                ReleaseTls(conn);
+#endif
+                close(conn->sockfd);
+                ReleaseRecvBuffer(reactor.get(), conn);
+            });
+        for (int listening_fd : reactor->listening_fds)
+        {
+            if (listening_fd != -1) close(listening_fd);
+        }
+        close(reactor->wake_fd);
+#ifdef WITH_IO_URING
+        if (io_engine == IoEngine::IO_URING)
+        {
+            DestroyUring(reactor.get());
+            continue;
+        }
+#endif
+        close(reactor->epoll_fd);
     }
-    close(listening_fd);
-    close(epoll_fd);
 
     logger.Log<LogType::Info>("Server destroyed. Connections closed.");
 }
 
 template <class T>
-void Server<T>::Service()
+void Server<T>::InitReactor(Reactor<T> *reactor)
+{
+    // io_uring would fail a read of a non blocking eventfd with EAGAIN
+    // instead of waiting for it
+    reactor->wake_fd = eventfd(
+        0, EFD_CLOEXEC | (io_engine == IoEngine::EPOLL ? EFD_NONBLOCK : 0));
+
+    if (reactor->wake_fd == -1)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Failed to create eventfd: {} -> {}.", errno, std::strerror(errno)));
+    }
+
+#ifdef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
+    {
+        InitUring(reactor);
+    }
+    else
+#endif
+    {
+        reactor->epoll_fd = epoll_create1(0);
+
+        if (reactor->epoll_fd == -1)
+        {
+            throw std::invalid_argument(
+                fmt::format("Failed to create epoll: {} -> {}.", errno,
+                            std::strerror(errno)));
+        }
+
+        struct epoll_event wake_ev;
+        memset(&wake_ev, 0, sizeof(wake_ev));
+        wake_ev.events = EPOLLIN | EPOLLET;
+        wake_ev.data.u64 = WAKE_EVENT;
+
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->wake_fd,
+                      &wake_ev) == -1)
+        {
+            throw std::invalid_argument(
+                fmt::format("Failed to add eventfd to epoll set: {} -> {}",
+                            errno, std::strerror(errno)));
+        }
+    }
+
+    // after the epoll set / ring exists, the listeners are added to it
+    for (const ListenPort &p : ports)
+    {
+        InitListeningSock(reactor, p.port);
+    }
+}
+
+template <class T>
+void Server<T>::Service(Reactor<T> *reactor)
+{
+#ifdef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
+    {
+        ServiceUring(reactor);
+        return;
+    }
+#endif
+    ServiceEpoll(reactor);
+}
+
+template <class T>
+void Server<T>::ServiceEpoll(Reactor<T> *reactor)
 {
     struct epoll_event events[MAX_CONNECTION_EVENTS];
+
+    // wake up in time for the next timer tick
+    const int wait_ms =
+        std::min(static_cast<int>(EPOLL_TIMEOUT),
+                 reactor->timers.MsUntilNextTick(reactor->timers.GetNowMs()));
     int epoll_res =
-        epoll_wait(epoll_fd, events, MAX_CONNECTION_EVENTS,
-                   EPOLL_TIMEOUT);
+        epoll_wait(reactor->epoll_fd, events, MAX_CONNECTION_EVENTS, wait_ms);
 
     for (int i = 0; i < epoll_res; i++)
     {
         auto event = events[i];
         uint32_t flags = event.events;
 
-        if (event.data.fd != listening_fd)
+        if (event.data.u64 == WAKE_EVENT)
+        {
+            uint64_t count;
+            // reset the counter
+            [[maybe_unused]] auto res =
+                read(reactor->wake_fd, &count, sizeof(count));
+            HandleWake(reactor);
+        }
+        else if (event.data.u64 - LISTENER_EVENT <
+                 reactor->listening_fds.size())
+        {
+            HandleNewConnection(
+                reactor, static_cast<uint8_t>(event.data.u64 - LISTENER_EVENT));
+        }
+        else
         {
-            auto *conn_it = reinterpret_cast<connection_it *>(event.data.ptr);
+            Connection<T> *conn = reactor->connections.Get(event.data.u64);
+
+            if (conn == nullptr)
+            {
+                // stale event, the slot has been freed or reused
+                continue;
+            }
 
-            if (!HandleEvent(conn_it, flags))
+            if (!HandleEvent(reactor, conn, flags))
             {
-                EraseClient(conn_it);
+                EraseClient(reactor, conn);
             }
             else
             {
-                (*(*conn_it))->expiration_count = 0;
-                timerfd_settime((*(*conn_it))->timerfd, 0, &tspec, nullptr);
+                // O(1) relink, no syscall
+                conn->expiration_count = 0;
+                reactor->timers.Schedule(&conn->timer, timeout_ms);
             }
         }
-        else
-        {
-            HandleNewConnection();
-        }
     }
 
     if (epoll_res == -1)
@@ -88,33 +237,49 @@ void Server<T>::Service()
         }
     }
 
-    // immediate check
-    epoll_res = epoll_wait(timers_epoll_fd, events,
-                           MAX_CONNECTION_EVENTS, 0);
-    for (int i = 0; i < epoll_res; i++)
+    reactor->timers.Advance(reactor->timers.GetNowMs(),
+                            [this, reactor](TimerNode *node) {
+                                HandleExpired(reactor,
+                                              static_cast<Connection<T> *>(
+                                                  node->data));
+                            });
+}
+
+template <class T>
+void Server<T>::HandleWake(Reactor<T> *reactor)
+{
+    std::vector<std::function<void()>> tasks;
     {
-        auto event = events[i];
-        auto *conn_it = reinterpret_cast<connection_it *>(event.data.ptr);
+        std::scoped_lock lock(reactor->tasks_mutex);
+        tasks.swap(reactor->tasks);
+    }
 
-        uint64_t expiration_count = 0;
-        auto conn_ptr = (*(*conn_it));
+    for (auto &task : tasks)
+    {
+        task();
+    }
+}
 
-        if (read(conn_ptr->timerfd, &expiration_count,
-                 sizeof(expiration_count)) == -1 ||
-            !HandleTimeout(conn_it,
-                           conn_ptr->expiration_count + expiration_count) ||
-            !RearmFd(conn_it, conn_ptr->timerfd, timers_epoll_fd))
-        {
-            EraseClient(conn_it);
-        }
-        conn_ptr->expiration_count += expiration_count;
+template <class T>
+void Server<T>::HandleExpired(Reactor<T> *reactor, Connection<T> *conn)
+{
+    conn->expiration_count++;
+
+    if (!HandleTimeout(conn, conn->expiration_count))
+    {
+        EraseClient(reactor, conn);
+        return;
     }
+
+    // periodic until the connection is active again
+    reactor->timers.Schedule(&conn->timer, timeout_ms);
 }
 
 template <class T>
-bool Server<T>::HandleEvent(connection_it *conn_it, uint32_t flags)
+bool Server<T>::HandleEvent(Reactor<T> *reactor, Connection<T> *conn,
+                            uint32_t flags)
 {
-    int sockfd = (*conn_it)->get()->sockfd;
+    int sockfd = conn->sockfd;
 
     if (flags & EPOLLERR)
     {
@@ -133,27 +298,51 @@ bool Server<T>::HandleEvent(connection_it *conn_it, uint32_t flags)
         return false;
     }
 
-    return HandleReadable(conn_it);
+#ifdef WITH_KTLS
+    if (conn->tls != nullptr)
+    {
+        return HandleHandshake(reactor, conn);
+    }
+#endif
+
+    if (flags & EPOLLOUT)
+    {
+        // the kernel buffer has room again, send what was queued
+        if (!HandleSendResult(conn, conn->output.Flush(sockfd)))
+        {
+            return false;
+        }
+    }
+
+    if (!(flags & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)))
+    {
+        return true;
+    }
+
+    return HandleReadable(reactor, conn);
 }
 
 template <class T>
-bool Server<T>::HandleReadable(connection_it *it)
+bool Server<T>::HandleReadable(Reactor<T> *reactor, Connection<T> *conn)
 {
-    std::shared_ptr<Connection<T>> conn = *(*it);
     const int sockfd = conn->sockfd;
     std::string ip(conn->ip);
     ssize_t recv_res = 0;
 
+    // edge triggered, read until the socket is drained
     while (true)
     {
-        recv_res =
-            recv(sockfd, conn->req_buff + conn->req_pos,
-                 REQ_BUFF_SIZE_REAL - conn->req_pos - 1, 0);
+        if (!ReserveRecvSpace(reactor, conn))
+        {
+            return false;
+        }
+
+        recv_res = recv(sockfd, conn->req_buff + conn->req_pos,
+                        conn->req_cap - conn->req_pos, 0);
 
         if (recv_res == -1)
         {
-            if ((/* errno == EWOULDBLOCK || */ errno != EAGAIN) ||
-                !RearmFd(it, conn->sockfd, epoll_fd))
+            if (errno != EAGAIN /* && errno != EWOULDBLOCK */)
             {
                 logger.Log<LogType::Warn>(
                     "Client with ip {} disconnected because of socket (fd:"
@@ -161,20 +350,24 @@ bool Server<T>::HandleReadable(connection_it *it)
                     ip, sockfd, errno, std::strerror(errno));
                 return false;
             }
-            // EAGAIN allowed
+            // EAGAIN allowed, drained so don't hold a buffer while idle
+            if (conn->req_pos == 0)
+            {
+                ReleaseRecvBuffer(reactor, conn);
+            }
             return true;
         }
 
         conn->req_pos += recv_res;
-        conn->req_buff[conn->req_pos] = '\0';  // for strchr
 
-        HandleConsumeable(it);
+        if (!HandleReceived(conn))
+        {
+            return false;
+        }
 
         // only erase the client after we had consumed all he had pending
         if (recv_res == 0)
         {
-            // should happened on flooded buffer
-
             logger.Log<LogType::Info>(
                 "Client with ip {} (sockfd {}) disconnected.", ip, sockfd);
             return false;
@@ -182,99 +375,344 @@ bool Server<T>::HandleReadable(connection_it *it)
     }
 }
 
+#ifdef WITH_KTLS
 template <class T>
-void Server<T>::HandleNewConnection()
+bool Server<T>::HandleHandshake(Reactor<T> *reactor, Connection<T> *conn)
 {
-    struct sockaddr_in conn_addr;
-    socklen_t addr_len = sizeof(conn_addr);
+    // readable and writable both move it along, it's not known which one it
+    // waits for
+    switch (tls_acceptor->Continue(conn->tls, conn->ip))
+    {
+        case TlsAcceptor::HandshakeStatus::PENDING:
+            return true;
+        case TlsAcceptor::HandshakeStatus::FAILED:
+            return false;
+        case TlsAcceptor::HandshakeStatus::DONE:
+            break;
+    }
 
-    int conn_fd = AcceptConnection(&conn_addr, &addr_len);
+    ReleaseTls(conn);
+    logger.Log<LogType::Info>("Tls client with ip {} (sockfd {}) is on ktls.",
+                              conn->ip, conn->sockfd);
 
-    if (conn_fd < 0)
+    // the kernel encrypts from here on, send what was held meanwhile
+    if (!HandleSendResult(conn, conn->output.Uncork(conn->sockfd)))
     {
-        logger.Log<LogType::Warn>(
-            "Failed to accept socket to errno: {} "
-            "-> errno: {}. ",
-            conn_fd, errno);
-        return;
+        return false;
     }
 
-    connection_it *conn_it = nullptr;
-    int timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    // the first request may have come along with the handshake's last
+    // flight, its edge is already consumed
+    return HandleReadable(reactor, conn);
+}
 
-    {
-        std::unique_lock lock(connections_mutex);
-        connections.emplace_back(std::make_shared<Connection<T>>(
-            conn_fd, conn_addr.sin_addr, timerfd));
-        connections.back()->it = --connections.end();
+template <class T>
+void Server<T>::ReleaseTls(Connection<T> *conn) const
+{
+    if (conn->tls == nullptr) return;
 
-        conn_it = &connections.back()->it;
-    }
-    std::string ip((*(*conn_it))->ip);
+    tls_acceptor->Release(conn->tls);
+    conn->tls = nullptr;
+}
+#endif
+
+template <class T>
+bool Server<T>::HandleReceived(Connection<T> *conn)
+{
+    // replies to every request in this read go out in one write
+    conn->output.Cork();
+    HandleConsumeable(conn);
+    return HandleSendResult(conn, conn->output.Uncork(conn->sockfd));
+}
 
-    // since this is a union only one member can be assigned, data will be
-    // assigned in rearm
-    struct epoll_event empty_conn_ev
+// for engines that read into their own buffers
+template <class T>
+bool Server<T>::AppendReceived(Reactor<T> *reactor, Connection<T> *conn,
+                               const char *data, size_t len)
+{
+    while (len > 0)
     {
-        .events = 0, .data = {
-            .ptr = nullptr,
+        if (!ReserveRecvSpace(reactor, conn))
+        {
+            return false;
+        }
+
+        const size_t copied = std::min(len, conn->req_cap - conn->req_pos);
+        std::memcpy(conn->req_buff + conn->req_pos, data, copied);
+        conn->req_pos += copied;
+        data += copied;
+        len -= copied;
+
+        if (!HandleReceived(conn))
+        {
+            return false;
         }
-    };
+    }
 
-    // only add to the interest list after all the connection data has been
-    // created to avoid data races
-    if (!HandleConnected(conn_it))
+    if (conn->req_pos == 0)
     {
-        EraseClient(conn_it);
-        return;
+        ReleaseRecvBuffer(reactor, conn);
     }
+    return true;
+}
 
-    /* relative timer*/
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn_fd, &empty_conn_ev) == -1 ||
-        timerfd_settime(timerfd, 0, &tspec, nullptr) == -1 ||
-        epoll_ctl(timers_epoll_fd, EPOLL_CTL_ADD, timerfd, &empty_conn_ev) ==
-            -1 ||
-        !RearmFd(conn_it, conn_fd, epoll_fd) ||
-        !RearmFd(conn_it, timerfd, timers_epoll_fd))
+template <class T>
+void Server<T>::Send(Connection<T> *conn, std::string_view msg) const
+{
+    if (!HandleSendResult(conn, conn->output.Write(conn->sockfd, msg)))
     {
-        EraseClient(conn_it);
+        // let the owning reactor notice the hangup and erase the client
+        shutdown(conn->sockfd, SHUT_RDWR);
+    }
+}
 
-        logger.Log<LogType::Warn>(
-            "Failed to add socket / socket timer of client with ip {} to "
-            "epoll list errno: {} "
-            "-> errno: {}. ",
-            ip, conn_fd, errno);
-        return;
+template <class T>
+void Server<T>::Send(Connection<T> *conn, ReplySlot slot,
+                     std::string_view msg) const
+{
+    if (!HandleSendResult(conn, conn->output.Fill(conn->sockfd, slot, msg)))
+    {
+        shutdown(conn->sockfd, SHUT_RDWR);
     }
+}
 
-    logger.Log<LogType::Info>("Tcp client connected, ip: {}, sockfd {}", ip,
-                              conn_fd);
+template <class T>
+void Server<T>::Uncork(Connection<T> *conn) const
+{
+    if (!HandleSendResult(conn, conn->output.Uncork(conn->sockfd)))
+    {
+        shutdown(conn->sockfd, SHUT_RDWR);
+    }
 }
 
-// ptr should point to struct that has Connection as its first member
 template <class T>
-bool Server<T>::RearmFd(connection_it *it, int fd, int efd) const
+bool Server<T>::HandleSendResult(Connection<T> *conn, int64_t pending) const
 {
-    Connection<T> *conn = (*it)->get();
+    if (pending == SEND_ERROR)
+    {
+        logger.Log<LogType::Warn>(
+            "Failed to send to client with ip {} (sockfd {}), errno: {} -> "
+            "{}",
+            conn->ip, conn->sockfd, errno, std::strerror(errno));
+        return false;
+    }
 
-    // rearm socket in epoll interest list ~1us
-    if (epoll_event conn_ev{.events = EPOLLIN | EPOLLET | EPOLLONESHOT,
-                            .data = {.ptr = it}};
-        epoll_ctl(efd, EPOLL_CTL_MOD, fd, &conn_ev) == -1)
+    if (static_cast<uint64_t>(pending) > output_high_water)
     {
-        logger.Log<LogType::Warn>("Failed to rearm (fd: {}) to epoll (fd: {})",
-                                  fd, efd);
+        logger.Log<LogType::Warn>(
+            "Disconnecting slow client with ip {} (sockfd {}), {} bytes "
+            "pending.",
+            conn->ip, conn->sockfd, pending);
+        conn->output.Shutdown();
         return false;
     }
 
+#ifdef WITH_IO_URING
+    // the ring sends whatever the output has ready
+    if (io_engine == IoEngine::IO_URING)
+    {
+        QueueUringSend(reactors[conn->reactor_id].get(), conn);
+    }
+#endif
     return true;
 }
 
+// makes sure there is room past req_pos
+template <class T>
+bool Server<T>::ReserveRecvSpace(Reactor<T> *reactor, Connection<T> *conn)
+{
+    if (conn->req_buff == nullptr)
+    {
+        ResizeRecvBuffer(reactor, conn, 0);
+        return true;
+    }
+
+    if (conn->req_pos < conn->req_cap)
+    {
+        return true;
+    }
+
+    if (conn->req_start > 0)
+    {
+        // only compact when full, the consumed prefix is usually tiny
+        const size_t pending = conn->req_pos - conn->req_start;
+        std::memmove(conn->req_buff, conn->req_buff + conn->req_start,
+                     pending);
+        conn->req_scan -= conn->req_start;
+        conn->req_pos = pending;
+        conn->req_start = 0;
+        return true;
+    }
+
+    if (conn->req_class + 1 < RecvBufferPool::CLASS_COUNT)
+    {
+        // a partial request filled the buffer, move up a class
+        ResizeRecvBuffer(reactor, conn, conn->req_class + 1);
+        return true;
+    }
+
+    logger.Log<LogType::Warn>("Client with ip {} (sockfd {}) flooded its buffer.",
+                              conn->ip, conn->sockfd);
+    return false;
+}
+
+template <class T>
+void Server<T>::ResizeRecvBuffer(Reactor<T> *reactor, Connection<T> *conn,
+                                 uint8_t size_class)
+{
+    char *buff = reactor->recv_buffers.Acquire(size_class);
+
+    if (conn->req_buff != nullptr)
+    {
+        std::memcpy(buff, conn->req_buff, conn->req_pos);
+        reactor->recv_buffers.Release(conn->req_buff, conn->req_class);
+    }
+
+    conn->req_buff = buff;
+    conn->req_class = size_class;
+    conn->req_cap = RecvBufferPool::Capacity(size_class);
+}
+
+template <class T>
+void Server<T>::ReleaseRecvBuffer(Reactor<T> *reactor, Connection<T> *conn)
+{
+    if (conn->req_buff == nullptr) return;
+
+    reactor->recv_buffers.Release(conn->req_buff, conn->req_class);
+    conn->req_buff = nullptr;
+    conn->req_cap = 0;
+    conn->req_pos = 0;
+    conn->req_start = 0;
+    conn->req_scan = 0;
+}
+
+template <class T>
+void Server<T>::HandleNewConnection(Reactor<T> *reactor, uint8_t listener)
+{
+    // edge triggered listener, accept everything pending
+    while (true)
+    {
+        struct sockaddr_in conn_addr;
+        socklen_t addr_len = sizeof(conn_addr);
+
+        int conn_fd =
+            AcceptConnection(reactor, listener, &conn_addr, &addr_len);
+
+        if (conn_fd < 0)
+        {
+            if (conn_fd == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                return;
+            }
+
+            logger.Log<LogType::Warn>(
+                "Failed to accept socket to errno: {} "
+                "-> errno: {}. ",
+                conn_fd, errno);
+            return;
+        }
+
+        AddConnection(reactor, conn_fd, conn_addr.sin_addr, listener);
+    }
+}
+
+template <class T>
+void Server<T>::AddConnection(Reactor<T> *reactor, int conn_fd,
+                              const in_addr &addr, uint8_t listener)
+{
+    Connection<T> *conn =
+        reactor->connections.Allocate(conn_fd, addr, reactor->id, listener);
+
+    if (conn == nullptr)
+    {
+        logger.Log<LogType::Warn>(
+            "Rejecting connection, reactor {} is full ({} connections).",
+            reactor->id, MAX_CONNECTIONS_PER_REACTOR);
+        close(conn_fd);
+        return;
+    }
+
+    conn->timer.data = conn;
+    std::string ip(conn->ip);
+
+#ifdef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
+    {
+        // sent through the ring, see QueueUringSend
+        conn->output.SetExternalSend();
+    }
+#endif
+
+#ifdef WITH_KTLS
+    const bool tls = ports[listener].tls;
+    if (tls)
+    {
+        // nothing may go out in the clear, not even a job pushed to it
+        // before the handshake is done
+        conn->output.Cork();
+    }
+#endif
+
+    // only add to the interest list after all the connection data has
+    // been created to avoid data races
+    if (!HandleConnected(conn))
+    {
+        EraseClient(reactor, conn);
+        return;
+    }
+
+#ifdef WITH_KTLS
+    if (tls && (conn->tls = tls_acceptor->Start(conn_fd, ip)) == nullptr)
+    {
+        EraseClient(reactor, conn);
+        return;
+    }
+#endif
+
+#ifdef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
+    {
+        ArmRecv(reactor, conn);
+    }
+    else
+#endif
+    {
+        // the connection never leaves this reactor, so it doesn't need to be
+        // re-armed (no EPOLLONESHOT), the generation tagged handle lets us
+        // drop events that outlived the connection. EPOLLOUT is edge
+        // triggered too, so it only fires when a full send buffer drains
+        epoll_event conn_ev{
+            .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+            .data = {.u64 = conn->handle}};
+
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, conn_fd, &conn_ev) ==
+            -1)
+        {
+            EraseClient(reactor, conn);
+
+            logger.Log<LogType::Warn>(
+                "Failed to add socket of client with ip {} to "
+                "epoll list errno: {} "
+                "-> errno: {}. ",
+                ip, conn_fd, errno);
+            return;
+        }
+    }
+
+    reactor->timers.Schedule(&conn->timer, timeout_ms);
+
+    logger.Log<LogType::Info>(
+        "Tcp client connected, ip: {}, sockfd {}, reactor {}", ip, conn_fd,
+        reactor->id);
+}
+
 template <class T>
-int Server<T>::AcceptConnection(sockaddr_in *addr, socklen_t *addr_size) const
+int Server<T>::AcceptConnection(const Reactor<T> *reactor, uint8_t listener,
+                                sockaddr_in *addr, socklen_t *addr_size) const
 {
     int flags = SOCK_NONBLOCK;
-    int conn_fd = accept4(listening_fd, (sockaddr *)addr, addr_size, flags);
+    int conn_fd = accept4(reactor->listening_fds[listener], (sockaddr *)addr,
+                          addr_size, flags);
 
     if (conn_fd == -1)
     {
@@ -284,6 +722,7 @@ int Server<T>::AcceptConnection(sockaddr_in *addr, socklen_t *addr_size) const
     if (int yes = 1;
         setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) == -1)
     {
+        close(conn_fd);
         return -2;
     }
 
@@ -291,20 +730,31 @@ int Server<T>::AcceptConnection(sockaddr_in *addr, socklen_t *addr_size) const
 }
 
 template <class T>
-void Server<T>::EraseClient(connection_it *it)
+void Server<T>::EraseClient(Reactor<T> *reactor, Connection<T> *conn)
 {
-    const int sockfd = (*(*it))->sockfd;
-    const int timerfd = (*(*it))->timerfd;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sockfd, nullptr) == -1 ||
-        epoll_ctl(timers_epoll_fd, EPOLL_CTL_DEL, timerfd, nullptr) == -1)
+    const int sockfd = conn->sockfd;
+
+    reactor->timers.Cancel(&conn->timer);
+
+#ifdef WITH_KTLS
+    ReleaseTls(conn);
+#endif
+
+#ifdef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
     {
-        logger.Log<LogType::Warn>(
-            "Failed to remove socket {} from epoll list errno: {} "
-            "-> errno: {}. ",
-            sockfd, errno, std::strerror(errno));
+        // in flight requests keep the socket alive past close
+        CancelUringConnection(reactor, conn->handle);
+        if (conn->output.IsSending())
+        {
+            reactor->orphaned_sends.emplace(conn->handle,
+                                            conn->output.ReleaseInFlight());
+        }
     }
+#endif
 
-    if (close(sockfd) == -1 || close(timerfd) == -1)
+    // closing the fd removes it from the epoll interest list
+    if (close(sockfd) == -1)
     {
         logger.Log<LogType::Warn>(
             "Failed to close socket {} errno: {} "
@@ -312,24 +762,39 @@ void Server<T>::EraseClient(connection_it *it)
             sockfd, errno, std::strerror(errno));
     }
 
-    HandleDisconnected(it);
+    HandleDisconnected(conn);
+    ReleaseRecvBuffer(reactor, conn);
 
     // O(1)
-    std::unique_lock lock(connections_mutex);
-    connections.erase(*it);
+    reactor->connections.Free(conn);
 }
 
 template <class T>
-void Server<T>::InitListeningSock(int port)
+void Server<T>::InitListeningSock(Reactor<T> *reactor, int port)
 {
+    if (port == 0)
+    {
+        reactor->listening_fds.push_back(-1);
+        return;
+    }
+
     int optval = 1;
 
-    listening_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    const int listening_fd =
+        socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, IPPROTO_TCP);
 
     if (listening_fd == -1)
         throw std::invalid_argument("Failed to create stratum socket");
 
+    const auto listener =
+        static_cast<uint8_t>(reactor->listening_fds.size());
+    reactor->listening_fds.push_back(listening_fd);
+
+    // every reactor binds its own socket to the same port, the kernel spreads
+    // the incoming connections between them
     if (setsockopt(listening_fd, SOL_SOCKET, SO_REUSEADDR, &optval,
+                   sizeof(optval)) == -1 ||
+        setsockopt(listening_fd, SOL_SOCKET, SO_REUSEPORT, &optval,
                    sizeof(optval)) == -1)
         throw std::invalid_argument("Failed to set stratum socket options");
 
@@ -344,15 +809,28 @@ void Server<T>::InitListeningSock(int port)
             fmt::format("Stratum server failed to bind to port: {}", port));
     }
 
+    if (listen(listening_fd, MAX_CONNECTIONS_QUEUE) == -1)
+        throw std::invalid_argument(
+            "Stratum server failed to enter listenning state.");
+
+#ifdef WITH_IO_URING
+    if (io_engine == IoEngine::IO_URING)
+    {
+        ArmAccept(reactor, listener);
+        return;
+    }
+#endif
+
     struct epoll_event listener_ev;
     memset(&listener_ev, 0, sizeof(listener_ev));
     listener_ev.events = EPOLLIN | EPOLLET;
-    listener_ev.data.fd = listening_fd;
+    listener_ev.data.u64 = LISTENER_EVENT + listener;
 
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listening_fd, &listener_ev) == -1)
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, listening_fd,
+                  &listener_ev) == -1)
     {
         throw std::invalid_argument(
             fmt::format("Failed to add listener socket to epoll set: {} -> {}",
                         errno, std::strerror(errno)));
     }
-}
\ No newline at end of file
+}
@@ -2,19 +2,29 @@
 #define SERVER_HPP_
 
 #include <fcntl.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
-#include <sys/timerfd.h>
 #include <unistd.h>
 
-#include <list>
+#ifdef WITH_IO_URING
+#include <liburing.h>
+#endif
+
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "connection.hpp"
+#include "connection_slab.hpp"
 #include "logger.hpp"
+#include "recv_buffer_pool.hpp"
 #include "stratum_client.hpp"
+#include "tls_acceptor.hpp"
 
 // enum ConnectionEventType
 // {
@@ -33,41 +43,192 @@
 // };
 inline constexpr std::string_view field_str = "Server";
 
+enum class IoEngine
+{
+    EPOLL,
+    IO_URING
+};
+
+struct ListenPort
+{
+    // 0 = not listened on, the index stays taken so the following
+    // listeners keep theirs
+    int port;
+    // tls handshake (TlsAcceptor) before anything is read or sent
+    bool tls = false;
+};
+
+// every reactor owns its listening sockets (SO_REUSEPORT), epoll sets and
+// connections, a connection is only ever touched by the thread that accepted
+// it. other threads hand work to a reactor with Server::Post
+template <typename T>
+struct Reactor
+{
+    explicit Reactor(uint32_t id)
+        : id(id), connections(ServerConstants::MAX_CONNECTIONS_PER_REACTOR)
+    {
+    }
+
+    const uint32_t id;
+    // one per port, in the order of the server's ports
+    std::vector<int> listening_fds;
+    int epoll_fd = -1;
+    // wakes the reactor up when a task is posted
+    int wake_fd = -1;
+#ifdef WITH_IO_URING
+    io_uring ring;
+    // provided buffers for multishot recv, copied into the connection's
+    // pooled buffer and handed straight back
+    io_uring_buf_ring* buf_ring = nullptr;
+    char* buf_base = nullptr;
+    uint64_t wake_buf = 0;
+    // ops that found the submission queue full, queued again by the next
+    // iteration once its completions are reaped
+    std::vector<uint64_t> uring_deferred;
+    // the output of connections freed with a send in flight, until it
+    // completes
+    std::unordered_map<ConnectionHandle, std::vector<char>> orphaned_sends;
+#endif
+    TimingWheel<ServerConstants::TIMER_WHEEL_SLOTS> timers{
+        ServerConstants::TIMER_TICK_MS};
+    RecvBufferPool recv_buffers;
+
+    ConnectionSlab<T> connections;
+
+    std::mutex tasks_mutex;
+    std::vector<std::function<void()>> tasks;
+};
+
 template <typename T>
 class Server : public ServerConstants
 {
    public:
-    using connection_it = std::list<std::shared_ptr<Connection<T>>>::iterator;
-
-    explicit Server(int port, int timeout_sec);
+    // a connection remembers the index of the port it came in on
+    // (Connection::listener), so a server can speak a protocol per port.
+    // tls_files are only read if a port is tls
+    explicit Server(const std::vector<ListenPort>& ports, int timeout_sec,
+                    uint32_t reactor_count,
+                    uint64_t output_high_water,
+                    IoEngine io_engine = IoEngine::EPOLL,
+                    const TlsFiles& tls_files = {});
     ~Server();
-    void Service();
+    void Service(Reactor<T>* reactor);
 
-    virtual void HandleConsumeable(connection_it* conn) = 0;
+    virtual void HandleConsumeable(Connection<T>* conn) = 0;
     // returns whether to reject the connection;
-    virtual bool HandleConnected(connection_it* conn) = 0;
-    virtual bool HandleTimeout(connection_it* conn, uint64_t timeout_streak) = 0;
-    virtual void HandleDisconnected(connection_it* conn) = 0;
+    virtual bool HandleConnected(Connection<T>* conn) = 0;
+    virtual bool HandleTimeout(Connection<T>* conn, uint64_t timeout_streak) = 0;
+    virtual void HandleDisconnected(Connection<T>* conn) = 0;
 
    private:
-    const itimerspec tspec;
-
     const Logger logger{field_str};
-    std::mutex connections_mutex;
-    std::list<std::shared_ptr<Connection<T>>> connections;
-
-    const int timeout_sec;
-    int listening_fd;
-    int epoll_fd;
-    int timers_epoll_fd;
-
-    void InitListeningSock(int port);
-    bool HandleEvent(connection_it* it, uint32_t flags);
-    bool HandleReadable(connection_it* it);
-
-    bool RearmFd(connection_it* it, int fd, int efd) const;
-    int AcceptConnection(sockaddr_in* addr, socklen_t* addr_size) const;
-    void EraseClient(connection_it* it);
-    void HandleNewConnection();
+
+    // epoll data that isn't a connection handle (handles always have a
+    // generation of at least 1), listener i is LISTENER_EVENT + i
+    static constexpr uint64_t WAKE_EVENT = 0;
+    static constexpr uint64_t LISTENER_EVENT = 1;
+
+    const std::vector<ListenPort> ports;
+    const uint64_t timeout_ms;
+    // pending output bytes a connection may have before it's disconnected
+    const uint64_t output_high_water;
+    const IoEngine io_engine;
+#ifdef WITH_KTLS
+    // set if a port is tls
+    std::unique_ptr<TlsAcceptor> tls_acceptor;
+#endif
+
+    void InitReactor(Reactor<T>* reactor);
+    void InitListeningSock(Reactor<T>* reactor, int port);
+    void ServiceEpoll(Reactor<T>* reactor);
+    void HandleWake(Reactor<T>* reactor);
+    bool HandleEvent(Reactor<T>* reactor, Connection<T>* conn,
+                     uint32_t flags);
+    bool HandleReadable(Reactor<T>* reactor, Connection<T>* conn);
+#ifdef WITH_KTLS
+    bool HandleHandshake(Reactor<T>* reactor, Connection<T>* conn);
+    void ReleaseTls(Connection<T>* conn) const;
+#endif
+    bool HandleReceived(Connection<T>* conn);
+    bool AppendReceived(Reactor<T>* reactor, Connection<T>* conn,
+                        const char* data, size_t len);
+    bool HandleSendResult(Connection<T>* conn, int64_t pending) const;
+    bool ReserveRecvSpace(Reactor<T>* reactor, Connection<T>* conn);
+    void ResizeRecvBuffer(Reactor<T>* reactor, Connection<T>* conn,
+                          uint8_t size_class);
+    void ReleaseRecvBuffer(Reactor<T>* reactor, Connection<T>* conn);
+    void HandleExpired(Reactor<T>* reactor, Connection<T>* conn);
+
+    int AcceptConnection(const Reactor<T>* reactor, uint8_t listener,
+                         sockaddr_in* addr, socklen_t* addr_size) const;
+    void EraseClient(Reactor<T>* reactor, Connection<T>* conn);
+    void HandleNewConnection(Reactor<T>* reactor, uint8_t listener);
+    void AddConnection(Reactor<T>* reactor, int conn_fd, const in_addr& addr,
+                       uint8_t listener);
+
+#ifdef WITH_IO_URING
+    // server_uring.cpp
+    void InitUring(Reactor<T>* reactor);
+    void DestroyUring(Reactor<T>* reactor);
+    void ServiceUring(Reactor<T>* reactor);
+    void HandleCompletion(Reactor<T>* reactor, io_uring_cqe* cqe);
+    void HandleUringAccept(Reactor<T>* reactor, io_uring_cqe* cqe,
+                           uint8_t listener);
+    bool HandleUringRecv(Reactor<T>* reactor, Connection<T>* conn,
+                         io_uring_cqe* cqe);
+    // null if the queue stays full, the op (its user data) is then deferred
+    io_uring_sqe* GetSqe(Reactor<T>* reactor, uint64_t data) const;
+    void RetryDeferredUring(Reactor<T>* reactor);
+    void ArmAccept(Reactor<T>* reactor, uint8_t listener);
+    void ArmRecv(Reactor<T>* reactor, Connection<T>* conn);
+    // what the connection's output has ready, if no send is in flight
+    void QueueUringSend(Reactor<T>* reactor, Connection<T>* conn) const;
+    void ArmWake(Reactor<T>* reactor);
+    // by handle, it may run after the connection is freed
+    void CancelUringConnection(Reactor<T>* reactor, ConnectionHandle handle);
+    void RecycleUringBuffer(Reactor<T>* reactor, uint16_t bid);
+#endif
+
+   protected:
+    std::vector<std::unique_ptr<Reactor<T>>> reactors;
+
+    // never blocks, queues whatever the socket can't take right now
+    void Send(Connection<T>* conn, std::string_view msg) const;
+    // the reply reserved with conn->output.Reserve()
+    void Send(Connection<T>* conn, ReplySlot slot, std::string_view msg) const;
+    // sends what was held since conn->output.Cork()
+    void Uncork(Connection<T>* conn) const;
+
+    RecvBufferStats GetRecvBufferStats() const
+    {
+        RecvBufferStats total;
+        for (const auto& reactor : reactors)
+        {
+            const RecvBufferStats stats = reactor->recv_buffers.GetStats();
+            total.in_use += stats.in_use;
+            total.in_use_bytes += stats.in_use_bytes;
+            total.cached += stats.cached;
+        }
+        return total;
+    }
+
+    // runs the task on the reactor's thread (where its connections may be
+    // touched without locking), at its next wake up
+    void Post(Reactor<T>* reactor, std::function<void()> task) const
+    {
+        {
+            std::scoped_lock lock(reactor->tasks_mutex);
+            reactor->tasks.push_back(std::move(task));
+        }
+
+        const uint64_t one = 1;
+        if (write(reactor->wake_fd, &one, sizeof(one)) == -1 &&
+            errno != EAGAIN)
+        {
+            logger.Log<LogType::Error>("Failed to wake reactor {}: {} -> {}",
+                                       reactor->id, errno,
+                                       std::strerror(errno));
+        }
+    }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,442 @@
+#ifdef WITH_IO_URING
+#include "server.hpp"
+
+// io_uring engine of Server<T>, every connection has a multishot recv (on a
+// provided buffer ring) armed once and at most one send in flight, the
+// listener a multishot accept. everything queued during an iteration, the
+// replies uncorked after a read or a drain included, goes in with the single
+// submit_and_wait of the next one.
+// a send is only queued once the previous one of its connection completed,
+// links would only order the sends of one submit.
+
+// the operation lives in the unused high bits of the slot index of the
+// handle, so the generation check still rejects stale completions
+enum class UringOp : uint8_t
+{
+    ACCEPT = 1,
+    RECV = 2,
+    SEND = 3,
+    CANCEL = 4,
+    WAKE = 5
+};
+
+static constexpr uint32_t URING_OP_SHIFT = 24;
+static constexpr uint64_t URING_OP_MASK = 0xffULL << URING_OP_SHIFT;
+static constexpr uint16_t URING_BUF_GROUP = 0;
+
+static_assert(ServerConstants::MAX_CONNECTIONS_PER_REACTOR <=
+                  (1u << URING_OP_SHIFT),
+              "Slot index overlaps the uring op bits");
+
+static inline uint64_t UringData(UringOp op, ConnectionHandle handle = 0)
+{
+    return handle | (static_cast<uint64_t>(op) << URING_OP_SHIFT);
+}
+
+template <class T>
+void Server<T>::InitUring(Reactor<T> *reactor)
+{
+    io_uring_params params{};
+    // completions are only reaped by the reactor thread anyway
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+
+    if (int res =
+            io_uring_queue_init_params(URING_ENTRIES, &reactor->ring, &params);
+        res < 0)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Failed to create io_uring: {} -> {}.", -res, std::strerror(-res)));
+    }
+
+    int res = 0;
+    reactor->buf_ring = io_uring_setup_buf_ring(&reactor->ring, URING_BUF_COUNT,
+                                                URING_BUF_GROUP, 0, &res);
+    if (reactor->buf_ring == nullptr)
+    {
+        throw std::invalid_argument(
+            fmt::format("Failed to register io_uring buffer ring: {} -> {}.",
+                        -res, std::strerror(-res)));
+    }
+
+    reactor->buf_base = new char[URING_BUF_COUNT * URING_BUF_SIZE];
+    const int mask = io_uring_buf_ring_mask(URING_BUF_COUNT);
+    for (uint32_t bid = 0; bid < URING_BUF_COUNT; bid++)
+    {
+        io_uring_buf_ring_add(reactor->buf_ring,
+                              reactor->buf_base + bid * URING_BUF_SIZE,
+                              URING_BUF_SIZE, static_cast<uint16_t>(bid), mask,
+                              static_cast<int>(bid));
+    }
+    io_uring_buf_ring_advance(reactor->buf_ring, URING_BUF_COUNT);
+
+    // the listeners' accepts are armed as they are created
+    ArmWake(reactor);
+}
+
+template <class T>
+void Server<T>::DestroyUring(Reactor<T> *reactor)
+{
+    io_uring_free_buf_ring(&reactor->ring, reactor->buf_ring, URING_BUF_COUNT,
+                           URING_BUF_GROUP);
+    delete[] reactor->buf_base;
+    io_uring_queue_exit(&reactor->ring);
+}
+
+template <class T>
+void Server<T>::ServiceUring(Reactor<T> *reactor)
+{
+    // wake up in time for the next timer tick
+    const int wait_ms =
+        std::min(static_cast<int>(EPOLL_TIMEOUT),
+                 reactor->timers.MsUntilNextTick(reactor->timers.GetNowMs()));
+    __kernel_timespec ts{.tv_sec = wait_ms / 1000,
+                         .tv_nsec = (wait_ms % 1000) * 1000000LL};
+
+    io_uring_cqe *cqe = nullptr;
+    int res = io_uring_submit_and_wait_timeout(&reactor->ring, &cqe, 1, &ts,
+                                               nullptr);
+
+    if (res < 0 && res != -ETIME && res != -EINTR)
+    {
+        logger.Log<LogType::Error>("Failed to wait on io_uring: {} -> {}",
+                                   -res, std::strerror(-res));
+        return;
+    }
+
+    unsigned head;
+    unsigned count = 0;
+    io_uring_for_each_cqe(&reactor->ring, head, cqe)
+    {
+        HandleCompletion(reactor, cqe);
+        count++;
+    }
+    io_uring_cq_advance(&reactor->ring, count);
+
+    RetryDeferredUring(reactor);
+
+    reactor->timers.Advance(reactor->timers.GetNowMs(),
+                            [this, reactor](TimerNode *node) {
+                                HandleExpired(reactor,
+                                              static_cast<Connection<T> *>(
+                                                  node->data));
+                            });
+}
+
+template <class T>
+void Server<T>::HandleCompletion(Reactor<T> *reactor, io_uring_cqe *cqe)
+{
+    const uint64_t data = io_uring_cqe_get_data64(cqe);
+    const auto op = static_cast<UringOp>((data & URING_OP_MASK) >>
+                                         URING_OP_SHIFT);
+    const ConnectionHandle handle = data & ~URING_OP_MASK;
+
+    switch (op)
+    {
+        case UringOp::ACCEPT:
+            // the listener's index instead of a handle
+            HandleUringAccept(reactor, cqe, static_cast<uint8_t>(handle));
+            break;
+        case UringOp::RECV:
+        {
+            const bool has_buf = cqe->flags & IORING_CQE_F_BUFFER;
+            const auto bid =
+                static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+            Connection<T> *conn = reactor->connections.Get(handle);
+
+            // null: stale completion, the slot has been freed or reused
+            if (conn != nullptr)
+            {
+                if (!HandleUringRecv(reactor, conn, cqe))
+                {
+                    EraseClient(reactor, conn);
+                }
+                else
+                {
+                    // O(1) relink, no syscall
+                    conn->expiration_count = 0;
+                    reactor->timers.Schedule(&conn->timer, timeout_ms);
+                }
+            }
+
+            if (has_buf)
+            {
+                RecycleUringBuffer(reactor, bid);
+            }
+            break;
+        }
+        case UringOp::SEND:
+        {
+            Connection<T> *conn = reactor->connections.Get(handle);
+            if (conn == nullptr)
+            {
+                // the kernel is done with the freed connection's output
+                reactor->orphaned_sends.erase(handle);
+                break;
+            }
+
+            // queues the rest of a partial send, or what came meanwhile
+            if (!HandleSendResult(conn, conn->output.SendDone(cqe->res)))
+            {
+                EraseClient(reactor, conn);
+            }
+            break;
+        }
+        case UringOp::WAKE:
+            // the read reset the counter
+            ArmWake(reactor);
+            HandleWake(reactor);
+            break;
+        case UringOp::CANCEL:
+            break;
+    }
+}
+
+template <class T>
+void Server<T>::HandleUringAccept(Reactor<T> *reactor, io_uring_cqe *cqe,
+                                  uint8_t listener)
+{
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        ArmAccept(reactor, listener);
+    }
+
+    const int conn_fd = cqe->res;
+    if (conn_fd < 0)
+    {
+        logger.Log<LogType::Warn>("Failed to accept socket errno: {} -> {}.",
+                                  -conn_fd, std::strerror(-conn_fd));
+        return;
+    }
+
+    struct sockaddr_in conn_addr;
+    socklen_t addr_len = sizeof(conn_addr);
+
+    if (int yes = 1;
+        setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) ==
+            -1 ||
+        getpeername(conn_fd, (sockaddr *)&conn_addr, &addr_len) == -1)
+    {
+        close(conn_fd);
+        return;
+    }
+
+    AddConnection(reactor, conn_fd, conn_addr.sin_addr, listener);
+}
+
+template <class T>
+bool Server<T>::HandleUringRecv(Reactor<T> *reactor, Connection<T> *conn,
+                                io_uring_cqe *cqe)
+{
+    const int res = cqe->res;
+
+    if (res == -ENOBUFS)
+    {
+        // every provided buffer is in flight, the multishot recv ended
+        ArmRecv(reactor, conn);
+        return true;
+    }
+
+    if (res == 0)
+    {
+        logger.Log<LogType::Info>("Client with ip {} (sockfd {}) disconnected.",
+                                  conn->ip, conn->sockfd);
+        return false;
+    }
+
+    if (res < 0)
+    {
+        logger.Log<LogType::Warn>(
+            "Client with ip {} disconnected because of socket (fd:"
+            "{}) error: {} -> {}.",
+            conn->ip, conn->sockfd, -res, std::strerror(-res));
+        return false;
+    }
+
+    const auto bid =
+        static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    const char *data = reactor->buf_base + bid * URING_BUF_SIZE;
+
+    if (!AppendReceived(reactor, conn, data, static_cast<size_t>(res)))
+    {
+        return false;
+    }
+
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        ArmRecv(reactor, conn);
+    }
+    return true;
+}
+
+template <class T>
+io_uring_sqe *Server<T>::GetSqe(Reactor<T> *reactor, uint64_t data) const
+{
+    io_uring_sqe *sqe = io_uring_get_sqe(&reactor->ring);
+
+    if (sqe == nullptr)
+    {
+        // submission queue is full, flush it early
+        io_uring_submit(&reactor->ring);
+        sqe = io_uring_get_sqe(&reactor->ring);
+    }
+
+    if (sqe == nullptr) [[unlikely]]
+    {
+        // the kernel didn't take them (-EBUSY with a full completion
+        // queue), there is room once this iteration's completions are reaped
+        reactor->uring_deferred.push_back(data);
+    }
+    return sqe;
+}
+
+template <class T>
+void Server<T>::RetryDeferredUring(Reactor<T> *reactor)
+{
+    if (reactor->uring_deferred.empty()) return;
+
+    // whatever fails again is deferred to the next iteration
+    static thread_local std::vector<uint64_t> retry;
+    retry.swap(reactor->uring_deferred);
+
+    for (const uint64_t data : retry)
+    {
+        const auto op = static_cast<UringOp>((data & URING_OP_MASK) >>
+                                             URING_OP_SHIFT);
+        const ConnectionHandle handle = data & ~URING_OP_MASK;
+
+        switch (op)
+        {
+            case UringOp::ACCEPT:
+                ArmAccept(reactor, static_cast<uint8_t>(handle));
+                break;
+            case UringOp::RECV:
+                // null: disconnected meanwhile
+                if (Connection<T> *conn = reactor->connections.Get(handle))
+                {
+                    ArmRecv(reactor, conn);
+                }
+                break;
+            case UringOp::SEND:
+                if (Connection<T> *conn = reactor->connections.Get(handle))
+                {
+                    QueueUringSend(reactor, conn);
+                }
+                break;
+            case UringOp::WAKE:
+                ArmWake(reactor);
+                break;
+            case UringOp::CANCEL:
+                CancelUringConnection(reactor, handle);
+                break;
+        }
+    }
+    retry.clear();
+}
+
+template <class T>
+void Server<T>::ArmAccept(Reactor<T> *reactor, uint8_t listener)
+{
+    const uint64_t data = UringData(UringOp::ACCEPT, listener);
+    io_uring_sqe *sqe = GetSqe(reactor, data);
+    if (sqe == nullptr) return;
+
+    io_uring_prep_multishot_accept(sqe, reactor->listening_fds[listener],
+                                   nullptr, nullptr, SOCK_NONBLOCK);
+    io_uring_sqe_set_data64(sqe, data);
+}
+
+template <class T>
+void Server<T>::ArmRecv(Reactor<T> *reactor, Connection<T> *conn)
+{
+    const uint64_t data = UringData(UringOp::RECV, conn->handle);
+    io_uring_sqe *sqe = GetSqe(reactor, data);
+    if (sqe == nullptr) return;
+
+    io_uring_prep_recv_multishot(sqe, conn->sockfd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+    io_uring_sqe_set_data64(sqe, data);
+}
+
+template <class T>
+void Server<T>::QueueUringSend(Reactor<T> *reactor, Connection<T> *conn) const
+{
+    if (!conn->output.CanTakeSend()) return;
+
+    // waits for room in the socket's buffer itself, no POLLOUT needed
+    const uint64_t data = UringData(UringOp::SEND, conn->handle);
+    io_uring_sqe *sqe = GetSqe(reactor, data);
+    if (sqe == nullptr) return;
+
+    const std::string_view msg = conn->output.TakeSend();
+    io_uring_prep_send(sqe, conn->sockfd, msg.data(), msg.size(),
+                       MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, data);
+}
+
+template <class T>
+void Server<T>::ArmWake(Reactor<T> *reactor)
+{
+    const uint64_t data = UringData(UringOp::WAKE);
+    io_uring_sqe *sqe = GetSqe(reactor, data);
+    if (sqe == nullptr) return;
+
+    io_uring_prep_read(sqe, reactor->wake_fd, &reactor->wake_buf,
+                       sizeof(reactor->wake_buf), 0);
+    io_uring_sqe_set_data64(sqe, data);
+}
+
+template <class T>
+void Server<T>::CancelUringConnection(Reactor<T> *reactor,
+                                      ConnectionHandle handle)
+{
+    // deferred as one, cancelling an op twice is harmless
+    const uint64_t data = UringData(UringOp::CANCEL, handle);
+    for (UringOp op : {UringOp::RECV, UringOp::SEND})
+    {
+        io_uring_sqe *sqe = GetSqe(reactor, data);
+        if (sqe == nullptr) return;
+
+        io_uring_prep_cancel64(sqe, UringData(op, handle),
+                               IORING_ASYNC_CANCEL_ALL);
+        io_uring_sqe_set_data64(sqe, data);
+    }
+}
+
+template <class T>
+void Server<T>::RecycleUringBuffer(Reactor<T> *reactor, uint16_t bid)
+{
+    io_uring_buf_ring_add(reactor->buf_ring,
+                          reactor->buf_base + bid * URING_BUF_SIZE,
+                          URING_BUF_SIZE, bid,
+                          io_uring_buf_ring_mask(URING_BUF_COUNT), 0);
+    io_uring_buf_ring_advance(reactor->buf_ring, 1);
+}
+
+// the rest of Server<StratumClient> is instantiated in server.cpp
+#define INSTANTIATE(ret, name, ...) \
+    template ret Server<StratumClient>::name(__VA_ARGS__);
+
+INSTANTIATE(void, InitUring, Reactor<StratumClient> *)
+INSTANTIATE(void, DestroyUring, Reactor<StratumClient> *)
+INSTANTIATE(void, ServiceUring, Reactor<StratumClient> *)
+INSTANTIATE(void, HandleCompletion, Reactor<StratumClient> *, io_uring_cqe *)
+INSTANTIATE(void, HandleUringAccept, Reactor<StratumClient> *, io_uring_cqe *,
+            uint8_t)
+INSTANTIATE(bool, HandleUringRecv, Reactor<StratumClient> *,
+            Connection<StratumClient> *, io_uring_cqe *)
+template io_uring_sqe *Server<StratumClient>::GetSqe(Reactor<StratumClient> *,
+                                                     uint64_t) const;
+INSTANTIATE(void, RetryDeferredUring, Reactor<StratumClient> *)
+INSTANTIATE(void, ArmAccept, Reactor<StratumClient> *, uint8_t)
+INSTANTIATE(void, ArmRecv, Reactor<StratumClient> *,
+            Connection<StratumClient> *)
+template void Server<StratumClient>::QueueUringSend(
+    Reactor<StratumClient> *, Connection<StratumClient> *) const;
+INSTANTIATE(void, ArmWake, Reactor<StratumClient> *)
+INSTANTIATE(void, CancelUringConnection, Reactor<StratumClient> *,
+            ConnectionHandle)
+INSTANTIATE(void, RecycleUringBuffer, Reactor<StratumClient> *, uint16_t)
+
+#undef INSTANTIATE
+#endif
@@ -6,6 +6,7 @@ StratumClient::StratumClient(const int64_t time, const double diff,
                              const double rate, uint32_t retarget_interval)
     : VarDiff(rate, retarget_interval),
       connect_time(time),
-      current_diff(diff)
+      current_diff(diff),
+      share_target(Target256::FromDiff(diff * SHARE_DIFF_TOLERANCE))
 {
 }
\ No newline at end of file
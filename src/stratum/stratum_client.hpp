@@ -4,18 +4,20 @@
 #include <simdjson.h>
 
 #include <array>
+#include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 
 #include "config_vrsc.hpp"
 #include "difficulty_manager.hpp"
 #include "hash_wrapper.hpp"
 #include "stats.hpp"
+#include "target256.hpp"
 #include "utils.hpp"
 #include "verushash/verus_hash.h"
 
@@ -30,13 +32,27 @@ struct StringHash
     }
 };
 
+template <typename T>
+struct Connection;
+class StratumClient;
+
+// per reactor, connections by current difficulty (highest first), which
+// vardiff keeps proportional to the miner's hashrate
+using BroadcastIndex =
+    std::multimap<double, Connection<StratumClient>*, std::greater<double>>;
+
 class StratumClient : public VarDiff
 {
    public:
     explicit StratumClient(const int64_t time, const double diff,
                            const double rate, uint32_t retarget_interval);
 
+    // shares are accepted down to 1% below the difficulty
+    static constexpr double SHARE_DIFF_TOLERANCE = 0.99;
+
     double GetDifficulty() const { return current_diff; }
+    // what a share's hash has to meet at the current difficulty
+    const Target256& GetShareTarget() const { return share_target; }
     std::optional<double> GetPendingDifficulty() const { return pending_diff; }
     bool GetHasAuthorized() const { return !authorized_workers.empty(); }
 
@@ -61,26 +77,22 @@ class StratumClient : public VarDiff
     void ActivatePendingDiff()
     {
         current_diff = pending_diff.value();
+        share_target =
+            Target256::FromDiff(current_diff * SHARE_DIFF_TOLERANCE);
         pending_diff.reset();
     }
 
-    bool SetLastShare(uint32_t shareEnd, uint64_t time)
+    void SetLastShare(uint64_t time)
     {
         std::unique_lock lock(shares_mutex);
 
         uint64_t share_time = time - last_share_time;
         last_share_time = time;
 
-        // checks for existance in O(1), fast duplicate check
-        // sub 1 us!!!
-        bool inserted = share_uset.insert(shareEnd).second;
-
         this->Add(share_time);
 
         lock.unlock();
         HandleAdjust(time);
-
-        return inserted;
     }
 
     void HandleAdjust(uint64_t time)
@@ -92,12 +104,6 @@ class StratumClient : public VarDiff
         }
     }
 
-    void ResetShareSet()
-    {
-        std::scoped_lock lock(shares_mutex);
-        share_uset.clear();
-    }
-
     void AuthorizeWorker(const FullId full_id, std::string_view worker_name,
                          worker_map::iterator worker_it)
     {
@@ -113,8 +119,12 @@ class StratumClient : public VarDiff
     const std::string_view extra_nonce_sv{extra_nonce_hex.data(),
                                           sizeof(extra_nonce_hex)};
 
+    // the binary protocol's channel worker, its shares don't name one
+    std::string channel_worker;
+
     std::list<std::unique_ptr<StratumClient>>::iterator it;
     worker_map::iterator stats_it;
+    BroadcastIndex::iterator broadcast_it;
 
    private:
     static uint32_t extra_nonce_counter;
@@ -123,6 +133,7 @@ class StratumClient : public VarDiff
     uint64_t last_share_time;
 
     double current_diff;
+    Target256 share_target;
     std::optional<double> pending_diff;
 
     // std::string current_job_id;
@@ -136,9 +147,6 @@ class StratumClient : public VarDiff
 
     std::mutex shares_mutex;
 
-    // for O(1) duplicate search
-    // at the cost of a bit of memory, but much faster!
-    std::unordered_set<uint32_t> share_uset;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,676 @@
+#include "stratum_proxy_zec.hpp"
+
+#include "static_config.hpp"
+template class StratumProxyZec<VrscStatic>;
+
+static uint32_t GetReactorCount(const ProxyConfig &conf)
+{
+    // 0 = one reactor per core
+    if (conf.reactor_threads == 0)
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return conf.reactor_threads;
+}
+
+static uint32_t GetShareWorkerCount(const ProxyConfig &conf)
+{
+    // 0 = one per core
+    if (conf.share_workers == 0)
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return conf.share_workers;
+}
+
+static IoEngine GetIoEngine(const ProxyConfig &conf)
+{
+    if (conf.io_engine == "io_uring")
+    {
+        return IoEngine::IO_URING;
+    }
+    else if (conf.io_engine.empty() || conf.io_engine == "epoll")
+    {
+        return IoEngine::EPOLL;
+    }
+
+    throw std::invalid_argument(
+        fmt::format("Unknown io engine: {}", conf.io_engine));
+}
+
+// a session serves at least one reactor
+static uint32_t GetSessionCount(const ProxyConfig &conf)
+{
+    return std::clamp(conf.upstream_sessions, 1u, GetReactorCount(conf));
+}
+
+template <StaticConf confs>
+StratumProxyZec<confs>::StratumProxyZec(const ProxyConfig &conf)
+    : Server<StratumClient>(
+          {ListenPort{conf.stratum_port}},
+          static_cast<int>(60.0 / conf.diff_config.target_shares_rate * 2),
+          GetReactorCount(conf),
+          static_cast<uint64_t>(conf.socket_send_high_water_kb) * 1024,
+          GetIoEngine(conf)),
+      config(conf),
+      session_count(GetSessionCount(conf)),
+      broadcast_indexes(this->reactors.size()),
+      job_tables(this->reactors.size()),
+      upstream_nonce1s(this->reactors.size()),
+      share_completions(this->reactors.size()),
+      session_jobs(session_count),
+      hashing_pool(
+          GetShareWorkerCount(conf),
+          [](ShareTaskT *const *tasks, uint32_t count, HashingContext *ctx)
+          { ShareProcessor::Hash<confs>(tasks, count, &ctx->hasher); },
+          std::bind_front(&StratumProxyZec::QueueHashedShare, this))
+{
+    // jobs absorb their static header
+    HashWrapper::InitVerusHash();
+
+    sessions.reserve(session_count);
+    for (uint32_t i = 0; i < session_count; i++)
+    {
+        sessions.push_back(std::make_unique<UpstreamSession>(
+            i, config.upstream_host, config.upstream_user,
+            UpstreamSession::Callbacks{
+                .on_subscribed = [this, i](uint32_t nonce1)
+                { HandleUpstreamSubscribed(i, nonce1); },
+                .on_target = [this, i](const Target256 &target)
+                { HandleUpstreamTarget(i, target); },
+                .on_notify = [this, i](UpstreamNotifyZec &&notify)
+                { HandleUpstreamNotify(i, std::move(notify)); }}));
+    }
+
+    logger.template Log<LogType::Info>(
+        "Proxying to {} on {} sessions, verifying shares on {} hashing "
+        "workers",
+        config.upstream_host, session_count, hashing_pool.WorkerCount());
+}
+
+template <StaticConf confs>
+StratumProxyZec<confs>::~StratumProxyZec()
+{
+    // nothing may reach a session once they start going
+    Stop();
+    for (auto &t : processing_threads)
+    {
+        if (t.joinable()) t.join();
+    }
+
+    for (auto &completions : share_completions)
+    {
+        while (ShareTaskT *task = completions.queue.Pop()) delete task;
+    }
+    logger.template Log<LogType::Info>("Stratum proxy destroyed.");
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::Stop() noexcept
+{
+    logger.template Log<LogType::Info>("Stopping socket servicing...");
+
+    for (auto &t : processing_threads)
+    {
+        t.request_stop();
+    }
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::ServiceSockets(std::stop_token st,
+                                            Reactor<StratumClient> *reactor)
+{
+    logger.template Log<LogType::Info>("Starting reactor {} on thread {}",
+                                       reactor->id, gettid());
+
+    while (!st.stop_requested())
+    {
+        this->Service(reactor);
+    }
+
+    logger.template Log<LogType::Info>(
+        "Stopped servicing sockets on thread {}", gettid());
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::Listen()
+{
+    const auto core_count = std::max(std::thread::hardware_concurrency(), 1u);
+    processing_threads.reserve(this->reactors.size());
+
+    for (auto &reactor : this->reactors)
+    {
+        auto &thr = processing_threads.emplace_back(
+            std::bind_front(&StratumProxyZec::ServiceSockets, this),
+            reactor.get());
+
+        // keep each reactor (and its connections) on its own core
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(reactor->id % core_count, &cpuset);
+        if (pthread_setaffinity_np(thr.native_handle(), sizeof(cpuset),
+                                   &cpuset) != 0)
+        {
+            logger.template Log<LogType::Warn>(
+                "Failed to pin reactor {} to core {}", reactor->id,
+                reactor->id % core_count);
+        }
+    }
+
+    for (auto &t : processing_threads)
+    {
+        t.join();
+    }
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::HandleUpstreamSubscribed(uint32_t i,
+                                                      uint32_t nonce1)
+{
+    SessionJobs &state = session_jobs[i];
+    // the same extra nonce again, the rigs mine on
+    if (state.nonce1 == nonce1) return;
+
+    state.nonce1 = nonce1;
+    state.last_job.reset();
+
+    for (uint32_t r = i; r < this->reactors.size(); r += session_count)
+    {
+        Reactor<StratumClient> *reactor = this->reactors[r].get();
+        this->Post(reactor,
+                   [this, reactor, nonce1] { ResetReactor(reactor, nonce1); });
+    }
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::HandleUpstreamTarget(uint32_t i,
+                                                  const Target256 &target)
+{
+    // from the session's next job on, as miners take it
+    SessionJobs &state = session_jobs[i];
+    state.target = target;
+    state.diff = confs.DIFF1 / BytesToDoubleLE(target.ToBytesLE());
+
+    logger.template Log<LogType::Info>("Session {} difficulty: {}", i,
+                                       state.diff);
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::HandleUpstreamNotify(uint32_t i,
+                                                  UpstreamNotifyZec &&notify)
+{
+    SessionJobs &state = session_jobs[i];
+    if (!state.nonce1) return;
+
+    auto job = std::make_shared<JobT>(notify, state.target, state.diff);
+    job->seq = state.seq++;
+
+    // a replay is caught across the jobs of a block, as the pool does
+    const std::shared_ptr<JobT> &last_job = state.last_job;
+    if (job->clean || !last_job ||
+        last_job->prev_block_hash != job->prev_block_hash)
+    {
+        const uint64_t last_size =
+            last_job ? last_job->share_filter->Size() : 0;
+        job->share_filter = std::make_shared<ShareFilter>(
+            ShareFilter::CapacityFor(last_size));
+    }
+    else
+    {
+        job->share_filter = last_job->share_filter;
+    }
+    state.last_job = job;
+
+    const uint32_t reactor_count =
+        (static_cast<uint32_t>(this->reactors.size()) - i + session_count -
+         1) /
+        session_count;
+    auto broadcast =
+        std::make_shared<JobBroadcast<JobT>>(std::move(job), reactor_count);
+
+    for (uint32_t r = i; r < this->reactors.size(); r += session_count)
+    {
+        Reactor<StratumClient> *reactor = this->reactors[r].get();
+        this->Post(
+            reactor,
+            [this, i, broadcast, reactor]
+            {
+                BroadcastToReactor(reactor, broadcast.get());
+
+                if (broadcast->reactors_left.fetch_sub(
+                        1, std::memory_order_acq_rel) == 1)
+                {
+                    const UpstreamSession *session = sessions[i].get();
+                    logger.template Log<LogType::Info>(
+                        "Session {} job {} notify latency: {}, shares "
+                        "forwarded: {}, accepted: {}, rejected: {}",
+                        i, broadcast->job->id, broadcast->latency.ToString(),
+                        session->Forwarded(), session->Accepted(),
+                        session->Rejected());
+                }
+            });
+    }
+}
+
+// runs on the reactor's thread
+template <StaticConf confs>
+void StratumProxyZec<confs>::ResetReactor(Reactor<StratumClient> *reactor,
+                                          uint32_t nonce1)
+{
+    upstream_nonce1s[reactor->id] = nonce1;
+    // the previous session's jobs can't be mined with the new extra nonce
+    job_tables[reactor->id] = JobTableT{};
+
+    // their nonce1 is the previous one, erased once the reactor sees the
+    // hangup. they reconnect on their own
+    for (const auto &[_, conn] : broadcast_indexes[reactor->id])
+    {
+        shutdown(conn->sockfd, SHUT_RDWR);
+    }
+}
+
+// runs on the reactor's thread
+template <StaticConf confs>
+void StratumProxyZec<confs>::BroadcastToReactor(
+    Reactor<StratumClient> *reactor, JobBroadcast<JobT> *broadcast)
+{
+    const JobT *job = broadcast->job.get();
+    const double min_diff = config.diff_config.minimum_diff;
+    BroadcastIndex &index = broadcast_indexes[reactor->id];
+
+    // before anyone is notified, so a share for it always finds it
+    job_tables[reactor->id].Add(broadcast->job);
+
+    // repositioned after the walk, so the order of this one stays stable
+    static thread_local std::vector<Connection<StratumClient> *> retargeted;
+    retargeted.clear();
+
+    // biggest rigs first, they lose the most to stale work
+    for (const auto &[_, conn] : index)
+    {
+        auto cli = conn->ptr.get();
+        if (cli->GetHasAuthorized())
+        {
+            const bool new_diff = cli->GetPendingDifficulty().has_value();
+            if (new_diff) UpdateDifficulty(conn);
+
+            this->Send(conn, job->notify_msg);
+
+            if (new_diff)
+            {
+                cli->ActivatePendingDiff();
+                retargeted.push_back(conn);
+            }
+
+            broadcast->latency.Record(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - broadcast->start)
+                    .count());
+        }
+
+        if (cli->GetDifficulty() < min_diff)
+        {
+            shutdown(conn->sockfd, SHUT_RDWR);
+        }
+    }
+
+    for (Connection<StratumClient> *conn : retargeted)
+    {
+        auto cli = conn->ptr.get();
+        index.erase(cli->broadcast_it);
+        cli->broadcast_it = index.emplace(cli->GetDifficulty(), conn);
+    }
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::HandleConsumeable(Connection<StratumClient> *conn)
+{
+    static thread_local WorkerContext<confs.BLOCK_HEADER_SIZE> wc;
+
+    const FrameStatus status = FrameLines(
+        conn->req_buff, conn->req_start, conn->req_scan, conn->req_pos,
+        MAX_REQ_LINE_LEN,
+        [&](std::string_view req) { HandleReq(conn, &wc, req); });
+
+    share_completions[conn->reactor_id].SubmitReadBatch(hashing_pool);
+
+    if (status == FrameStatus::LINE_TOO_LONG)
+    {
+        logger.template Log<LogType::Warn>(
+            "Disconnecting rig with ip {}, request longer than {} bytes.",
+            conn->ip, MAX_REQ_LINE_LEN);
+        shutdown(conn->sockfd, SHUT_RDWR);
+        conn->req_start = conn->req_pos;
+    }
+
+    // everything consumed, rewind for free instead of compacting
+    if (conn->req_start == conn->req_pos)
+    {
+        conn->req_start = 0;
+        conn->req_scan = 0;
+        conn->req_pos = 0;
+    }
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::HandleReq(
+    Connection<StratumClient> *conn,
+    WorkerContext<confs.BLOCK_HEADER_SIZE> *wc, std::string_view req)
+{
+    if (ScannedSubmit<SUBMIT_PARAMS> submit; SubmitScanner::Scan(
+            req, "mining.submit", SUBMIT_PARAM_SIZES, submit))
+    {
+        std::optional<RpcResult> submit_res =
+            HandleSubmit(conn, submit.params, submit.id);
+        if (submit_res) SendRes(conn, submit.id, *submit_res);
+        return;
+    }
+
+    int64_t id = 0;
+    const auto cli = conn->ptr.get();
+
+    std::string_view method;
+    simdjson::ondemand::document doc;
+    simdjson::ondemand::array params;
+
+    try
+    {
+        doc = wc->json_parser.iterate(req.data(), req.size(),
+                                      req.size() + simdjson::SIMDJSON_PADDING);
+
+        simdjson::ondemand::object req_obj = doc.get_object();
+        id = req_obj["id"].get_int64();
+        method = req_obj["method"].get_string();
+        params = req_obj["params"].get_array();
+    }
+    catch (const simdjson::simdjson_error &err)
+    {
+        SendRes(conn, id, RpcResult(ResCode::UNKNOWN, "Bad request"));
+        logger.template Log<LogType::Error>(
+            "Request JSON parse error: {}\nRequest: {}\n", err.what(), req);
+        return;
+    }
+
+    RpcResult res(ResCode::UNKNOWN);
+
+    if (method == "mining.submit")
+    {
+        using namespace std::string_view_literals;
+
+        SubmitParams values;
+        std::array<Field, SUBMIT_PARAMS> fields{
+            {Field{"worker"sv, &values[0], SUBMIT_PARAM_SIZES[0]},
+             Field{"job id"sv, &values[1], SUBMIT_PARAM_SIZES[1]},
+             Field{"time"sv, &values[2], SUBMIT_PARAM_SIZES[2]},
+             Field{"nonce2"sv, &values[3], SUBMIT_PARAM_SIZES[3]},
+             Field{"solution"sv, &values[4], SUBMIT_PARAM_SIZES[4]}}};
+
+        if (std::string parse_err = ParseShareParams(fields, params);
+            !parse_err.empty())
+        {
+            res = RpcResult(ResCode::UNKNOWN,
+                            "Failed to parse share: " + parse_err);
+        }
+        else
+        {
+            std::optional<RpcResult> submit_res =
+                HandleSubmit(conn, values, id);
+            if (!submit_res) return;
+            res = std::move(*submit_res);
+        }
+    }
+    else if (method == "mining.subscribe")
+    {
+        res = HandleSubscribe(conn);
+    }
+    else if (method == "mining.authorize")
+    {
+        res = HandleAuthorize(cli, params);
+        if (res.code == ResCode::OK)
+        {
+            SendRes(conn, id, res);
+            UpdateDifficulty(conn);
+
+            const std::shared_ptr<JobT> &job =
+                job_tables[conn->reactor_id].Last();
+            if (job) this->Send(conn, job->notify_msg);
+            return;
+        }
+    }
+    else
+    {
+        res = RpcResult(ResCode::UNKNOWN, "Unknown method");
+        logger.template Log<LogType::Warn>("Unknown request method: {}",
+                                           method);
+    }
+
+    SendRes(conn, id, res);
+}
+
+// https://zips.z.cash/zip-0301#mining-subscribe
+template <StaticConf confs>
+RpcResult StratumProxyZec<confs>::HandleSubscribe(
+    const Connection<StratumClient> *conn) const
+{
+    // the session's extra nonce, then the rig's
+    const std::array<char, 8> upstream_hex =
+        Hexlify(upstream_nonce1s[conn->reactor_id]);
+
+    return RpcResult(ResCode::OK,
+                     fmt::format("[null,\"{}{}\"]",
+                                 std::string_view(upstream_hex.data(),
+                                                  upstream_hex.size()),
+                                 conn->ptr->extra_nonce_sv));
+}
+
+// the farm's own rigs, any name goes
+template <StaticConf confs>
+RpcResult StratumProxyZec<confs>::HandleAuthorize(
+    StratumClient *cli, simdjson::ondemand::array &params) const
+{
+    std::string_view worker;
+    try
+    {
+        worker = params.at(0).get_string();
+    }
+    catch (const simdjson::simdjson_error &err)
+    {
+        return RpcResult(ResCode::UNAUTHORIZED_WORKER,
+                         "Bad request, no worker name!");
+    }
+
+    if (worker.empty() || worker.size() > ADDRESS_LEN + 1 + MAX_WORKER_NAME_LEN)
+    {
+        return RpcResult(ResCode::UNAUTHORIZED_WORKER,
+                         "Bad request, bad worker name!");
+    }
+
+    // its shares are submitted under this name, without stats
+    cli->AuthorizeWorker(FullId{0, 0}, worker, worker_map::iterator{});
+    return RpcResult(ResCode::OK);
+}
+
+// https://zips.z.cash/zip-0301#mining-submit
+template <StaticConf confs>
+std::optional<RpcResult> StratumProxyZec<confs>::HandleSubmit(
+    Connection<StratumClient> *conn, const SubmitParams &params,
+    int64_t req_id)
+{
+    const auto cli = conn->ptr.get();
+    const uint64_t time = GetCurrentTimeMs();
+
+    std::optional<FullId> authorized_id = cli->GetAuthorizedId(params[0]);
+    if (!authorized_id)
+    {
+        return RpcResult(ResCode::UNAUTHORIZED_WORKER, "Unauthorized worker");
+    }
+
+    std::shared_ptr<JobT> job = job_tables[conn->reactor_id].Get(params[1]);
+    if (job == nullptr)
+    {
+        return RpcResult(ResCode::JOB_NOT_FOUND, "Job not found");
+    }
+
+    // the session's nonce2: the rig's extra nonce, then the rig's nonce2
+    // (its size checked with the params)
+    char nonce2[EXTRANONCE2_SIZE * 2];
+    std::memcpy(nonce2, cli->extra_nonce_sv.data(),
+                cli->extra_nonce_sv.size());
+    std::memcpy(nonce2 + cli->extra_nonce_sv.size(), params[3].data(),
+                RIG_EXTRANONCE2_SIZE * 2);
+
+    ShareZec share;
+    share.worker = params[0];
+    share.job_id = params[1];
+    share.nonce2_sv = std::string_view(nonce2, sizeof(nonce2));
+    share.solution = params[4];
+
+    const std::string_view time_sv = params[2];
+    std::from_chars(time_sv.data(), time_sv.data() + time_sv.size(),
+                    share.time, 16);
+    share.time = bswap_32(share.time);
+
+    ShareCompletions<ShareTaskT> &completions =
+        share_completions[conn->reactor_id];
+    std::unique_ptr<ShareTaskT> task = completions.TakeTask();
+
+    // the header the pool will hash
+    if (!ShareProcessor::Prepare<confs>(
+            task->result, upstream_nonce1s[conn->reactor_id],
+            task->block_header.data(), job.get(), share, time))
+    {
+        RpcResult res(task->result.code, std::move(task->result.message));
+        completions.ReturnTask(std::move(task));
+        return res;
+    }
+
+    task->cli = conn->ptr;
+    task->conn_handle = conn->handle;
+    task->reactor_id = conn->reactor_id;
+    task->req_id = req_id;
+    task->reply_slot = conn->output.Reserve();
+    task->authorized_id = authorized_id.value();
+    task->job = std::move(job);
+    task->time_ms = time;
+
+    // submitted with the rest of the read's shares in HandleConsumeable
+    completions.read_batch.push_back(task.release());
+    return std::nullopt;
+}
+
+// on a hashing worker's thread
+template <StaticConf confs>
+void StratumProxyZec<confs>::QueueHashedShare(ShareTaskT *task)
+{
+    if (share_completions[task->reactor_id].Push(task))
+    {
+        Reactor<StratumClient> *reactor =
+            this->reactors[task->reactor_id].get();
+        this->Post(reactor, [this, reactor] { DrainHashedShares(reactor); });
+    }
+}
+
+// runs on the reactor's thread
+template <StaticConf confs>
+void StratumProxyZec<confs>::DrainHashedShares(
+    Reactor<StratumClient> *reactor)
+{
+    share_completions[reactor->id].Drain(
+        reactor,
+        [this](ShareTaskT &task, Connection<StratumClient> *conn)
+        {
+            // a share meeting the pool's target is forwarded even if its
+            // rig disconnected meanwhile
+            const RpcResult res =
+                FinishShare(task, *sessions[task.reactor_id % session_count]);
+            if (conn) SendRes(conn, task.reply_slot, task.req_id, res);
+        },
+        [this](Connection<StratumClient> *conn) { this->Uncork(conn); });
+}
+
+template <StaticConf confs>
+RpcResult StratumProxyZec<confs>::FinishShare(ShareTaskT &task,
+                                              UpstreamSession &session)
+{
+    ShareResult &share_res = task.result;
+    ShareProcessor::Verify<confs>(share_res, task.cli.get(), task.job.get(),
+                                  task.time_ms);
+
+    // the job's block target is the pool's share target
+    if (share_res.code == ResCode::VALID_BLOCK) [[unlikely]]
+    {
+        session.Submit(task.job->id, task.block_header.data());
+        return RpcResult(ResCode::OK);
+    }
+    else if (share_res.code == ResCode::VALID_SHARE) [[likely]]
+    {
+        return RpcResult(ResCode::OK);
+    }
+
+    return RpcResult(share_res.code, std::move(share_res.message));
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::UpdateDifficulty(
+    Connection<StratumClient> *conn) const
+{
+    const StratumClient *cli = conn->ptr.get();
+    auto diff_hex = GetDifficultyHex<confs>(
+        cli->GetPendingDifficulty().value_or(cli->GetDifficulty()));
+
+    char buff[StratumReply::STACK_SIZE];
+    const auto res = fmt::format_to_n(
+        buff, sizeof(buff),
+        "{{\"id\":null,\"method\":\"mining.set_target\",\"params\":[\"{}\"]}}"
+        "\n",
+        std::string_view(diff_hex.data(), diff_hex.size()));
+
+    this->Send(conn, std::string_view(buff, res.out - buff));
+}
+
+template <StaticConf confs>
+bool StratumProxyZec<confs>::HandleConnected(Connection<StratumClient> *conn)
+{
+    conn->ptr = std::make_shared<StratumClient>(
+        GetCurrentTimeMs(), config.diff_config.default_diff,
+        config.diff_config.target_shares_rate,
+        config.diff_config.retarget_interval);
+
+    // only touched by the connection's reactor
+    conn->ptr->broadcast_it = broadcast_indexes[conn->reactor_id].emplace(
+        conn->ptr->GetDifficulty(), conn);
+
+    // the session hasn't got a job from the pool (yet)
+    if (job_tables[conn->reactor_id].Last() == nullptr)
+    {
+        logger.template Log<LogType::Warn>(
+            "Rejecting rig connection, as there isn't a job!");
+        return false;
+    }
+
+    return true;
+}
+
+template <StaticConf confs>
+bool StratumProxyZec<confs>::HandleTimeout(Connection<StratumClient> *conn,
+                                           uint64_t timeout_streak)
+{
+    if (auto cli = conn->ptr.get(); !cli->GetHasAuthorized())
+    {
+        logger.template Log<LogType::Warn>(
+            "Disconnecting rig with ip {}, hasn't authorized.", conn->ip);
+        return false;
+    }
+    else
+    {
+        cli->HandleAdjust(GetCurrentTimeMs());
+    }
+    return true;
+}
+
+template <StaticConf confs>
+void StratumProxyZec<confs>::HandleDisconnected(
+    Connection<StratumClient> *conn)
+{
+    broadcast_indexes[conn->reactor_id].erase(conn->ptr->broadcast_it);
+}
@@ -0,0 +1,134 @@
+#ifndef STRATUM_PROXY_ZEC_HPP_
+#define STRATUM_PROXY_ZEC_HPP_
+
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "coin_config.hpp"
+#include "config_vrsc.hpp"
+#include "stratum_server.hpp"
+#include "submit_scanner.hpp"
+#include "upstream_session.hpp"
+
+// proxy mode: a farm's rigs mine here instead of on the pool. the pool's
+// jobs reach them from the farm's own reactors, their shares are verified
+// here against their vardiff and only the ones meeting the pool's target are
+// forwarded, on a few upstream sessions instead of a connection per rig.
+// no database, daemon or stats.
+// a session's extra nonce is split among the rigs: a rig's nonce1 is the
+// session's followed by its own extra nonce, the pool sees the rig's extra
+// nonce as the start of the session's nonce2. the rigs of reactor r mine on
+// session r % upstream_sessions, and are disconnected if it comes back with
+// another extra nonce.
+template <StaticConf confs>
+class StratumProxyZec : public Server<StratumClient>,
+                        public StratumConstants,
+                        public CoinConstantsZec
+{
+   public:
+    explicit StratumProxyZec(const ProxyConfig& conf);
+    ~StratumProxyZec();
+    void Listen();
+    void Stop() noexcept;
+
+    using JobT = Job<confs.STRATUM_PROTOCOL>;
+    using ShareTaskT = ShareTask<confs>;
+    // the pool numbers the jobs
+    using JobTableT = JobTable<JobT, false>;
+
+    // what's left of the session's nonce2 for the rig
+    static constexpr uint32_t RIG_EXTRANONCE2_SIZE =
+        EXTRANONCE2_SIZE - EXTRANONCE_SIZE;
+
+    // the reply to a hashed share, answered here unless it meets the pool's
+    // target (the job's block target), then it's also forwarded on session
+    static RpcResult FinishShare(ShareTaskT& task, UpstreamSession& session);
+
+   private:
+    static constexpr std::string_view field_str = "StratumProxyZec";
+    const Logger logger{field_str};
+
+    // worker, job id, time, nonce2, solution
+    static constexpr size_t SUBMIT_PARAMS = 5;
+    static constexpr std::array<size_t, SUBMIT_PARAMS> SUBMIT_PARAM_SIZES{
+        0, 0, sizeof(ShareZec::time) * 2, RIG_EXTRANONCE2_SIZE * 2,
+        (SOLUTION_SIZE + SOLUTION_LENGTH_SIZE) * 2};
+    using SubmitParams = std::array<std::string_view, SUBMIT_PARAMS>;
+
+    // a session's jobs as they're made, only touched on its thread
+    struct SessionJobs
+    {
+        std::optional<uint32_t> nonce1;
+        Target256 target = Target256::Max();
+        double diff = 1.0;
+        std::shared_ptr<JobT> last_job;
+        uint32_t seq = 0;
+    };
+
+    const ProxyConfig config;
+    const uint32_t session_count;
+    std::vector<std::jthread> processing_threads;
+
+    // one per reactor, indexed by reactor id
+    std::vector<BroadcastIndex> broadcast_indexes;
+    std::vector<JobTableT> job_tables;
+    // the extra nonce of the reactor's session, as its rigs were told
+    std::vector<uint32_t> upstream_nonce1s;
+    std::vector<ShareCompletions<ShareTaskT>> share_completions;
+    std::vector<SessionJobs> session_jobs;
+
+    HashingPool<ShareTaskT, HashingContext> hashing_pool;
+    // last, their threads call into everything above
+    std::vector<std::unique_ptr<UpstreamSession>> sessions;
+
+    void ServiceSockets(std::stop_token st, Reactor<StratumClient>* reactor);
+
+    // on session i's thread
+    void HandleUpstreamSubscribed(uint32_t i, uint32_t nonce1);
+    void HandleUpstreamTarget(uint32_t i, const Target256& target);
+    void HandleUpstreamNotify(uint32_t i, UpstreamNotifyZec&& notify);
+
+    // on the reactor's thread
+    void ResetReactor(Reactor<StratumClient>* reactor, uint32_t nonce1);
+    void BroadcastToReactor(Reactor<StratumClient>* reactor,
+                            JobBroadcast<JobT>* broadcast);
+
+    void HandleReq(Connection<StratumClient>* conn,
+                   WorkerContext<confs.BLOCK_HEADER_SIZE>* wc,
+                   std::string_view req);
+    RpcResult HandleSubscribe(const Connection<StratumClient>* conn) const;
+    RpcResult HandleAuthorize(StratumClient* cli,
+                              simdjson::ondemand::array& params) const;
+    std::optional<RpcResult> HandleSubmit(Connection<StratumClient>* conn,
+                                          const SubmitParams& params,
+                                          int64_t req_id);
+    void QueueHashedShare(ShareTaskT* task);
+    void DrainHashedShares(Reactor<StratumClient>* reactor);
+    void UpdateDifficulty(Connection<StratumClient>* conn) const;
+
+    inline void SendRes(Connection<StratumClient>* conn, int64_t req_id,
+                        const RpcResult& res) const
+    {
+        StratumReply::EncodeTo(req_id, res.code, res.Msg(),
+                               [&](std::string_view msg) { Send(conn, msg); });
+    }
+
+    // a reply whose place was reserved when its request came in
+    inline void SendRes(Connection<StratumClient>* conn, ReplySlot slot,
+                        int64_t req_id, const RpcResult& res) const
+    {
+        StratumReply::EncodeTo(req_id, res.code, res.Msg(),
+                               [&](std::string_view msg)
+                               { Send(conn, slot, msg); });
+    }
+
+    void HandleConsumeable(Connection<StratumClient>* conn) override;
+    bool HandleConnected(Connection<StratumClient>* conn) override;
+    bool HandleTimeout(Connection<StratumClient>* conn,
+                       uint64_t timeout_streak) override;
+    void HandleDisconnected(Connection<StratumClient>* conn) override;
+};
+
+#endif
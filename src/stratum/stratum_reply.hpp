@@ -0,0 +1,95 @@
+#ifndef STRATUM_REPLY_HPP_
+#define STRATUM_REPLY_HPP_
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "share.hpp"
+
+// json rpc replies put together from constant fragments, the id and error
+// code written with to_chars. nothing is formatted or allocated, replies are
+// encoded on the stack and go straight to the connection's output queue.
+class StratumReply
+{
+   public:
+    // fits every reply with a constant message
+    static constexpr size_t STACK_SIZE = 256;
+
+    static constexpr std::string_view ID = "{\"id\":";
+    static constexpr std::string_view OK_HEAD =
+        ",\"jsonrpc\":\"2.0\",\"error\":null,\"result\":";
+    static constexpr std::string_view OK_TAIL = "}\n";
+    // the reply to nearly every submit, in one piece
+    static constexpr std::string_view OK_TRUE =
+        ",\"jsonrpc\":\"2.0\",\"error\":null,\"result\":true}\n";
+    static constexpr std::string_view ERROR_HEAD =
+        ",\"jsonrpc\":\"2.0\",\"result\":null,\"error\":[";
+    static constexpr std::string_view ERROR_MSG = ",\"";
+    static constexpr std::string_view ERROR_TAIL = "\",null]}\n";
+
+    static constexpr size_t MAX_INT_LEN = 20;
+
+    // an upper bound of the encoded size
+    static constexpr size_t MaxSize(size_t msg_size)
+    {
+        return ID.size() + MAX_INT_LEN + ERROR_HEAD.size() + MAX_INT_LEN +
+               ERROR_MSG.size() + msg_size + ERROR_TAIL.size();
+    }
+
+    // out has at least MaxSize(msg.size()) bytes, returns the reply's size.
+    // an ok reply's msg is the raw json result, an error's is quoted
+    static size_t Encode(char* out, int64_t id, ResCode code,
+                         std::string_view msg)
+    {
+        char* pos = Put(out, ID);
+        pos = std::to_chars(pos, pos + MAX_INT_LEN, id).ptr;
+
+        if (code == ResCode::OK)
+        {
+            if (msg == "true") [[likely]]
+            {
+                return Put(pos, OK_TRUE) - out;
+            }
+
+            pos = Put(pos, OK_HEAD);
+            pos = Put(pos, msg);
+            return Put(pos, OK_TAIL) - out;
+        }
+
+        pos = Put(pos, ERROR_HEAD);
+        pos = std::to_chars(pos, pos + MAX_INT_LEN, static_cast<int>(code)).ptr;
+        pos = Put(pos, ERROR_MSG);
+        pos = Put(pos, msg);
+        return Put(pos, ERROR_TAIL) - out;
+    }
+
+    // hands the encoded reply to send, from the stack unless the message is
+    // too long for it (subscribe results, some errors)
+    template <typename SendFn>
+    static void EncodeTo(int64_t id, ResCode code, std::string_view msg,
+                         SendFn&& send)
+    {
+        if (MaxSize(msg.size()) > STACK_SIZE) [[unlikely]]
+        {
+            std::string str(MaxSize(msg.size()), '\0');
+            str.resize(Encode(str.data(), id, code, msg));
+            send(std::string_view(str));
+            return;
+        }
+
+        char buff[STACK_SIZE];
+        send(std::string_view(buff, Encode(buff, id, code, msg)));
+    }
+
+   private:
+    static char* Put(char* pos, std::string_view fragment)
+    {
+        std::memcpy(pos, fragment.data(), fragment.size());
+        return pos + fragment.size();
+    }
+};
+
+#endif
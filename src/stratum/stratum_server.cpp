@@ -2,6 +2,16 @@
 template class StratumServer<ZanoStatic>;
 template class StratumServer<VrscStatic>;
 
+static uint32_t GetShareWorkerCount(const CoinConfig &conf)
+{
+    // 0 = one per core
+    if (conf.share_workers == 0)
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return conf.share_workers;
+}
+
 template <StaticConf confs>
 StratumServer<confs>::StratumServer(CoinConfig &&conf)
     : StratumBase(std::move(conf)),
@@ -9,10 +19,37 @@ StratumServer<confs>::StratumServer(CoinConfig &&conf)
       job_manager(&daemon_manager, coin_config.pool_addr),
       block_submitter(&daemon_manager, &round_manager),
       stats_manager(persistence_layer, &round_manager, &conf.stats,
-                    GetHashMultiplier<confs>())
+                    GetHashMultiplier<confs>()),
+      broadcast_indexes(this->reactors.size()),
+      job_tables(this->reactors.size()),
+      share_completions(this->reactors.size()),
+      hashing_pool(
+          GetShareWorkerCount(coin_config),
+          [](ShareTaskT *const *tasks, uint32_t count, HashingContext *ctx)
+          { ShareProcessor::Hash<confs>(tasks, count, &ctx->hasher); },
+          std::bind_front(&StratumServer::QueueHashedShare, this))
 {
     static_assert(confs.DIFF1 != 0, "DIFF1 can't be zero!");
+
+    // init hash functions if needed, jobs absorb their static header
+    HashWrapper::InitSHA256();
+
+    if constexpr (confs.HASH_ALGO == HashAlgo::VERUSHASH_V2b2)
+    {
+        HashWrapper::InitVerusHash();
+    }
+
     job_manager.GetFirstJob();
+    if constexpr (confs.HASH_ALGO == HashAlgo::PROGPOWZ)
+    {
+        epoch_prewarmer.OnHeight(job_manager.GetLastJob()->height);
+    }
+    // the reactors aren't running yet, connections accepted before the first
+    // broadcast reaches them already have a job
+    for (auto &job_table : job_tables)
+    {
+        job_table.Add(job_manager.GetLastJob());
+    }
     persistence_layer.Init();
 
     if (auto error =
@@ -25,22 +62,25 @@ StratumServer<confs>::StratumServer(CoinConfig &&conf)
         exit(EXIT_FAILURE);
     }
 
-    // init hash functions if needed
-    HashWrapper::InitSHA256();
-
-    if constexpr (confs.HASH_ALGO == HashAlgo::VERUSHASH_V2b2)
-    {
-        HashWrapper::InitVerusHash();
-    }
-
     stats_thread =
         std::jthread(std::bind_front(&StatsManager::Start, &stats_manager));
+    block_thread =
+        std::jthread(std::bind_front(&StratumServer::SubmitBlocks, this));
+
+    logger.template Log<LogType::Info>("Verifying shares on {} hashing workers",
+                                       hashing_pool.WorkerCount());
 }
 
 template <StaticConf confs>
 StratumServer<confs>::~StratumServer()
 {
     stats_thread.request_stop();
+
+    // hashed, but their reactor stopped before replying
+    for (auto &completions : share_completions)
+    {
+        while (ShareTaskT *task = completions.queue.Pop()) delete task;
+    }
     this->logger.template Log<LogType::Info>("Stratum destroyed.");
 }
 
@@ -68,72 +108,111 @@ void StratumServer<confs>::HandleNewJob()
 }
 
 // ONLY UPDATE DIFFICULTY ON NEW JOB AS MINERS WILL IGNORE IT OTHERWISE...
+// runs on the reactor's thread
 template <StaticConf confs>
-void StratumServer<confs>::HandleNewJob(const std::shared_ptr<JobT> new_job)
+void StratumServer<confs>::BroadcastToReactor(
+    Reactor<StratumClient> *reactor, JobBroadcast<JobT> *broadcast)
 {
-    {
-        std::shared_lock clients_read_lock(clients_mutex);
-        for (const auto &[conn, _] : clients)
-        {
-            auto cli = conn->ptr.get();
-            if (cli->GetHasAuthorized())
-            {
-                double diff;
-                std::optional<double> new_diff = cli->GetPendingDifficulty();
-                if (new_diff)
-                {
-                    diff = new_diff.value();
-                    UpdateDifficulty(conn.get());
-                }
-                else
-                {
-                    diff = cli->GetDifficulty();
-                }
+    const JobT *job = broadcast->job.get();
+    const double min_diff = coin_config.diff_config.minimum_diff;
+    BroadcastIndex &index = broadcast_indexes[reactor->id];
 
-                BroadcastJob(conn.get(), diff, new_job.get());
+    // before anyone is notified, so a share for it always finds it
+    job_tables[reactor->id].Add(broadcast->job);
 
-                if (new_diff)
-                {
-                    cli->ActivatePendingDiff();
-                }
-            }
-        }
+    // repositioned after the walk, so the order of this one stays stable
+    static thread_local std::vector<Connection<StratumClient> *> retargeted;
+    retargeted.clear();
 
-        // after we broadcasted new job:
-        // > kick clients with below min difficulty
-        // > update the map according to difficulties (notify best miners
-        // first) > reset duplicate shares map
-
-        for (auto it = clients.begin(); it != clients.end();)
+    // biggest miners first, they lose the most to stale work
+    for (const auto &[_, conn] : index)
+    {
+        auto cli = conn->ptr.get();
+        if (cli->GetHasAuthorized())
         {
-            const auto cli = (*it).first->ptr;
-            const auto cli_diff = cli->GetDifficulty();
-            if (cli_diff < coin_config.diff_config.minimum_diff)
+            double diff;
+            std::optional<double> new_diff = cli->GetPendingDifficulty();
+            if (new_diff)
             {
-                this->DisconnectClient(it->first);
-                it++;
+                diff = new_diff.value();
+                UpdateDifficulty(conn);
             }
             else
             {
-                ++it;
+                diff = cli->GetDifficulty();
             }
 
-            // update the difficulty in the map
-            it->second = cli_diff;
-        }
+            BroadcastJob(conn, diff, job);
 
-        // only reset share set if we invalidated the old jobs!
-        if (new_job->clean)
-        {
-            round_manager.SetNewBlockStats(coin_config.symbol, new_job->height,
-                                           new_job->target_diff);
-            for (const auto &[cli, _] : clients)
+            if (new_diff)
             {
-                cli->ptr->ResetShareSet();
+                cli->ActivatePendingDiff();
+                retargeted.push_back(conn);
             }
+
+            broadcast->latency.Record(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - broadcast->start)
+                    .count());
+        }
+
+        // after we broadcasted new job:
+        // > kick clients with below min difficulty, erased once the
+        // reactor sees the hangup
+        if (cli->GetDifficulty() < min_diff)
+        {
+            shutdown(conn->sockfd, SHUT_RDWR);
         }
     }
 
+    // O(log n) each, only the miners whose vardiff activated
+    for (Connection<StratumClient> *conn : retargeted)
+    {
+        auto cli = conn->ptr.get();
+        index.erase(cli->broadcast_it);
+        cli->broadcast_it = index.emplace(cli->GetDifficulty(), conn);
+    }
+}
+
+template <StaticConf confs>
+void StratumServer<confs>::HandleNewJob(const std::shared_ptr<JobT> new_job)
+{
+    // the job's epoch is ready before miners get it, the next is built
+    // ahead when close
+    if constexpr (confs.HASH_ALGO == HashAlgo::PROGPOWZ)
+    {
+        epoch_prewarmer.OnHeight(new_job->height);
+    }
+
+    if (new_job->clean)
+    {
+        round_manager.SetNewBlockStats(coin_config.symbol, new_job->height,
+                                       new_job->target_diff);
+    }
+
+    // every reactor notifies its own connections in parallel, the last one
+    // to finish reports the latency
+    auto broadcast = std::make_shared<JobBroadcast<JobT>>(
+        new_job, static_cast<uint32_t>(this->reactors.size()));
+
+    for (auto &reactor : this->reactors)
+    {
+        this->Post(
+            reactor.get(),
+            [this, broadcast, reactor = reactor.get()]
+            {
+                BroadcastToReactor(reactor, broadcast.get());
+
+                if (broadcast->reactors_left.fetch_sub(
+                        1, std::memory_order_acq_rel) == 1)
+                {
+                    logger.template Log<LogType::Info>(
+                        "Job #{} notify latency: {}", broadcast->job->id,
+                        broadcast->latency.ToString());
+                }
+            });
+    }
+
     // the estimated share amount is supposed to be meet at block time
     const double net_est_hr = new_job->expected_hashes / confs.BLOCK_TIME;
     stats_manager.SetNetworkStats(NetworkStats{
@@ -161,11 +240,25 @@ void StratumServer<confs>::HandleNewJob(const std::shared_ptr<JobT> new_job)
         fmt::format("Transaction count: {}", new_job->tx_count),
         fmt::format("Block size: {}", new_job->block_size * 2),
         std::max(int(new_job->id.size()), 40));
+
+    const RecvBufferStats buff_stats = this->GetRecvBufferStats();
+    logger.template Log<LogType::Info>(
+        "Receive buffers: {} in use ({} KB), {} cached", buff_stats.in_use,
+        buff_stats.in_use_bytes / 1024, buff_stats.cached);
+
+    // since the last job
+    logger.template Log<LogType::Info>(
+        "Share pipeline: depth {}, queued: {}, hashing: {}, reply: {}",
+        hashing_pool.Depth(), hashing_pool.queue_latency.ToString(),
+        hashing_pool.hash_latency.ToString(), share_reply_latency.ToString());
+    hashing_pool.queue_latency.Reset();
+    hashing_pool.hash_latency.Reset();
+    share_reply_latency.Reset();
 }
 
 template <StaticConf confs>
-RpcResult StratumServer<confs>::HandleShare(Connection<StratumClient> *con,
-                                            WorkerContextT *wc, ShareT &share)
+std::optional<RpcResult> StratumServer<confs>::HandleShare(
+    Connection<StratumClient> *con, ShareT &share, int64_t req_id)
 {
     const auto cli = con->ptr.get();
     uint64_t time = GetCurrentTimeMs();
@@ -175,11 +268,8 @@ RpcResult StratumServer<confs>::HandleShare(Connection<StratumClient> *con,
     {
         return RpcResult(ResCode::UNAUTHORIZED_WORKER, "Unauthorized worker");
     }
-    FullId authorized_id = authorized_id_opt.value();
 
-    ShareResult share_res;
-    RpcResult rpc_res(ResCode::OK);
-    const std::shared_ptr<JobT> job = job_manager.GetJob(share.job_id);
+    std::shared_ptr<JobT> job = job_tables[con->reactor_id].Get(share.job_id);
 
     if (job == nullptr)
     {
@@ -188,12 +278,85 @@ RpcResult StratumServer<confs>::HandleShare(Connection<StratumClient> *con,
         return RpcResult(ResCode::JOB_NOT_FOUND,
                          "Job not found");  // copy ellision
     }
-    else
+
+    // the share's fields point into the request buffer, everything the
+    // worker needs is copied out here
+    ShareCompletions<ShareTaskT> &completions =
+        share_completions[con->reactor_id];
+    std::unique_ptr<ShareTaskT> task = completions.TakeTask();
+
+    if (!ShareProcessor::Prepare<confs>(task->result, cli,
+                                        task->block_header.data(), job.get(),
+                                        share, time))
+    {
+        stats_manager.AddInvalidShare(cli->stats_it);
+        RpcResult res(task->result.code, std::move(task->result.message));
+        completions.ReturnTask(std::move(task));
+        return res;
+    }
+
+    if constexpr (confs.STRATUM_PROTOCOL == StratumProtocol::CN)
     {
-        ShareProcessor::Process<confs>(share_res, cli, wc, job.get(), share,
-                                       time);
+        task->nonce = share.nonce;
     }
 
+    task->cli = con->ptr;
+    task->conn_handle = con->handle;
+    task->reactor_id = con->reactor_id;
+    task->req_id = req_id;
+    task->reply_slot = con->output.Reserve();
+    task->authorized_id = authorized_id_opt.value();
+    task->job = std::move(job);
+    task->time_ms = time;
+
+    // submitted with the rest of the read's shares in HandleConsumeable
+    completions.read_batch.push_back(task.release());
+    return std::nullopt;
+}
+
+// on a hashing worker's thread
+template <StaticConf confs>
+void StratumServer<confs>::QueueHashedShare(ShareTaskT *task)
+{
+    if (share_completions[task->reactor_id].Push(task))
+    {
+        Reactor<StratumClient> *reactor =
+            this->reactors[task->reactor_id].get();
+        this->Post(reactor, [this, reactor] { DrainHashedShares(reactor); });
+    }
+}
+
+// runs on the reactor's thread
+template <StaticConf confs>
+void StratumServer<confs>::DrainHashedShares(Reactor<StratumClient> *reactor)
+{
+    share_completions[reactor->id].Drain(
+        reactor,
+        [this](ShareTaskT &task, Connection<StratumClient> *conn)
+        {
+            const RpcResult res = FinishShare(task, conn != nullptr);
+            if (conn) this->SendRes(conn, task.reply_slot, task.req_id, res);
+
+            share_reply_latency.Record(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - task.hashed)
+                    .count());
+        },
+        [this](Connection<StratumClient> *conn) { this->Uncork(conn); });
+}
+
+// the worker's stats are gone once it disconnected, the rest still counts
+template <StaticConf confs>
+RpcResult StratumServer<confs>::FinishShare(ShareTaskT &task, bool connected)
+{
+    StratumClient *cli = task.cli.get();
+    const JobT *job = task.job.get();
+    const FullId authorized_id = task.authorized_id;
+    const uint64_t time = task.time_ms;
+    ShareResult &share_res = task.result;
+
+    ShareProcessor::Verify<confs>(share_res, cli, job, time);
+
     if (share_res.code == ResCode::VALID_BLOCK) [[unlikely]]
     {
         std::size_t blockSize = job->block_size * 2;
@@ -202,23 +365,22 @@ RpcResult StratumServer<confs>::HandleShare(Connection<StratumClient> *con,
 
         if constexpr (confs.STRATUM_PROTOCOL == StratumProtocol::ZEC)
         {
-            job->GetBlockHex(blockData, wc->block_header.data());
-        }
-        else if constexpr (confs.STRATUM_PROTOCOL == StratumProtocol::BTC)
-        {
-            job->GetBlockHex(blockData, wc->block_header, cli->extra_nonce_sv,
-                             share.extranonce2);
+            job->GetBlockHex(blockData, task.block_header.data());
         }
         else if constexpr (confs.STRATUM_PROTOCOL == StratumProtocol::CN)
         {
-            job->GetBlockHex(blockData, share.nonce);
+            job->GetBlockHex(blockData, task.nonce);
             // special hash
-            share_res.hash_bytes = job->GetBlockHash(share.nonce);
+            share_res.hash_bytes = job->GetBlockHash(task.nonce);
         }
 
         // submit ASAP
         auto block_hex = std::string_view(blockData.data(), blockSize);
-        block_submitter.TrySubmit(block_hex, httpParser);
+        {
+            std::scoped_lock lock(blocks_mutex);
+            pending_blocks.emplace_back(block_hex);
+        }
+        blocks_cv.notify_one();
 
         logger.template Log<LogType::Info>("Block hex: {}", block_hex);
 
@@ -252,7 +414,10 @@ RpcResult StratumServer<confs>::HandleShare(Connection<StratumClient> *con,
         round_manager.AddRoundSharePPLNS(authorized_id.miner_id,
                                          share_res.difficulty);
 
-        stats_manager.AddValidShare(cli->stats_it, cli->GetDifficulty());
+        if (connected)
+        {
+            stats_manager.AddValidShare(cli->stats_it, cli->GetDifficulty());
+        }
         return RpcResult(ResCode::OK);
     }
     else if (share_res.code == ResCode::VALID_SHARE) [[likely]]
@@ -261,74 +426,128 @@ RpcResult StratumServer<confs>::HandleShare(Connection<StratumClient> *con,
                                     share_res.difficulty);
         round_manager.AddRoundSharePPLNS(authorized_id.miner_id,
                                          cli->GetDifficulty());
-        stats_manager.AddValidShare(cli->stats_it, cli->GetDifficulty());
+        if (connected)
+        {
+            stats_manager.AddValidShare(cli->stats_it, cli->GetDifficulty());
+        }
         return RpcResult(ResCode::OK);
     }
 
-    stats_manager.AddInvalidShare(cli->stats_it);
+    if (connected)
+    {
+        stats_manager.AddInvalidShare(cli->stats_it);
+    }
 
-    return RpcResult(share_res.code, share_res.message);
+    return RpcResult(share_res.code, std::move(share_res.message));
 }
 
-// the shared pointer makes sure the client won't be freed as long as we are
-// processing it
-
 template <StaticConf confs>
-void StratumServer<confs>::HandleConsumeable(connection_it *it)
+void StratumServer<confs>::SubmitBlocks(std::stop_token st)
 {
-    static thread_local WorkerContext<confs.BLOCK_HEADER_SIZE> wc;
-
-    std::shared_ptr<Connection<StratumClient>> conn = *(*it);
+    std::vector<std::string> blocks;
+    while (true)
+    {
+        {
+            std::unique_lock lock(blocks_mutex);
+            // the ones found before stopping are still submitted
+            if (!blocks_cv.wait(lock, st,
+                                [this] { return !pending_blocks.empty(); }))
+            {
+                return;
+            }
+            blocks.swap(pending_blocks);
+        }
 
-    // bigger than 0
-    size_t req_len = 0;
-    size_t next_req_len = 0;
-    const char *last_req_end = nullptr;
-    const char *req_start = nullptr;
-    char *req_end = nullptr;
-    char *buffer = conn->req_buff;
+        for (const std::string &block_hex : blocks)
+        {
+            if (!block_submitter.TrySubmit(block_hex, httpParser))
+            {
+                logger.template Log<LogType::Critical>(
+                    "Failed to submit block: {}", block_hex);
+            }
+        }
+        blocks.clear();
+    }
+}
 
-    req_end = std::strchr(buffer, '\n');
+// the connection is only freed by its own reactor, so it stays valid for as
+// long as we are processing it
+template <StaticConf confs>
+void StratumServer<confs>::HandleConsumeable(Connection<StratumClient> *conn)
+{
+    static thread_local WorkerContext<confs.BLOCK_HEADER_SIZE> wc;
 
     // there can be multiple messages in 1 recv
     // {1}\n{2}\n
-    // strchr(buffer, '{');  // "should" be first char
-    req_start = &buffer[0];
-    while (req_end)
+    FrameStatus status;
+    if (conn->listener == BINARY_LISTENER)
     {
-        req_len = req_end - req_start;
-        HandleReq(conn.get(), &wc, std::string_view(req_start, req_len));
-
-        last_req_end = req_end;
-        req_start = req_end + 1;
-        req_end = std::strchr(req_end + 1, '\n');
+        status = BinaryProtocol::Frame(
+            conn->req_buff, conn->req_start, conn->req_pos,
+            [&](BinaryProtocol::MsgType type, std::string_view payload)
+            { HandleBinaryReq(conn, type, payload); });
     }
-
-    // if we haven't received a full request then don't touch the buffer
-    if (last_req_end)
+    else
     {
-        next_req_len =
-            conn->req_pos - (last_req_end - buffer + 1);  // don't inlucde \n
+        status = FrameLines(conn->req_buff, conn->req_start, conn->req_scan,
+                            conn->req_pos, MAX_REQ_LINE_LEN,
+                            [&](std::string_view req)
+                            { HandleReq(conn, &wc, req); });
+    }
 
-        std::memmove(buffer, last_req_end + 1, next_req_len);
-        buffer[next_req_len] = '\0';
+    share_completions[conn->reactor_id].SubmitReadBatch(hashing_pool);
 
-        conn->req_pos = next_req_len;
-        last_req_end = nullptr;
+    if (status == FrameStatus::LINE_TOO_LONG)
+    {
+        logger.template Log<LogType::Warn>(
+            "Disconnecting client with ip {}, request longer than {} bytes.",
+            conn->ip, MAX_REQ_LINE_LEN);
+        shutdown(conn->sockfd, SHUT_RDWR);
+        conn->req_start = conn->req_pos;
+    }
+    else if (status == FrameStatus::BAD_FRAME)
+    {
+        logger.template Log<LogType::Warn>(
+            "Disconnecting client with ip {}, bad binary frame.", conn->ip);
+        shutdown(conn->sockfd, SHUT_RDWR);
+        conn->req_start = conn->req_pos;
+    }
+
+    // everything consumed, rewind for free instead of compacting
+    if (conn->req_start == conn->req_pos)
+    {
+        conn->req_start = 0;
+        conn->req_scan = 0;
+        conn->req_pos = 0;
     }
 }
 
+// coins without a binary layout of their jobs and shares
 template <StaticConf confs>
-bool StratumServer<confs>::HandleConnected(connection_it *it)
+void StratumServer<confs>::HandleBinaryReq(Connection<StratumClient> *conn,
+                                           BinaryProtocol::MsgType type,
+                                           std::string_view /*payload*/)
 {
-    std::shared_ptr<Connection<StratumClient>> conn = *(*it);
+    logger.template Log<LogType::Warn>(
+        "Disconnecting client with ip {}, no binary protocol for this coin "
+        "(type {}).",
+        conn->ip, static_cast<int>(type));
+    shutdown(conn->sockfd, SHUT_RDWR);
+}
 
+template <StaticConf confs>
+bool StratumServer<confs>::HandleConnected(Connection<StratumClient> *conn)
+{
     conn->ptr = std::make_shared<StratumClient>(
         GetCurrentTimeMs(), coin_config.diff_config.default_diff,
         coin_config.diff_config.target_shares_rate,
         coin_config.diff_config.retarget_interval);
 
-    if (job_manager.GetLastJob() == nullptr)
+    // only touched by the connection's reactor
+    conn->ptr->broadcast_it = broadcast_indexes[conn->reactor_id].emplace(
+        conn->ptr->GetDifficulty(), conn);
+
+    if (job_tables[conn->reactor_id].Last() == nullptr)
     {
         // disconnect if we don't have any jobs to not cause a crash, more
         // efficient to check here than everytime we broadcast a job (there will
@@ -338,21 +557,16 @@ bool StratumServer<confs>::HandleConnected(connection_it *it)
         return false;
     }
 
-    std::unique_lock lock(clients_mutex);
-    clients.try_emplace(conn, 0);
-
     return true;
 }
 
 template <StaticConf confs>
-void StratumServer<confs>::DisconnectClient(
-    const std::shared_ptr<Connection<StratumClient>> conn_ptr)
+void StratumServer<confs>::DisconnectClient(Connection<StratumClient> *conn)
 {
-    stats_manager.PopWorker(conn_ptr->ptr->stats_it);
-    std::unique_lock lock(clients_mutex);
-    clients.erase(conn_ptr);
+    stats_manager.PopWorker(conn->ptr->stats_it);
+    broadcast_indexes[conn->reactor_id].erase(conn->ptr->broadcast_it);
 
-    // auto worker_name = conn_ptr->ptr->GetFullWorkerName();
+    // auto worker_name = conn->ptr->GetFullWorkerName();
     // logger.template Log<LogType::Info>("Stratum worker {} disconnected.",
     //                                    worker_name);
 }
@@ -386,7 +600,10 @@ RpcResult StratumServer<confs>::HandleAuthorize(StratumClient *cli,
                              "Invalid alias name!");
         }
 
-        if (daemon_manager.GetAliasAddress(alias_res, alias, httpParser))
+        // the request's strings are in the reactor's other parser
+        static thread_local simdjson::ondemand::parser alias_parser(
+            HTTP_REQ_ALLOCATE);
+        if (daemon_manager.GetAliasAddress(alias_res, alias, alias_parser))
         {
             address = alias_res.address;
         }
@@ -501,23 +718,21 @@ RpcResult StratumServer<confs>::HandleAuthorize(
 }
 
 template <StaticConf confs>
-bool StratumServer<confs>::HandleTimeout(connection_it *conn,
+bool StratumServer<confs>::HandleTimeout(Connection<StratumClient> *conn,
                                          uint64_t timeout_streak)
 {
-    auto conn_ptr = *(*conn);
-
     logger.template Log<LogType::Info>(
-        "Worker with ip {} has timed out, expiration streak: {}", conn_ptr->ip,
+        "Worker with ip {} has timed out, expiration streak: {}", conn->ip,
         timeout_streak);
 
     // disconnect unauthorized miner after timeout, will call handle
     // disconnected
 
-    if (auto cli = conn_ptr->ptr; !cli->GetHasAuthorized())
+    if (auto cli = conn->ptr.get(); !cli->GetHasAuthorized())
     {
         logger.template Log<LogType::Warn>(
             "Disconnecting worker with ip {}, hasn't authorized.",
-            conn_ptr->ip);
+            conn->ip);
 
         return false;
     }
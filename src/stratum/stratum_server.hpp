@@ -4,11 +4,14 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <vector>
 
@@ -16,10 +19,16 @@
 #include "block_submitter.hpp"
 #include "cn/common/base58.h"
 #include "connection.hpp"
+#include "epoch_prewarmer.hpp"
+#include "hashing_pool.hpp"
 #include "job.hpp"
 #include "job_vrsc.hpp"
 #include "jobs/job_manager.hpp"
+#include "jobs/job_table.hpp"
+#include "latency_histogram.hpp"
+#include "line_framer.hpp"
 #include "logger.hpp"
+#include "mpsc_queue.hpp"
 #include "server.hpp"
 #include "shares/share_processor.hpp"
 #include "static_config/static_config.hpp"
@@ -77,6 +86,149 @@ inline std::string ParseShareParams(std::array<Field, size> fields,
     return std::string{};
 }
 
+template <typename JobT>
+struct JobBroadcast
+{
+    JobBroadcast(std::shared_ptr<JobT> job, uint32_t reactor_count)
+        : job(std::move(job)),
+          start(std::chrono::steady_clock::now()),
+          reactors_left(reactor_count)
+    {
+    }
+
+    const std::shared_ptr<JobT> job;
+    const std::chrono::steady_clock::time_point start;
+    std::atomic<uint32_t> reactors_left;
+    // new job to notify sent, per miner
+    LatencyHistogram latency;
+};
+
+// a submitted share on its way from the reactor, through a hashing worker and
+// back to the reactor for the reply
+template <StaticConf confs>
+struct ShareTask : MpscNode
+{
+    using JobT = Job<confs.STRATUM_PROTOCOL>;
+
+    // keeps the client alive if it disconnects meanwhile, a found block must
+    // still be submitted
+    std::shared_ptr<StratumClient> cli;
+    ConnectionHandle conn_handle;
+    uint32_t reactor_id;
+    int64_t req_id;
+    // where the reply goes in the connection's output, after the replies to
+    // the requests before it
+    ReplySlot reply_slot;
+    FullId authorized_id;
+    std::shared_ptr<JobT> job;
+    uint64_t time_ms;
+    uint64_t nonce = 0;
+    std::array<uint8_t, confs.BLOCK_HEADER_SIZE> block_header;
+    ShareResult result;
+
+    std::chrono::steady_clock::time_point queued;
+    std::chrono::steady_clock::time_point hashed;
+};
+
+struct HashingContext
+{
+    CVerusHashV2Batch hasher{SOLUTION_VERUSHHASH_V2_2};
+};
+
+// hashed shares waiting for their reactor, one per reactor
+template <typename TaskT>
+struct ShareCompletions
+{
+    // replied tasks kept for the next shares, so a submit doesn't allocate
+    static constexpr size_t MAX_SPARE_TASKS = 256;
+
+    MpscQueue<TaskT> queue;
+    // a drain task is posted to the reactor and hasn't started yet
+    std::atomic<bool> drain_posted{false};
+
+    // reactor only
+    std::vector<std::unique_ptr<TaskT>> spare_tasks;
+    // prepared while handling a read, submitted together once it's framed
+    std::vector<TaskT*> read_batch;
+    // corked by the current drain, so each gets its replies in one write
+    std::vector<Connection<StratumClient>*> corked;
+
+    std::unique_ptr<TaskT> TakeTask()
+    {
+        if (spare_tasks.empty()) return std::make_unique<TaskT>();
+
+        std::unique_ptr<TaskT> task = std::move(spare_tasks.back());
+        spare_tasks.pop_back();
+        return task;
+    }
+
+    void ReturnTask(std::unique_ptr<TaskT> task)
+    {
+        if (spare_tasks.size() == MAX_SPARE_TASKS) return;
+
+        // not keeping a disconnected client or an old job alive
+        task->cli.reset();
+        task->job.reset();
+        task->result.message.clear();
+        spare_tasks.push_back(std::move(task));
+    }
+
+    // a pipelined burst of submits is hashed together by one worker
+    template <typename PoolT>
+    void SubmitReadBatch(PoolT& pool)
+    {
+        constexpr size_t max_batch = PoolT::MAX_BATCH;
+        for (size_t i = 0; i < read_batch.size(); i += max_batch)
+        {
+            pool.Submit(read_batch.data() + i,
+                        std::min(read_batch.size() - i, max_batch));
+        }
+        read_batch.clear();
+    }
+
+    // on a hashing worker's thread, true if the reactor has to be posted a
+    // drain. one wake up for however many shares come back before the
+    // reactor gets to them
+    bool Push(TaskT* task)
+    {
+        queue.Push(task);
+        return !drain_posted.exchange(true, std::memory_order_acq_rel);
+    }
+
+    // on the reactor's thread. finish(task, conn) judges and replies to a
+    // hashed share, conn is null if it disconnected while its share was
+    // hashing. the replies of a connection are corked until the drain is
+    // done, so they go out in one write
+    template <typename FinishFn, typename UncorkFn>
+    void Drain(Reactor<StratumClient>* reactor, FinishFn&& finish,
+               UncorkFn&& uncork)
+    {
+        // cleared first, a share pushed from now on posts another drain
+        drain_posted.exchange(false, std::memory_order_acq_rel);
+
+        while (TaskT* raw_task = queue.Pop())
+        {
+            std::unique_ptr<TaskT> task(raw_task);
+            Connection<StratumClient>* conn =
+                reactor->connections.Get(task->conn_handle);
+
+            if (conn && !conn->output.IsCorked())
+            {
+                conn->output.Cork();
+                corked.push_back(conn);
+            }
+            finish(*task, conn);
+            ReturnTask(std::move(task));
+        }
+
+        for (Connection<StratumClient>* conn : corked)
+        {
+            uncork(conn);
+        }
+        corked.clear();
+    }
+};
+
 template <StaticConf confs>
 class StratumServer : public StratumBase, public StratumConstants
 {
@@ -86,12 +238,17 @@ class StratumServer : public StratumBase, public StratumConstants
     using WorkerContextT = WorkerContext<confs.BLOCK_HEADER_SIZE>;
     using JobT = Job<confs.STRATUM_PROTOCOL>;
     using ShareT = StratumShareT<confs.STRATUM_PROTOCOL>;
+    using ShareTaskT = ShareTask<confs>;
+    // vrsc job ids count up, zano's are the template hash
+    using JobTableT =
+        JobTable<JobT, confs.STRATUM_PROTOCOL != StratumProtocol::CN>;
 
    private:
     static constexpr std::string_view field_str_stratum = "StratumServer";
     const Logger logger{field_str_stratum};
 
     std::jthread stats_thread;
+    // only used by block_thread
     simdjson::ondemand::parser httpParser =
         simdjson::ondemand::parser(HTTP_REQ_ALLOCATE);
 
@@ -99,10 +256,30 @@ class StratumServer : public StratumBase, public StratumConstants
     JobManager<JobT, confs.COIN_SYMBOL> job_manager;
     DaemonManagerT<confs.COIN_SYMBOL> daemon_manager;
     BlockSubmitter<confs.COIN_SYMBOL> block_submitter;
+    // found blocks go to the daemon from their own thread, a reactor never
+    // waits on its reply
+    std::mutex blocks_mutex;
+    std::condition_variable_any blocks_cv;
+    std::vector<std::string> pending_blocks;
+    std::jthread block_thread;
     StatsManager stats_manager;
+    // one per reactor, indexed by reactor id
+    std::vector<BroadcastIndex> broadcast_indexes;
+    std::vector<JobTableT> job_tables;
+    std::vector<ShareCompletions<ShareTaskT>> share_completions;
+    // hashed -> replied
+    LatencyHistogram share_reply_latency;
+    // progpow only
+    EpochPrewarmer epoch_prewarmer;
+    // last, so the workers stop before anything they call into is destroyed
+    HashingPool<ShareTaskT, HashingContext> hashing_pool;
 
     virtual void HandleReq(Connection<StratumClient>* conn, WorkerContextT* wc,
                            std::string_view req) = 0;
+    // a frame from the binary protocol's port
+    virtual void HandleBinaryReq(Connection<StratumClient>* conn,
+                                 BinaryProtocol::MsgType type,
+                                 std::string_view payload);
 
     virtual RpcResult HandleAuthorize(StratumClient* cli,
                                       std::string_view miner,
@@ -113,20 +290,28 @@ class StratumServer : public StratumBase, public StratumConstants
     void HandleBlockNotify() override;
     void HandleNewJob() override;
     void HandleNewJob(const std::shared_ptr<JobT> new_job);
+    void BroadcastToReactor(Reactor<StratumClient>* reactor,
+                            JobBroadcast<JobT>* broadcast);
 
-    RpcResult HandleShare(Connection<StratumClient>* con, WorkerContextT* wc,
-                          ShareT& share);
+    // nullopt once the share is queued for hashing, the reply is sent when
+    // it's back
+    std::optional<RpcResult> HandleShare(Connection<StratumClient>* con,
+                                         ShareT& share, int64_t req_id);
+    void QueueHashedShare(ShareTaskT* task);
+    void DrainHashedShares(Reactor<StratumClient>* reactor);
+    RpcResult FinishShare(ShareTaskT& task, bool connected);
+    void SubmitBlocks(std::stop_token st);
 
     virtual void UpdateDifficulty(Connection<StratumClient>* conn) = 0;
 
     virtual void BroadcastJob(Connection<StratumClient>* conn, double diff,
                               const JobT* job) const = 0;
-    void HandleConsumeable(connection_it* conn) override;
-    bool HandleConnected(connection_it* conn) override;
-    bool HandleTimeout(connection_it* conn, uint64_t timeout_streak) override;
+    void HandleConsumeable(Connection<StratumClient>* conn) override;
+    bool HandleConnected(Connection<StratumClient>* conn) override;
+    bool HandleTimeout(Connection<StratumClient>* conn,
+                       uint64_t timeout_streak) override;
 
-    void DisconnectClient(
-        const std::shared_ptr<Connection<StratumClient>> conn_ptr) override;
+    void DisconnectClient(Connection<StratumClient>* conn) override;
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,44 @@
 #include "stratum_server_base.hpp"
 
+static uint32_t GetReactorCount(const CoinConfig &conf)
+{
+    // 0 = one reactor per core
+    if (conf.reactor_threads == 0)
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return conf.reactor_threads;
+}
+
+static IoEngine GetIoEngine(const CoinConfig &conf)
+{
+    if (conf.io_engine == "io_uring")
+    {
+        return IoEngine::IO_URING;
+    }
+    else if (conf.io_engine.empty() || conf.io_engine == "epoll")
+    {
+        return IoEngine::EPOLL;
+    }
+
+    throw std::invalid_argument(
+        fmt::format("Unknown io engine: {}", conf.io_engine));
+}
+
+// indexed by JSON_LISTENER / BINARY_LISTENER / TLS_LISTENER, a port of 0
+// isn't listened on
+static std::vector<ListenPort> GetListenPorts(const CoinConfig &conf)
+{
+    return {ListenPort{conf.stratum_port}, ListenPort{conf.binary_port},
+            ListenPort{conf.tls_port, true}};
+}
+
 StratumBase::StratumBase(CoinConfig &&conf)
-    : Server<StratumClient>(conf.stratum_port, static_cast<int>(60.0 / conf.diff_config.target_shares_rate * 2)),
+    : Server<StratumClient>(GetListenPorts(conf), static_cast<int>(60.0 / conf.diff_config.target_shares_rate * 2),
+                            GetReactorCount(conf),
+                            static_cast<uint64_t>(conf.socket_send_high_water_kb) * 1024,
+                            GetIoEngine(conf),
+                            TlsFiles{conf.tls_cert_file, conf.tls_key_file}),
       coin_config(std::move(conf)),
       persistence_layer(coin_config),
       round_manager(persistence_layer, "pow"),
@@ -36,14 +73,15 @@ void StratumBase::Stop() noexcept
     }
 }
 
-void StratumBase::ServiceSockets(std::stop_token st)
+void StratumBase::ServiceSockets(std::stop_token st,
+                                 Reactor<StratumClient> *reactor)
 {
-    logger.Log<LogType::Info>("Starting servicing sockets on thread {}",
+    logger.Log<LogType::Info>("Starting reactor {} on thread {}", reactor->id,
                               gettid());
 
     while (!st.stop_requested())
     {
-        Service();
+        Service(reactor);
     }
 
     logger.Log<LogType::Info>("Stopped servicing sockets on thread {}",
@@ -52,14 +90,24 @@ void StratumBase::ServiceSockets(std::stop_token st)
 
 void StratumBase::Listen()
 {
-    const auto worker_amount = 2;
-    // const auto worker_amount = std::thread::hardware_concurrency();
-    processing_threads.reserve(worker_amount);
+    const auto core_count = std::max(std::thread::hardware_concurrency(), 1u);
+    processing_threads.reserve(reactors.size());
 
-    for (auto i = 0; i < worker_amount; i++)
+    for (auto &reactor : reactors)
     {
-        processing_threads.emplace_back(
-            std::bind_front(&StratumBase::ServiceSockets, this));
+        auto &thr = processing_threads.emplace_back(
+            std::bind_front(&StratumBase::ServiceSockets, this), reactor.get());
+
+        // keep each reactor (and its connections) on its own core
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(reactor->id % core_count, &cpuset);
+        if (pthread_setaffinity_np(thr.native_handle(), sizeof(cpuset),
+                                   &cpuset) != 0)
+        {
+            logger.Log<LogType::Warn>("Failed to pin reactor {} to core {}",
+                                      reactor->id, reactor->id % core_count);
+        }
     }
 
     HandleNewJob();
@@ -107,8 +155,7 @@ void StratumBase::HandleControlCommand(ControlCommands cmd, const char *buff)
     }
 }
 
-void StratumBase::HandleDisconnected(connection_it *conn)
+void StratumBase::HandleDisconnected(Connection<StratumClient> *conn)
 {
-    auto conn_ptr = *(*conn);
-    DisconnectClient(conn_ptr);
+    DisconnectClient(conn);
 }
\ No newline at end of file
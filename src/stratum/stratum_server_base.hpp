@@ -1,11 +1,13 @@
 #ifndef STRATUM_SERVER_BASE_HPP_
 #define STRATUM_SERVER_BASE_HPP_
+#include "binary_protocol.hpp"
 #include "control_server.hpp"
 #include "logger.hpp"
 #include "redis_manager.hpp"
 #include "server.hpp"
 #include "share.hpp"
 #include "stats_manager.hpp"
+#include "stratum_reply.hpp"
 
 class StratumBase : public Server<StratumClient>
 {
@@ -16,59 +18,42 @@ class StratumBase : public Server<StratumClient>
     void Listen();
 
    protected:
+    // Connection::listener of the json line, the binary protocol and the
+    // json line over tls ports
+    static constexpr uint8_t JSON_LISTENER = 0;
+    static constexpr uint8_t BINARY_LISTENER = 1;
+    static constexpr uint8_t TLS_LISTENER = 2;
+
     const CoinConfig coin_config;
     PersistenceLayer persistence_layer;
     RoundManager round_manager;
 
-    // O(log n) delete + insert
-    // saving the pointer in epoll gives us O(1) access!
-    // allows us to sort connections by hashrate to minimize loss
-    std::map<std::shared_ptr<Connection<StratumClient>>, double> clients;
-    std::shared_mutex clients_mutex;
-
     virtual void HandleBlockNotify() = 0;
     virtual void HandleNewJob() = 0;
-    virtual void DisconnectClient(
-        const std::shared_ptr<Connection<StratumClient>> conn_ptr) = 0;
+    virtual void DisconnectClient(Connection<StratumClient>* conn) = 0;
 
     inline std::stop_token GetStopToken() const { return control_thread.get_stop_token(); }
-    inline std::size_t SendRaw(int sock, std::string_view msg) const
+    inline void SendRaw(Connection<StratumClient>* conn,
+                        std::string_view msg) const
     {
-        // dont send sigpipe
-        auto res = send(sock, msg.data(), msg.size(), MSG_NOSIGNAL);
-
-        if (res == -1)
-        {
-            logger.Log<LogType::Error>(
-                "Failed to send on sock fd {}, errno: {} -> {}", sock, errno,
-                std::strerror(errno));
-        }
-
-        return res;
+        // queued if the socket is full, never blocks the reactor
+        Send(conn, msg);
     }
 
     //TODO: have without jsonrpc
-    inline void SendRes(int sock, int64_t req_id, const RpcResult& res) const
+    inline void SendRes(Connection<StratumClient>* conn, int64_t req_id,
+                        const RpcResult& res) const
     {
-        std::string str;
-
-        if (res.code == ResCode::OK)
-        {
-            str = fmt::format(
-                "{{\"id\":{},\"jsonrpc\":\"2.0\",\"error\":null,\"result\":{}}}"
-                "\n",
-                req_id, res.msg);
-        }
-        else
-        {
-            str = fmt::format(
-                "{{\"id\":{},\"jsonrpc\":\"2.0\",\"result\":"
-                "null,\"error\":[{},"
-                "\"{}\",null]}}\n",
-                req_id, (int)res.code, res.msg);
-        }
+        EncodeRes(conn, req_id, res,
+                  [&](std::string_view msg) { SendRaw(conn, msg); });
+    }
 
-        SendRaw(sock, str);
+    // a reply whose place was reserved when its request came in
+    inline void SendRes(Connection<StratumClient>* conn, ReplySlot slot,
+                        int64_t req_id, const RpcResult& res) const
+    {
+        EncodeRes(conn, req_id, res,
+                  [&](std::string_view msg) { Send(conn, slot, msg); });
     }
 
    private:
@@ -77,17 +62,43 @@ class StratumBase : public Server<StratumClient>
 
     std::vector<std::jthread> processing_threads;
 
+    template <typename SendFn>
+    static void EncodeRes(const Connection<StratumClient>* conn,
+                          int64_t req_id, const RpcResult& res, SendFn&& send)
+    {
+        const std::string_view msg = res.Msg();
+
+        // the only replies binary connections get from here are to their
+        // submits, req_id is the share's sequence number
+        if (conn->listener == BINARY_LISTENER)
+        {
+            const auto sequence = static_cast<uint32_t>(req_id);
+            char buff[BinaryProtocol::SubmitError::MAX_SIZE];
+            const size_t len =
+                res.code == ResCode::OK
+                    ? BinaryProtocol::Encode(
+                          buff, BinaryProtocol::SubmitSuccess{sequence})
+                    : BinaryProtocol::Encode(
+                          buff, BinaryProtocol::SubmitError{sequence, msg});
+            send(std::string_view(buff, len));
+            return;
+        }
+
+        StratumReply::EncodeTo(req_id, res.code, msg, send);
+    }
+
     ControlServer control_server;
     std::jthread control_thread;
 
-    void ServiceSockets(std::stop_token st);
+    void ServiceSockets(std::stop_token st, Reactor<StratumClient>* reactor);
     void HandleControlCommands(std::stop_token st);
     void HandleControlCommand(ControlCommands cmd, const char* buff);
 
-    virtual void HandleConsumeable(connection_it* conn) = 0;
-    virtual bool HandleConnected(connection_it* conn) = 0;
-    virtual bool HandleTimeout(connection_it* conn, uint64_t timeout_streak) = 0;
-    void HandleDisconnected(connection_it* conn) override;
+    virtual void HandleConsumeable(Connection<StratumClient>* conn) = 0;
+    virtual bool HandleConnected(Connection<StratumClient>* conn) = 0;
+    virtual bool HandleTimeout(Connection<StratumClient>* conn,
+                               uint64_t timeout_streak) = 0;
+    void HandleDisconnected(Connection<StratumClient>* conn) override;
 };
 
 #endif
\ No newline at end of file
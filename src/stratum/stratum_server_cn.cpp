@@ -9,8 +9,20 @@ void StratumServerCn<confs>::HandleReq(Connection<StratumClient> *conn,
                                        WorkerContextT *wc, std::string_view req)
 {
     using namespace std::string_view_literals;
+
+    // submits in the layout miners send skip the json parser
+    if (ScannedSubmit<SUBMIT_PARAMS> submit;
+        SubmitScanner::Scan(req, "eth_submitWork", SUBMIT_PARAM_SIZES,
+                            submit) &&
+        submit.worker)
+    {
+        std::optional<RpcResult> submit_res =
+            HandleSubmit(conn, submit.params, *submit.worker, submit.id);
+        if (submit_res) this->SendRes(conn, submit.id, *submit_res);
+        return;
+    }
+
     int64_t id = 0;
-    const int sock = conn->sockfd;
     const auto cli = conn->ptr.get();
 
     std::string_view worker;
@@ -43,7 +55,7 @@ void StratumServerCn<confs>::HandleReq(Connection<StratumClient> *conn,
     }
     catch (const simdjson::simdjson_error &err)
     {
-        this->SendRes(sock, id, RpcResult(ResCode::UNKNOWN, "Bad request"));
+        this->SendRes(conn, id, RpcResult(ResCode::UNKNOWN, "Bad request"));
         logger.template Log<LogType::Error>(
             "Request JSON parse error: {}\nRequest: {}\n", err.what(), req);
         return;
@@ -53,12 +65,15 @@ void StratumServerCn<confs>::HandleReq(Connection<StratumClient> *conn,
 
     if (is_submit_work)
     {
-        res = HandleSubmit(conn, wc, params, worker);
+        std::optional<RpcResult> submit_res =
+            HandleSubmit(conn, params, worker, id);
+        if (!submit_res) return;
+        res = std::move(*submit_res);
     }
     else if (method == "eth_getWork")
     {
-        std::shared_ptr<JobCryptoNote> last_job =
-            this->job_manager.GetLastJob();
+        const std::shared_ptr<JobCryptoNote> &last_job =
+            this->job_tables[conn->reactor_id].Last();
         this->BroadcastJob(conn, last_job.get(), id);
     }
     // eth_submitLogin
@@ -73,28 +88,22 @@ void StratumServerCn<confs>::HandleReq(Connection<StratumClient> *conn,
                                            method);
     }
 
-    this->SendRes(sock, id, res);
+    this->SendRes(conn, id, res);
 }
 
 template <StaticConf confs>
-RpcResult StratumServerCn<confs>::HandleSubmit(
-    Connection<StratumClient> *con, WorkerContextT *wc,
-    simdjson::ondemand::array &params, std::string_view worker)
+std::optional<RpcResult> StratumServerCn<confs>::HandleSubmit(
+    Connection<StratumClient> *con, simdjson::ondemand::array &params,
+    std::string_view worker, int64_t req_id)
 {
     using namespace simdjson;
     using namespace std::string_view_literals;
 
-    // parsing takes 0-1 us
-    ShareCn share;
-    share.worker = worker;
-
-    std::string_view nonce_sv;
-    std::array<Field, 3> fields{{
-        Field{"nonce"sv, &nonce_sv, sizeof(share.nonce) * 2 + 2},
-        Field{"header pow"sv, &share.job_id,
-              confs.BLOCK_HASH_SIZE * 2 + 2},
-        Field{"mix digest"sv, &share.mix_digest,
-              confs.BLOCK_HASH_SIZE * 2 + 2},
+    SubmitParams values;
+    std::array<Field, SUBMIT_PARAMS> fields{{
+        Field{"nonce"sv, &values[0], SUBMIT_PARAM_SIZES[0]},
+        Field{"header pow"sv, &values[1], SUBMIT_PARAM_SIZES[1]},
+        Field{"mix digest"sv, &values[2], SUBMIT_PARAM_SIZES[2]},
     }};
 
     if (std::string parse_err = ParseShareParams(fields, params);
@@ -104,32 +113,47 @@ RpcResult StratumServerCn<confs>::HandleSubmit(
                          "Failed to parse share: " + parse_err);
     }
 
-    share.job_id =
-        share.job_id.substr(2);  // remove the hex prefix as we don't save it.
-    nonce_sv = nonce_sv.substr(2);
+    return HandleSubmit(con, values, worker, req_id);
+}
+
+template <StaticConf confs>
+std::optional<RpcResult> StratumServerCn<confs>::HandleSubmit(
+    Connection<StratumClient> *con, const SubmitParams &params,
+    std::string_view worker, int64_t req_id)
+{
+    // parsing takes 0-1 us
+    ShareCn share;
+    share.worker = worker;
+
+    // remove the hex prefixes as we don't save them.
+    share.job_id = params[1].substr(2);
+    share.mix_digest = params[2];
+    const std::string_view nonce_sv = params[0].substr(2);
 
     std::from_chars(nonce_sv.data(), nonce_sv.data() + nonce_sv.size(),
                     share.nonce, 16);
     share.nonce = bswap_64(share.nonce);
 
-    return this->HandleShare(con, wc, share);
+    return this->HandleShare(con, share, req_id);
 }
 
 template <StaticConf confs>
 void StratumServerCn<confs>::BroadcastJob(Connection<StratumClient> *conn,
                                           const JobT *job, int64_t id) const
 {
-    std::string msg =
-        job->template GetWorkMessage<confs>(conn->ptr->GetDifficulty(), id);
-    this->SendRaw(conn->sockfd, msg);
+    char buff[JobT::MAX_WORK_MESSAGE_SIZE];
+    const size_t len = job->template GetWorkMessage<confs>(
+        buff, conn->ptr->GetDifficulty(), id);
+    this->SendRaw(conn, std::string_view(buff, len));
 }
 
 template <StaticConf confs>
 void StratumServerCn<confs>::BroadcastJob(Connection<StratumClient> *conn,
                                           double diff, const JobT *job) const
 {
-    std::string msg = job->template GetWorkMessage<confs>(diff);
-    this->SendRaw(conn->sockfd, msg);
+    char buff[JobT::MAX_WORK_MESSAGE_SIZE];
+    const size_t len = job->template GetWorkMessage<confs>(buff, diff);
+    this->SendRaw(conn, std::string_view(buff, len));
 }
 
 template <StaticConf confs>
@@ -8,6 +8,7 @@
 #include "share.hpp"
 #include "static_config.hpp"
 #include "stratum_server.hpp"
+#include "submit_scanner.hpp"
 
 template <StaticConf confs>
 class StratumServerCn : public StratumServer<confs>
@@ -29,11 +30,24 @@ class StratumServerCn : public StratumServer<confs>
                               simdjson::ondemand::array& params,
                               std::string_view worker);
 
+    // nonce, header pow, mix digest, all 0x prefixed
+    static constexpr size_t SUBMIT_PARAMS = 3;
+    static constexpr std::array<size_t, SUBMIT_PARAMS> SUBMIT_PARAM_SIZES{
+        sizeof(ShareCn::nonce) * 2 + 2, confs.BLOCK_HASH_SIZE * 2 + 2,
+        confs.BLOCK_HASH_SIZE * 2 + 2};
+    using SubmitParams = std::array<std::string_view, SUBMIT_PARAMS>;
+
     RpcResult HandleSubscribe(StratumClient* cli,
                               simdjson::ondemand::array& params) const;
-    RpcResult HandleSubmit(Connection<StratumClient>* con, WorkerContextT* wc,
-                           simdjson::ondemand::array& params,
-                           std::string_view worker);
+    // nullopt if queued for hashing (replied to later)
+    std::optional<RpcResult> HandleSubmit(Connection<StratumClient>* con,
+                                          simdjson::ondemand::array& params,
+                                          std::string_view worker,
+                                          int64_t req_id);
+    std::optional<RpcResult> HandleSubmit(Connection<StratumClient>* con,
+                                          const SubmitParams& params,
+                                          std::string_view worker,
+                                          int64_t req_id);
 
     void HandleReq(Connection<StratumClient>* conn, WorkerContextT* wc,
                    std::string_view req) override;
@@ -8,8 +8,17 @@ void StratumServerZec<confs>::HandleReq(Connection<StratumClient> *conn,
                                         WorkerContextT *wc,
                                         std::string_view req)
 {
+    // submits in the layout miners send skip the json parser
+    if (ScannedSubmit<SUBMIT_PARAMS> submit; SubmitScanner::Scan(
+            req, "mining.submit", SUBMIT_PARAM_SIZES, submit))
+    {
+        std::optional<RpcResult> submit_res =
+            HandleSubmit(conn, submit.params, submit.id);
+        if (submit_res) this->SendRes(conn, submit.id, *submit_res);
+        return;
+    }
+
     int64_t id = 0;
-    const int sock = conn->sockfd;
     const auto cli = conn->ptr.get();
 
     std::string_view method;
@@ -28,7 +37,7 @@ void StratumServerZec<confs>::HandleReq(Connection<StratumClient> *conn,
     }
     catch (const simdjson::simdjson_error &err)
     {
-        this->SendRes(sock, id, RpcResult(ResCode::UNKNOWN, "Bad request"));
+        this->SendRes(conn, id, RpcResult(ResCode::UNKNOWN, "Bad request"));
         logger.Log<LogType::Error>(
             "Request JSON parse error: {}\nRequest: {}\n", err.what(), req);
         return;
@@ -38,7 +47,9 @@ void StratumServerZec<confs>::HandleReq(Connection<StratumClient> *conn,
 
     if (method == "mining.submit")
     {
-        res = HandleSubmit(conn, wc, params);
+        std::optional<RpcResult> submit_res = HandleSubmit(conn, params, id);
+        if (!submit_res) return;
+        res = std::move(*submit_res);
     }
     else if (method == "mining.subscribe")
     {
@@ -49,10 +60,12 @@ void StratumServerZec<confs>::HandleReq(Connection<StratumClient> *conn,
         res = this->HandleAuthorize(cli, params);
         if (res.code == ResCode::OK)
         {
-            this->SendRes(sock, id, res);
+            this->SendRes(conn, id, res);
             UpdateDifficulty(conn);
 
-            const std::shared_ptr<JobT> job = this->job_manager.GetLastJob();
+            // the reactor's, the manager's may not have reached it yet
+            const std::shared_ptr<JobT> &job =
+                this->job_tables[conn->reactor_id].Last();
 
             this->BroadcastJob(conn, 0.0, job.get());
             return;
@@ -64,7 +77,7 @@ void StratumServerZec<confs>::HandleReq(Connection<StratumClient> *conn,
         logger.Log<LogType::Warn>("Unknown request method: {}", method);
     }
 
-    this->SendRes(sock, id, res);
+    this->SendRes(conn, id, res);
 }
 
 // https://zips.z.cash/zip-0301#mining-subscribe
@@ -202,24 +215,20 @@ RpcResult StratumServerZec<confs>::HandleSubscribe(
 
 // https://zips.z.cash/zip-0301#mining-submit
 template <StaticConf confs>
-RpcResult StratumServerZec<confs>::HandleSubmit(
-    Connection<StratumClient> *con, WorkerContextT *wc,
-    simdjson::ondemand::array &params)
+std::optional<RpcResult> StratumServerZec<confs>::HandleSubmit(
+    Connection<StratumClient> *con, simdjson::ondemand::array &params,
+    int64_t req_id)
 {
     using namespace simdjson;
     using namespace std::string_view_literals;
 
-    std::string_view time_sv;
-    ShareZec share;
-
-    std::string_view nonce_sv;
-    std::array<Field, 5> fields{{
-        Field{"worker"sv, &share.worker, 0},
-        Field{"job id"sv, &share.job_id, this->JOBID_SIZE * 2},
-        Field{"time"sv, &time_sv, sizeof(share.time) * 2},
-        Field{"nonce2"sv, &share.nonce2_sv, EXTRANONCE2_SIZE * 2},
-        Field{"solution"sv, &share.solution,
-              (SOLUTION_SIZE + SOLUTION_LENGTH_SIZE) * 2}
+    SubmitParams values;
+    std::array<Field, SUBMIT_PARAMS> fields{{
+        Field{"worker"sv, &values[0], SUBMIT_PARAM_SIZES[0]},
+        Field{"job id"sv, &values[1], SUBMIT_PARAM_SIZES[1]},
+        Field{"time"sv, &values[2], SUBMIT_PARAM_SIZES[2]},
+        Field{"nonce2"sv, &values[3], SUBMIT_PARAM_SIZES[3]},
+        Field{"solution"sv, &values[4], SUBMIT_PARAM_SIZES[4]}
     }};
 
     if (std::string parse_err = ParseShareParams(fields, params);
@@ -229,24 +238,201 @@ RpcResult StratumServerZec<confs>::HandleSubmit(
                          "Failed to parse share: " + parse_err);
     }
 
+    return HandleSubmit(con, values, req_id);
+}
+
+template <StaticConf confs>
+std::optional<RpcResult> StratumServerZec<confs>::HandleSubmit(
+    Connection<StratumClient> *con, const SubmitParams &params,
+    int64_t req_id)
+{
+    ShareZec share;
+    share.worker = params[0];
+    share.job_id = params[1];
+    share.nonce2_sv = params[3];
+    share.solution = params[4];
+
+    const std::string_view time_sv = params[2];
     std::from_chars(time_sv.data(), time_sv.data() + time_sv.size(), share.time, 16);
     share.time = bswap_32(share.time);
 
-    return this->HandleShare(con, wc, share);
+    return this->HandleShare(con, share, req_id);
+}
+
+template <StaticConf confs>
+void StratumServerZec<confs>::HandleBinaryReq(Connection<StratumClient> *conn,
+                                              BinaryProtocol::MsgType type,
+                                              std::string_view payload)
+{
+    using MsgType = BinaryProtocol::MsgType;
+
+    bool ok = false;
+    switch (type)
+    {
+        case MsgType::SUBMIT_SHARES_STANDARD:
+            ok = HandleBinarySubmit(conn, payload);
+            break;
+        case MsgType::OPEN_STANDARD_MINING_CHANNEL:
+            ok = HandleOpenChannel(conn, payload);
+            break;
+        case MsgType::SETUP_CONNECTION:
+            ok = HandleSetupConnection(conn, payload);
+            break;
+        default:
+            break;
+    }
+
+    if (!ok)
+    {
+        logger.Log<LogType::Warn>(
+            "Disconnecting client with ip {}, bad binary message (type {}).",
+            conn->ip, static_cast<int>(type));
+        shutdown(conn->sockfd, SHUT_RDWR);
+    }
+}
+
+template <StaticConf confs>
+bool StratumServerZec<confs>::HandleSetupConnection(
+    Connection<StratumClient> *conn, std::string_view payload) const
+{
+    BinaryProtocol::SetupConnection req;
+    if (!BinaryProtocol::Decode(payload, req)) return false;
+
+    char buff[BinaryProtocol::SetupConnectionError::MAX_SIZE];
+    size_t len;
+    if (req.min_version > BinaryProtocol::VERSION ||
+        req.max_version < BinaryProtocol::VERSION)
+    {
+        len = BinaryProtocol::Encode(
+            buff, BinaryProtocol::SetupConnectionError{
+                      .flags = 0, .error = "unsupported-protocol"});
+    }
+    else
+    {
+        len = BinaryProtocol::Encode(
+            buff, BinaryProtocol::SetupConnectionSuccess{
+                      .used_version = BinaryProtocol::VERSION, .flags = 0});
+        logger.Log<LogType::Info>("binary client set up: {}",
+                                  req.user_agent);
+    }
+
+    this->SendRaw(conn, std::string_view(buff, len));
+    return true;
+}
+
+// mining.authorize and its job
+template <StaticConf confs>
+bool StratumServerZec<confs>::HandleOpenChannel(
+    Connection<StratumClient> *conn, std::string_view payload)
+{
+    BinaryProtocol::OpenChannel req;
+    if (!BinaryProtocol::Decode(payload, req)) return false;
+
+    const auto cli = conn->ptr.get();
+    const auto send_error = [&](std::string_view error)
+    {
+        char buff[BinaryProtocol::OpenChannelError::MAX_SIZE];
+        this->SendRaw(conn, std::string_view(
+                                buff, BinaryProtocol::Encode(
+                                          buff, BinaryProtocol::OpenChannelError{
+                                                    req.request_id, error})));
+    };
+
+    const size_t sep = req.user.find('.');
+    if (cli->GetHasAuthorized())
+    {
+        send_error("Channel already open!");
+        return true;
+    }
+    else if (sep == std::string_view::npos)
+    {
+        send_error("Bad request, bad worker format!");
+        return true;
+    }
+
+    const std::string_view worker = req.user.substr(sep + 1);
+    const RpcResult res =
+        this->HandleAuthorize(cli, req.user.substr(0, sep), worker);
+    if (res.code != ResCode::OK)
+    {
+        send_error(res.Msg());
+        return true;
+    }
+
+    cli->channel_worker = std::string(worker);
+
+    char buff[BinaryProtocol::OpenChannelSuccess::MAX_SIZE];
+    this->SendRaw(
+        conn,
+        std::string_view(
+            buff, BinaryProtocol::Encode(
+                      buff, BinaryProtocol::OpenChannelSuccess{
+                                .request_id = req.request_id,
+                                .target = Target256::FromDiff(
+                                              cli->GetDifficulty())
+                                              .ToBytesLE(),
+                                .extranonce = cli->extra_nonce})));
+
+    const std::shared_ptr<JobT> &job =
+        this->job_tables[conn->reactor_id].Last();
+    this->BroadcastJob(conn, 0.0, job.get());
+    return true;
+}
+
+template <StaticConf confs>
+bool StratumServerZec<confs>::HandleBinarySubmit(
+    Connection<StratumClient> *conn, std::string_view payload)
+{
+    BinaryProtocol::SubmitShare req;
+    if (!BinaryProtocol::Decode(payload, req)) return false;
+
+    // the jobs are looked up by the json's id, the hex of the number
+    char job_id[StratumServer<confs>::JOBID_SIZE * 2];
+    fmt::format_to_n(job_id, sizeof(job_id), "{:08x}", req.job_id);
+
+    ShareZec share;
+    share.worker = conn->ptr->channel_worker;
+    share.job_id = std::string_view(job_id, sizeof(job_id));
+    share.nonce2_sv = req.nonce2;
+    share.solution = req.solution;
+    share.time = req.time;
+    share.raw = true;
+
+    std::optional<RpcResult> res =
+        this->HandleShare(conn, share, req.sequence);
+    if (res) this->SendRes(conn, req.sequence, *res);
+    return true;
 }
 
 template <StaticConf confs>
 void StratumServerZec<confs>::UpdateDifficulty(Connection<StratumClient> *conn)
 {
+    if (conn->listener == this->BINARY_LISTENER)
+    {
+        // sent right before the pending difficulty is activated
+        const StratumClient *cli = conn->ptr.get();
+        const BinaryProtocol::SetTarget msg{
+            Target256::FromDiff(
+                cli->GetPendingDifficulty().value_or(cli->GetDifficulty()))
+                .ToBytesLE()};
+
+        char buff[BinaryProtocol::SetTarget::MAX_SIZE];
+        this->SendRaw(conn,
+                      std::string_view(buff, BinaryProtocol::Encode(buff, msg)));
+        return;
+    }
+
     auto diff_hex = GetDifficultyHex<confs>(conn->ptr->GetDifficulty());
     std::string_view hex_target_sv(diff_hex.data(), diff_hex.size());
 
-    std::string msg = fmt::format(
+    char buff[StratumReply::STACK_SIZE];
+    const auto res = fmt::format_to_n(
+        buff, sizeof(buff),
         "{{\"id\":null,\"method\":\"mining.set_"
         "target\",\"params\":[\"{}\"]}}\n",
         hex_target_sv);
 
-    this->SendRaw(conn->sockfd, msg);
+    this->SendRaw(conn, std::string_view(buff, res.out - buff));
 
     // logger.Log<LogType::Debug>("Set difficulty for {} to {}",
     //                            hex_target_sv);
@@ -256,5 +442,7 @@ template <StaticConf confs>
 void StratumServerZec<confs>::BroadcastJob(Connection<StratumClient> *conn,
                                            double diff, const JobT *job) const
 {
-    this->SendRaw(conn->sockfd, job->notify_msg);
+    this->SendRaw(conn, conn->listener == this->BINARY_LISTENER
+                            ? std::string_view(job->binary_notify_msg)
+                            : std::string_view(job->notify_msg));
 }
\ No newline at end of file
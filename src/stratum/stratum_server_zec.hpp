@@ -3,6 +3,7 @@
 
 #include "stratum_server.hpp"
 #include "stratum_client.hpp"
+#include "submit_scanner.hpp"
 #include "share.hpp"
 #include "constants.hpp"
 #include "config_vrsc.hpp"
@@ -24,13 +25,42 @@ class StratumServerZec : public StratumServer<confs>, public CoinConstantsZec
 
     const Logger logger{field_str_zec};
 
+    // worker, job id, time, nonce2, solution
+    static constexpr size_t SUBMIT_PARAMS = 5;
+    static constexpr std::array<size_t, SUBMIT_PARAMS> SUBMIT_PARAM_SIZES{
+        0, StratumServer<confs>::JOBID_SIZE * 2, sizeof(ShareZec::time) * 2,
+        EXTRANONCE2_SIZE * 2, (SOLUTION_SIZE + SOLUTION_LENGTH_SIZE) * 2};
+    using SubmitParams = std::array<std::string_view, SUBMIT_PARAMS>;
+
+    static_assert(BinaryProtocol::NONCE2_SIZE == EXTRANONCE2_SIZE &&
+                      BinaryProtocol::SOLUTION_FIELD_SIZE ==
+                          SOLUTION_LENGTH_SIZE + SOLUTION_SIZE &&
+                      BinaryProtocol::HEADER_HASH_SIZE == HASH_SIZE,
+                  "The binary protocol's header fields aren't vrsc's");
+
     RpcResult HandleSubscribe(StratumClient* cli,
                               simdjson::ondemand::array& params) const;
-    RpcResult HandleSubmit(Connection<StratumClient>* con, WorkerContextT* wc,
-                           simdjson::ondemand::array& params);
+    // nullopt if queued for hashing (replied to later)
+    std::optional<RpcResult> HandleSubmit(Connection<StratumClient>* con,
+                                          simdjson::ondemand::array& params,
+                                          int64_t req_id);
+    std::optional<RpcResult> HandleSubmit(Connection<StratumClient>* con,
+                                          const SubmitParams& params,
+                                          int64_t req_id);
 
     void HandleReq(Connection<StratumClient>* conn, WorkerContextT* wc,
                    std::string_view req) override;
+
+    void HandleBinaryReq(Connection<StratumClient>* conn,
+                         BinaryProtocol::MsgType type,
+                         std::string_view payload) override;
+    // false if the payload isn't the message
+    bool HandleSetupConnection(Connection<StratumClient>* conn,
+                               std::string_view payload) const;
+    bool HandleOpenChannel(Connection<StratumClient>* conn,
+                           std::string_view payload);
+    bool HandleBinarySubmit(Connection<StratumClient>* conn,
+                            std::string_view payload);
     void UpdateDifficulty(Connection<StratumClient>* conn) override;
 
     void BroadcastJob(Connection<StratumClient>* conn, double diff,
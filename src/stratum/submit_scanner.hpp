@@ -0,0 +1,207 @@
+#ifndef SUBMIT_SCANNER_HPP_
+#define SUBMIT_SCANNER_HPP_
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// a submit request as miners send it: one object of the id, method, params
+// (strings) and optionally jsonrpc and worker (cn) members, in any order
+template <size_t N>
+struct ScannedSubmit
+{
+    int64_t id = 0;
+    std::optional<std::string_view> worker;
+    std::array<std::string_view, N> params;
+};
+
+// a single pass over a submit line instead of simdjson's, without
+// exceptions. it only accepts what it fully understands: any other member,
+// value type, escape, param count or size makes it return false and the
+// request goes through simdjson, which also reports the errors. the views
+// point into req.
+class SubmitScanner
+{
+   public:
+    // sizes of the params, 0 for any
+    template <size_t N>
+    static bool Scan(std::string_view req, std::string_view method,
+                     const std::array<size_t, N>& sizes,
+                     ScannedSubmit<N>& res)
+    {
+        const char* pos = req.data();
+        const char* const end = req.data() + req.size();
+
+        bool has_id = false;
+        bool has_method = false;
+        bool has_params = false;
+
+        if (!Expect(pos, end, '{')) return false;
+
+        do
+        {
+            if (!Expect(pos, end, '"') || pos == end) return false;
+
+            // members told apart by their first letter
+            bool ok;
+            switch (*pos)
+            {
+                case 'i':
+                    ok = !has_id && Name(pos, end, "id") &&
+                         (has_id = ScanInt(pos, end, res.id));
+                    break;
+                case 'm':
+                    ok = !has_method && Name(pos, end, "method") &&
+                         Expect(pos, end, '"') && Match(pos, end, method) &&
+                         (has_method = Match(pos, end, "\""));
+                    break;
+                case 'p':
+                    ok = !has_params && Name(pos, end, "params") &&
+                         (has_params =
+                              ScanParams(pos, end, sizes, res.params));
+                    break;
+                case 'w':
+                {
+                    std::string_view value;
+                    ok = !res.worker && Name(pos, end, "worker") &&
+                         ScanString(pos, end, value);
+                    res.worker = value;
+                    break;
+                }
+                case 'j':
+                {
+                    std::string_view value;
+                    ok = Name(pos, end, "jsonrpc") &&
+                         ScanString(pos, end, value);
+                    break;
+                }
+                default:
+                    return false;
+            }
+
+            if (!ok) return false;
+        } while (Expect(pos, end, ','));
+
+        if (!Expect(pos, end, '}')) return false;
+
+        SkipSpace(pos, end);
+        return pos == end && has_id && has_method && has_params;
+    }
+
+   private:
+    static void SkipSpace(const char*& pos, const char* end)
+    {
+        while (pos != end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+        {
+            pos++;
+        }
+    }
+
+    // the rest of a member's name (after its opening quote) and the colon
+    static bool Name(const char*& pos, const char* end, std::string_view name)
+    {
+        return Match(pos, end, name) && Match(pos, end, "\"") &&
+               Expect(pos, end, ':');
+    }
+
+    // consumes str if it's next, as is (no space skipped within)
+    static bool Match(const char*& pos, const char* end, std::string_view str)
+    {
+        if (static_cast<size_t>(end - pos) < str.size() ||
+            std::memcmp(pos, str.data(), str.size()) != 0)
+        {
+            return false;
+        }
+        pos += str.size();
+        return true;
+    }
+
+    static bool Expect(const char*& pos, const char* end, char c)
+    {
+        SkipSpace(pos, end);
+        if (pos == end || *pos != c) return false;
+        pos++;
+        return true;
+    }
+
+    // the closing quote, or the first escape (escaped strings are left to
+    // simdjson, their view wouldn't be the value). a submit's strings are
+    // mostly short, one call per string beats memchr's for both characters
+    static const char* FindQuoteOrEscape(const char* pos, const char* end)
+    {
+#ifdef __SSE2__
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i escape = _mm_set1_epi8('\\');
+
+        for (; end - pos >= 16; pos += 16)
+        {
+            const __m128i chunk =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const int mask = _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, escape)));
+            if (mask) return pos + __builtin_ctz(mask);
+        }
+#endif
+        for (; pos != end; pos++)
+        {
+            if (*pos == '"' || *pos == '\\') return pos;
+        }
+        return end;
+    }
+
+    static bool ScanString(const char*& pos, const char* end,
+                           std::string_view& res)
+    {
+        if (!Expect(pos, end, '"')) return false;
+
+        const char* close = FindQuoteOrEscape(pos, end);
+        if (close == end || *close != '"') return false;
+
+        res = std::string_view(pos, close - pos);
+        pos = close + 1;
+        return true;
+    }
+
+    static bool ScanInt(const char*& pos, const char* end, int64_t& res)
+    {
+        SkipSpace(pos, end);
+        const auto [ptr, ec] = std::from_chars(pos, end, res);
+        // 1.0 or 1e3 are numbers simdjson wouldn't take as an int64 either
+        if (ec != std::errc() || (ptr != end && (*ptr == '.' || *ptr == 'e' ||
+                                                 *ptr == 'E')))
+        {
+            return false;
+        }
+        pos = ptr;
+        return true;
+    }
+
+    template <size_t N>
+    static bool ScanParams(const char*& pos, const char* end,
+                           const std::array<size_t, N>& sizes,
+                           std::array<std::string_view, N>& res)
+    {
+        if (!Expect(pos, end, '[')) return false;
+
+        for (size_t i = 0; i < N; i++)
+        {
+            if ((i != 0 && !Expect(pos, end, ',')) ||
+                !ScanString(pos, end, res[i]) ||
+                (sizes[i] != 0 && res[i].size() != sizes[i]))
+            {
+                return false;
+            }
+        }
+
+        return Expect(pos, end, ']');
+    }
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef TIMING_WHEEL_HPP_
+#define TIMING_WHEEL_HPP_
+
+#include <time.h>
+
+#include <array>
+#include <cstdint>
+
+// intrusive, lives inside the timed object so scheduling never allocates
+struct TimerNode
+{
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    uint64_t expire_tick = 0;
+    void* data = nullptr;
+
+    bool IsLinked() const { return next != nullptr; }
+};
+
+// hashed timing wheel, (re)scheduling and canceling are O(1) with no syscalls.
+// timers further than a revolution away stay in their slot until their tick
+// comes, single threaded (owned by a reactor).
+template <uint32_t SLOTS>
+class TimingWheel
+{
+    static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of 2");
+
+   public:
+    explicit TimingWheel(uint64_t tick_ms)
+        : tick_ms(tick_ms), current_tick(GetNowMs() / tick_ms)
+    {
+        for (auto& head : slots)
+        {
+            head.prev = &head;
+            head.next = &head;
+        }
+    }
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // monotonic coarse clock is served by the vdso, no syscall
+    static uint64_t GetNowMs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    void Schedule(TimerNode* node, uint64_t delay_ms)
+    {
+        Cancel(node);
+
+        // round up, never fire early
+        uint64_t ticks = (delay_ms + tick_ms - 1) / tick_ms;
+        node->expire_tick = current_tick + (ticks ? ticks : 1);
+
+        Link(&slots[node->expire_tick & (SLOTS - 1)], node);
+    }
+
+    void Cancel(TimerNode* node)
+    {
+        if (!node->IsLinked()) return;
+
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = nullptr;
+        node->next = nullptr;
+    }
+
+    // fires every timer that is due, the callback may reschedule or cancel
+    // any timer (including the fired one)
+    template <typename Func>
+    void Advance(uint64_t now_ms, Func&& on_expire)
+    {
+        const uint64_t now_tick = now_ms / tick_ms;
+
+        while (current_tick < now_tick)
+        {
+            current_tick++;
+            TimerNode* head = &slots[current_tick & (SLOTS - 1)];
+
+            // move the due timers aside first, so rescheduling into this
+            // slot from the callback can't loop
+            TimerNode expired;
+            expired.prev = &expired;
+            expired.next = &expired;
+
+            for (TimerNode* node = head->next; node != head;)
+            {
+                TimerNode* next = node->next;
+                if (node->expire_tick <= current_tick)
+                {
+                    Cancel(node);
+                    Link(&expired, node);
+                }
+                node = next;
+            }
+
+            while (expired.next != &expired)
+            {
+                TimerNode* node = expired.next;
+                Cancel(node);
+                on_expire(node);
+            }
+        }
+    }
+
+    // how long the reactor may sleep before the next tick is due
+    int MsUntilNextTick(uint64_t now_ms) const
+    {
+        const uint64_t next_tick_ms = (current_tick + 1) * tick_ms;
+        return next_tick_ms > now_ms ? static_cast<int>(next_tick_ms - now_ms)
+                                     : 0;
+    }
+
+   private:
+    const uint64_t tick_ms;
+    uint64_t current_tick;
+    std::array<TimerNode, SLOTS> slots;
+
+    static void Link(TimerNode* head, TimerNode* node)
+    {
+        node->prev = head->prev;
+        node->next = head;
+        head->prev->next = node;
+        head->prev = node;
+    }
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifdef WITH_KTLS
+#include "tls_acceptor.hpp"
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <stdexcept>
+
+// what the kernel can encrypt (tls_main.c), openssl's defaults would let a
+// client pick a cipher that leaves the connection in userspace
+static constexpr const char* KTLS_CIPHERS =
+    "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+    "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384:"
+    "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305";
+static constexpr const char* KTLS_CIPHERSUITES =
+    "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:"
+    "TLS_CHACHA20_POLY1305_SHA256";
+
+TlsAcceptor::TlsAcceptor(const TlsFiles& files)
+    : ctx(SSL_CTX_new(TLS_server_method()))
+{
+    if (ctx == nullptr)
+    {
+        throw std::invalid_argument("Failed to create tls context.");
+    }
+
+    // no session tickets: tls 1.3 sends them after the handshake, past the
+    // point the session is freed. no renegotiation for the same reason
+    if (SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION) != 1 ||
+        SSL_CTX_set_cipher_list(ctx, KTLS_CIPHERS) != 1 ||
+        SSL_CTX_set_ciphersuites(ctx, KTLS_CIPHERSUITES) != 1 ||
+        SSL_CTX_set_num_tickets(ctx, 0) != 1)
+    {
+        SSL_CTX_free(ctx);
+        throw std::invalid_argument("Failed to set tls context options.");
+    }
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS | SSL_OP_NO_RENEGOTIATION);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, files.cert_file.c_str()) !=
+            1 ||
+        SSL_CTX_use_PrivateKey_file(ctx, files.key_file.c_str(),
+                                    SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(ctx) != 1)
+    {
+        SSL_CTX_free(ctx);
+        ERR_clear_error();
+        throw std::invalid_argument(
+            fmt::format("Failed to load tls certificate {} with key {}.",
+                        files.cert_file, files.key_file));
+    }
+}
+
+TlsAcceptor::~TlsAcceptor() { SSL_CTX_free(ctx); }
+
+ssl_st* TlsAcceptor::Start(int fd, std::string_view ip) const
+{
+    SSL* ssl = SSL_new(ctx);
+    if (ssl == nullptr)
+    {
+        LogErrors("Failed to create tls session", ip);
+        return nullptr;
+    }
+
+    // the socket bio doesn't close the fd when freed
+    if (SSL_set_fd(ssl, fd) != 1)
+    {
+        LogErrors("Failed to set tls session socket", ip);
+        SSL_free(ssl);
+        return nullptr;
+    }
+
+    SSL_set_accept_state(ssl);
+    return ssl;
+}
+
+TlsAcceptor::HandshakeStatus TlsAcceptor::Continue(ssl_st* ssl,
+                                                   std::string_view ip) const
+{
+    const int res = SSL_do_handshake(ssl);
+
+    if (res != 1)
+    {
+        switch (SSL_get_error(ssl, res))
+        {
+            case SSL_ERROR_WANT_READ:
+            case SSL_ERROR_WANT_WRITE:
+                return HandshakeStatus::PENDING;
+            default:
+                LogErrors("Tls handshake failed", ip);
+                return HandshakeStatus::FAILED;
+        }
+    }
+
+    // openssl turns kTLS on as it switches to the session keys, silently
+    // staying in userspace if the kernel refuses
+    if (!BIO_get_ktls_send(SSL_get_wbio(ssl)) ||
+        !BIO_get_ktls_recv(SSL_get_rbio(ssl)))
+    {
+        logger.Log<LogType::Warn>(
+            "Refusing tls client with ip {}, the kernel didn't take its keys "
+            "(cipher {}, is the tls module loaded?)",
+            ip, SSL_get_cipher_name(ssl));
+        return HandshakeStatus::FAILED;
+    }
+
+    return HandshakeStatus::DONE;
+}
+
+void TlsAcceptor::Release(ssl_st* ssl) const
+{
+    // the socket outlives the session, don't close_notify it
+    SSL_set_quiet_shutdown(ssl, 1);
+    SSL_free(ssl);
+}
+
+void TlsAcceptor::LogErrors(std::string_view what, std::string_view ip) const
+{
+    char err[256] = "unknown error";
+    if (const unsigned long code = ERR_get_error(); code != 0)
+    {
+        ERR_error_string_n(code, err, sizeof(err));
+    }
+    ERR_clear_error();
+
+    logger.Log<LogType::Warn>("{} (ip {}): {}", what, ip, err);
+}
+#endif
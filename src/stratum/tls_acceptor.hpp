@@ -0,0 +1,67 @@
+#ifndef TLS_ACCEPTOR_HPP_
+#define TLS_ACCEPTOR_HPP_
+
+#include <string>
+#include <string_view>
+
+#include "logger.hpp"
+
+// openssl's, only the pointer is kept in the connection
+struct ssl_st;
+
+struct TlsFiles
+{
+    // pem, the certificate may be followed by its chain
+    std::string cert_file;
+    std::string key_file;
+};
+
+#ifdef WITH_KTLS
+struct ssl_ctx_st;
+
+// the handshake of a tls listener's connections. openssl only runs the
+// handshake, the session keys are then handed to the kernel (kTLS, TCP_ULP
+// "tls") and the session is freed: from there on the socket takes plain
+// recv / send of the cleartext and the kernel does the records, so
+// Server<T> reads and writes it as any other connection. a connection whose
+// keys the kernel can't take (no tls module, unsupported cipher) is
+// refused rather than encrypted in userspace.
+// the kernel can't take a record that isn't application data once it has
+// the keys (a tls 1.3 key update, an alert), recv fails with EIO and the
+// connection is dropped. miners don't send either.
+class TlsAcceptor
+{
+   public:
+    enum class HandshakeStatus
+    {
+        // waits for the socket, on either readable or writable
+        PENDING,
+        // the kernel has the keys, Release the session
+        DONE,
+        FAILED
+    };
+
+    // throws std::invalid_argument if the certificate or key can't be used
+    explicit TlsAcceptor(const TlsFiles& files);
+    ~TlsAcceptor();
+
+    TlsAcceptor(const TlsAcceptor&) = delete;
+    TlsAcceptor& operator=(const TlsAcceptor&) = delete;
+
+    // the server side session of a non blocking socket, nullptr on failure
+    ssl_st* Start(int fd, std::string_view ip) const;
+    HandshakeStatus Continue(ssl_st* ssl, std::string_view ip) const;
+    // frees the session without closing the socket or sending an alert
+    void Release(ssl_st* ssl) const;
+
+   private:
+    static constexpr std::string_view field_str = "TlsAcceptor";
+    const Logger logger{field_str};
+
+    ssl_ctx_st* const ctx;
+
+    void LogErrors(std::string_view what, std::string_view ip) const;
+};
+#endif
+
+#endif
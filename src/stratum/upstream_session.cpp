@@ -0,0 +1,495 @@
+#include "upstream_session.hpp"
+
+#include <byteswap.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "line_framer.hpp"
+
+// where a vrsc header's fields are, see Job<ZEC>::GetHeaderData
+static constexpr size_t TIME_POS =
+    Job<StratumProtocol::ZEC>::STATIC_HEADER_SIZE;
+static constexpr size_t NONCE1_POS =
+    TIME_POS + CoinConstantsZec::TIME_SIZE + CoinConstantsZec::BITS_SIZE;
+static constexpr size_t NONCE2_POS =
+    NONCE1_POS + StratumConstants::EXTRANONCE_SIZE;
+static constexpr size_t SOLUTION_POS =
+    NONCE2_POS + CoinConstantsZec::EXTRANONCE2_SIZE;
+
+UpstreamSession::UpstreamSession(uint32_t id, const std::string& host,
+                                 std::string user, Callbacks callbacks)
+    : id(id),
+      addr(host),
+      user(std::move(user)),
+      callbacks(std::move(callbacks)),
+      submit_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      thread(std::bind_front(&UpstreamSession::Run, this))
+{
+    if (submit_fd == -1)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Failed to create eventfd: {} -> {}.", errno, std::strerror(errno)));
+    }
+}
+
+UpstreamSession::~UpstreamSession()
+{
+    // poll times out in time to see it
+    thread.request_stop();
+    thread.join();
+    Disconnect();
+    // nothing submits anymore, whatever is left is dropped
+    TakeSubmits();
+    close(submit_fd);
+}
+
+void UpstreamSession::Run(std::stop_token st)
+{
+    std::mutex wait_mutex;
+    std::condition_variable_any wait_cv;
+    uint32_t delay_s = 1;
+
+    while (!st.stop_requested())
+    {
+        if (Connect())
+        {
+            RunSession(st);
+            // it got going, the pool isn't refusing us
+            if (subscribed) delay_s = 1;
+        }
+        Disconnect();
+        // they were assembled with the lost session's extra nonce
+        TakeSubmits();
+
+        if (st.stop_requested()) break;
+
+        logger.Log<LogType::Warn>(
+            "Session {} lost the pool at {}, reconnecting in {}s", id,
+            addr.ip_str, delay_s);
+
+        std::unique_lock lock(wait_mutex);
+        wait_cv.wait_for(lock, st, std::chrono::seconds(delay_s),
+                         [] { return false; });
+        delay_s = std::min(delay_s * 2, MAX_RECONNECT_DELAY_S);
+    }
+}
+
+bool UpstreamSession::Connect()
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        logger.Log<LogType::Error>("Failed to create socket: {} -> {}", errno,
+                                   std::strerror(errno));
+        return false;
+    }
+
+    sockaddr_in pool_addr{};
+    pool_addr.sin_family = AF_INET;
+    pool_addr.sin_port = addr.port;
+    pool_addr.sin_addr.s_addr = addr.ip;
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&pool_addr),
+                sizeof(pool_addr)) == -1)
+    {
+        logger.Log<LogType::Warn>("Session {} failed to connect to {}:{}: {}",
+                                  id, addr.ip_str, addr.port_original,
+                                  std::strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    // a share is sent the moment it's found. polled along with the
+    // submits, a pool that stops reading never blocks the session
+    const int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    sockfd = fd;
+
+    logger.Log<LogType::Info>("Session {} connected to {}:{}", id,
+                              addr.ip_str, addr.port_original);
+    return true;
+}
+
+void UpstreamSession::Disconnect()
+{
+    if (sockfd != -1)
+    {
+        close(sockfd);
+        sockfd = -1;
+    }
+    subscribed = false;
+    pending_send.clear();
+}
+
+void UpstreamSession::RunSession(std::stop_token st)
+{
+    // pipelined, the replies come in order
+    pending_send = fmt::format(
+        "{{\"id\":{},\"method\":\"mining.subscribe\",\"params\":["
+        "\"SickPool/proxy\",null,\"{}\",{}]}}\n"
+        "{{\"id\":{},\"method\":\"mining.authorize\","
+        "\"params\":[\"{}\",\"x\"]}}\n",
+        SUBSCRIBE_ID, addr.ip_str, addr.port_original, AUTHORIZE_ID, user);
+    if (!SendPending()) return;
+
+    // a line may start anywhere before MAX_LINE_LEN, simdjson reads up to
+    // its padding past it
+    std::string buff(MAX_LINE_LEN * 2 + simdjson::SIMDJSON_PADDING, '\0');
+    const size_t buff_size = MAX_LINE_LEN * 2;
+    size_t start = 0;
+    size_t scan = 0;
+    size_t pos = 0;
+
+    while (!st.stop_requested())
+    {
+        pollfd fds[2] = {
+            {.fd = sockfd,
+             .events = static_cast<short>(
+                 POLLIN | (pending_send.empty() ? 0 : POLLOUT)),
+             .revents = 0},
+            {.fd = submit_fd, .events = POLLIN, .revents = 0}};
+        if (poll(fds, 2, POLL_TIMEOUT_MS) == -1)
+        {
+            if (errno == EINTR) continue;
+            logger.Log<LogType::Warn>("Session {}: failed to poll: {} -> {}",
+                                      id, errno, std::strerror(errno));
+            return;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            eventfd_t count;
+            eventfd_read(submit_fd, &count);
+            if (!TakeSubmits()) return;
+        }
+        if (!pending_send.empty() && !SendPending()) return;
+
+        if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        const ssize_t got = recv(sockfd, buff.data() + pos, buff_size - pos, 0);
+        if (got == 0)
+        {
+            logger.Log<LogType::Warn>("Session {}: the pool closed the "
+                                      "connection",
+                                      id);
+            return;
+        }
+        else if (got == -1)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+                continue;
+            }
+            logger.Log<LogType::Warn>("Session {}: failed to recv: {} -> {}",
+                                      id, errno, std::strerror(errno));
+            return;
+        }
+        pos += got;
+
+        bool ok = true;
+        const FrameStatus status = FrameLines(
+            buff.data(), start, scan, pos, MAX_LINE_LEN,
+            [&](std::string_view line)
+            {
+                if (ok)
+                {
+                    ok = HandleLine(line, buff.size() - (line.data() -
+                                                         buff.data()));
+                }
+            });
+
+        if (!ok) return;
+        if (status == FrameStatus::LINE_TOO_LONG)
+        {
+            logger.Log<LogType::Warn>(
+                "Session {}: message from the pool longer than {} bytes", id,
+                MAX_LINE_LEN);
+            return;
+        }
+
+        // what's left is a partial line, moved to the front
+        std::memmove(buff.data(), buff.data() + start, pos - start);
+        scan -= start;
+        pos -= start;
+        start = 0;
+    }
+}
+
+bool UpstreamSession::TakeSubmits()
+{
+    while (!submits.Empty())
+    {
+        // a push half way through is taken on its own wake up
+        std::unique_ptr<QueuedSubmit> submit(submits.Pop());
+        if (!submit) break;
+
+        if (!subscribed || submit->nonce1 != nonce1)
+        {
+            logger.Log<LogType::Warn>(
+                "Session {}: dropping a share of a previous session", id);
+            continue;
+        }
+        pending_send += submit->line;
+        forwarded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (pending_send.size() > MAX_PENDING_SEND)
+    {
+        logger.Log<LogType::Warn>(
+            "Session {}: the pool stopped reading, {} bytes unsent", id,
+            pending_send.size());
+        return false;
+    }
+    return true;
+}
+
+bool UpstreamSession::SendPending()
+{
+    size_t sent = 0;
+    while (sent < pending_send.size())
+    {
+        const ssize_t res = send(sockfd, pending_send.data() + sent,
+                                 pending_send.size() - sent, MSG_NOSIGNAL);
+        if (res == -1)
+        {
+            if (errno == EINTR) continue;
+            // the rest goes once poll says there's room
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+            logger.Log<LogType::Warn>("Session {}: failed to send: {} -> {}",
+                                      id, errno, std::strerror(errno));
+            return false;
+        }
+        sent += res;
+    }
+    pending_send.erase(0, sent);
+    return true;
+}
+
+bool UpstreamSession::HandleLine(std::string_view line, size_t capacity)
+{
+    using namespace simdjson;
+
+    try
+    {
+        ondemand::document doc =
+            parser.iterate(line.data(), line.size(), capacity);
+        ondemand::object msg = doc.get_object();
+
+        std::string_view method;
+        if (msg["method"].get_string().get(method) != SUCCESS)
+        {
+            return HandleResult(msg["id"].get_int64(), msg, line);
+        }
+
+        ondemand::array params = msg["params"].get_array();
+        if (method == "mining.notify")
+        {
+            UpstreamNotifyZec notify;
+            if (!ParseNotify(params, notify))
+            {
+                logger.Log<LogType::Warn>(
+                    "Session {}: ignoring a job that isn't vrsc's: {}", id,
+                    line);
+                return true;
+            }
+            callbacks.on_notify(std::move(notify));
+        }
+        else if (method == "mining.set_target")
+        {
+            const std::string_view target = params.at(0).get_string();
+            if (target.size() != HASH_SIZE * 2)
+            {
+                logger.Log<LogType::Warn>("Session {}: ignoring bad target: {}",
+                                          id, line);
+                return true;
+            }
+            callbacks.on_target(Target256::FromHex(target));
+        }
+        else
+        {
+            logger.Log<LogType::Info>("Session {}: ignoring {} from the pool",
+                                      id, method);
+        }
+    }
+    catch (const simdjson_error& err)
+    {
+        logger.Log<LogType::Warn>("Session {}: bad message from the pool: {}\n"
+                                  "Message: {}",
+                                  id, err.what(), line);
+        // nothing to mine on without the extra nonce
+        return subscribed;
+    }
+    return true;
+}
+
+bool UpstreamSession::HandleResult(int64_t req_id,
+                                   simdjson::ondemand::object& msg,
+                                   std::string_view line)
+{
+    if (req_id == SUBSCRIBE_ID) return HandleSubscribeResult(msg);
+
+    bool ok = false;
+    if (msg["result"].get_bool().get(ok) != simdjson::SUCCESS) ok = false;
+
+    if (req_id == AUTHORIZE_ID)
+    {
+        if (!ok)
+        {
+            logger.Log<LogType::Error>(
+                "Session {}: the pool didn't authorize {}: {}", id, user,
+                line);
+            return false;
+        }
+
+        logger.Log<LogType::Info>("Session {} authorized as {}", id, user);
+        return true;
+    }
+
+    if (ok)
+    {
+        accepted.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        logger.Log<LogType::Warn>("Session {}: the pool rejected a share: {}",
+                                  id, line);
+    }
+    return true;
+}
+
+// https://zips.z.cash/zip-0301#mining-subscribe
+bool UpstreamSession::HandleSubscribeResult(simdjson::ondemand::object& msg)
+{
+    // [session id, nonce1]
+    const std::string_view nonce1_hex =
+        msg["result"].get_array().at(1).get_string();
+
+    uint32_t new_nonce1;
+    if (nonce1_hex.size() != EXTRANONCE_SIZE * 2 ||
+        !TryUnhexlify(reinterpret_cast<uint8_t*>(&new_nonce1),
+                      nonce1_hex.data(), nonce1_hex.size()))
+    {
+        logger.Log<LogType::Error>(
+            "Session {}: the pool's extra nonce {} isn't {} bytes, it can't "
+            "be split",
+            id, nonce1_hex, EXTRANONCE_SIZE);
+        return false;
+    }
+
+    nonce1 = new_nonce1;
+    subscribed = true;
+
+    logger.Log<LogType::Info>("Session {} subscribed, extra nonce: {}", id,
+                              nonce1_hex);
+    callbacks.on_subscribed(new_nonce1);
+    return true;
+}
+
+void UpstreamSession::Submit(std::string_view job_id,
+                             const uint8_t* block_header)
+{
+    auto submit = std::make_unique<QueuedSubmit>();
+    std::memcpy(&submit->nonce1, block_header + NONCE1_POS,
+                sizeof(submit->nonce1));
+    // the pool only tells its replies apart from the subscribe's and the
+    // authorize's, the ids carry on across reconnects
+    submit->line = FormatSubmit(
+        next_submit_id.fetch_add(1, std::memory_order_relaxed), user, job_id,
+        block_header);
+
+    submits.Push(submit.release());
+    eventfd_write(submit_fd, 1);
+}
+
+// https://zips.z.cash/zip-0301#mining-notify
+bool UpstreamSession::ParseNotify(simdjson::ondemand::array& params,
+                                  UpstreamNotifyZec& res)
+{
+    // job id, version, prev hash, merkle root, final sapling root, time,
+    // bits, clean, solution
+    constexpr size_t CLEAN_PARAM = 7;
+    std::array<std::string_view, 9> values;
+    size_t count = 0;
+    for (auto param : params)
+    {
+        if (count == CLEAN_PARAM)
+        {
+            res.clean = param.get_bool();
+        }
+        else if (count < values.size())
+        {
+            values[count] = param.get_string();
+        }
+        count++;
+    }
+
+    // numbers in the notify are byte swapped
+    const auto parse_u32 = [](std::string_view hex, uint32_t& val)
+    {
+        const char* end = hex.data() + hex.size();
+        const auto res = std::from_chars(hex.data(), end, val, 16);
+        val = bswap_32(val);
+        return hex.size() == sizeof(val) * 2 && res.ec == std::errc() &&
+               res.ptr == end;
+    };
+    const auto parse_hash = [](std::string_view hex, auto& hash)
+    {
+        return hex.size() == hash.size() * 2 &&
+               TryUnhexlify(hash.data(), hex.data(), hex.size());
+    };
+
+    // the id goes back into the submits as is
+    const std::string_view job_id = values[0];
+    if (count != values.size() || job_id.empty() ||
+        job_id.size() > MAX_NOTIFY_MESSAGE_SIZE / 16 ||
+        job_id.find_first_of("\"\\") != std::string_view::npos ||
+        values[8].size() < BinaryProtocol::SOLUTION_PREFIX_SIZE * 2 ||
+        !parse_u32(values[1], res.version) ||
+        !parse_hash(values[2], res.prev_block_hash) ||
+        !parse_hash(values[3], res.merkle_root_hash) ||
+        !parse_hash(values[4], res.final_sroot_hash) ||
+        !parse_u32(values[5], res.time) || !parse_u32(values[6], res.bits))
+    {
+        return false;
+    }
+
+    res.job_id = std::string(job_id);
+    res.solution = std::string(
+        values[8].substr(0, BinaryProtocol::SOLUTION_PREFIX_SIZE * 2));
+    return true;
+}
+
+std::string UpstreamSession::FormatSubmit(int64_t id, std::string_view user,
+                                          std::string_view job_id,
+                                          const uint8_t* block_header)
+{
+    uint32_t time;
+    std::memcpy(&time, block_header + TIME_POS, sizeof(time));
+
+    char nonce2[EXTRANONCE2_SIZE * 2];
+    Hexlify(nonce2, block_header + NONCE2_POS, EXTRANONCE2_SIZE);
+
+    std::string solution((SOLUTION_LENGTH_SIZE + SOLUTION_SIZE) * 2, '\0');
+    Hexlify(solution.data(), block_header + SOLUTION_POS,
+            SOLUTION_LENGTH_SIZE + SOLUTION_SIZE);
+
+    return fmt::format(
+        "{{\"id\":{},\"method\":\"mining.submit\",\"params\":[\"{}\",\"{}\","
+        "\"{:08x}\",\"{}\",\"{}\"]}}\n",
+        id, user, job_id, bswap_32(time),
+        std::string_view(nonce2, sizeof(nonce2)), solution);
+}
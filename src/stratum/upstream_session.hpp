@@ -0,0 +1,137 @@
+#ifndef UPSTREAM_SESSION_HPP_
+#define UPSTREAM_SESSION_HPP_
+
+#include <simdjson.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "job_vrsc.hpp"
+#include "logger.hpp"
+#include "mpsc_queue.hpp"
+#include "sock_addr.hpp"
+#include "target256.hpp"
+
+// one stratum connection from the proxy to the pool it mines to, on its own
+// thread polling the socket: subscribes and authorizes as the farm, hands
+// the pool's extra nonce, targets and jobs to the proxy and forwards the
+// shares that meet the pool's target. the reactors only queue those, the
+// session's thread does all the writing. reconnects, waiting longer after
+// every failed attempt, whenever the pool drops it.
+// the pool's extra nonce has to be EXTRANONCE_SIZE bytes, the proxy appends
+// its rigs' own to it.
+class UpstreamSession : public CoinConstantsZec, public StratumConstants
+{
+   public:
+    // all on the session's thread
+    struct Callbacks
+    {
+        // after every subscribe, the pool may give another extra nonce
+        std::function<void(uint32_t nonce1)> on_subscribed;
+        std::function<void(const Target256& target)> on_target;
+        std::function<void(UpstreamNotifyZec&& notify)> on_notify;
+    };
+
+    static constexpr uint32_t MAX_LINE_LEN = 1024 * 16;
+    static constexpr uint32_t MAX_RECONNECT_DELAY_S = 32;
+    // poll wakes up this often to see if the session is stopping
+    static constexpr uint32_t POLL_TIMEOUT_MS = 1000;
+    // unsent to a pool that stopped reading, it gets reconnected
+    static constexpr uint32_t MAX_PENDING_SEND = 1024 * 1024;
+
+    UpstreamSession(uint32_t id, const std::string& host, std::string user,
+                    Callbacks callbacks);
+    ~UpstreamSession();
+
+    UpstreamSession(const UpstreamSession&) = delete;
+    UpstreamSession& operator=(const UpstreamSession&) = delete;
+
+    // any thread, never waits on the pool. a share assembled with another
+    // extra nonce than the current one (the session reconnected since) is
+    // dropped by the session's thread
+    void Submit(std::string_view job_id, const uint8_t* block_header);
+
+    // handed to the socket, answered by the pool
+    uint64_t Forwarded() const
+    {
+        return forwarded.load(std::memory_order_relaxed);
+    }
+    uint64_t Accepted() const
+    {
+        return accepted.load(std::memory_order_relaxed);
+    }
+    uint64_t Rejected() const
+    {
+        return rejected.load(std::memory_order_relaxed);
+    }
+
+    // false if the params aren't a vrsc job
+    static bool ParseNotify(simdjson::ondemand::array& params,
+                            UpstreamNotifyZec& res);
+    // the mining.submit line the pool gets for a share's header
+    static std::string FormatSubmit(int64_t id, std::string_view user,
+                                    std::string_view job_id,
+                                    const uint8_t* block_header);
+
+   private:
+    static constexpr std::string_view field_str = "UpstreamSession";
+    const Logger logger{field_str};
+
+    static constexpr int64_t SUBSCRIBE_ID = 1;
+    static constexpr int64_t AUTHORIZE_ID = 2;
+
+    const uint32_t id;
+    const SockAddr addr;
+    const std::string user;
+    const Callbacks callbacks;
+
+    // a submit line and the extra nonce its header was assembled with
+    struct QueuedSubmit : MpscNode
+    {
+        uint32_t nonce1;
+        std::string line;
+    };
+
+    // pushed by the reactors, submit_fd wakes the session's thread up
+    MpscQueue<QueuedSubmit> submits;
+    const int submit_fd;
+    std::atomic<int64_t> next_submit_id{AUTHORIZE_ID + 1};
+
+    // only on the session's thread
+    int sockfd = -1;
+    uint32_t nonce1 = 0;
+    bool subscribed = false;
+    // not yet taken by the socket
+    std::string pending_send;
+
+    std::atomic<uint64_t> forwarded{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+
+    simdjson::ondemand::parser parser;
+    // last, it uses everything above
+    std::jthread thread;
+
+    void Run(std::stop_token st);
+    // false if the pool can't be reached
+    bool Connect();
+    // returns once the connection is lost
+    void RunSession(std::stop_token st);
+    void Disconnect();
+    // moves the queued submits of this session behind pending_send, drops
+    // the others. false if the pool stopped reading
+    bool TakeSubmits();
+    // sends what the socket takes without waiting. false if it failed
+    bool SendPending();
+
+    // false if the session has to reconnect
+    bool HandleLine(std::string_view line, size_t capacity);
+    bool HandleResult(int64_t req_id, simdjson::ondemand::object& msg,
+                      std::string_view line);
+    bool HandleSubscribeResult(simdjson::ondemand::object& msg);
+};
+
+#endif
@@ -1,11 +1,18 @@
 #ifndef HEX_UTILS_HPP
 #define HEX_UTILS_HPP
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 constexpr auto u64maxd = static_cast<double>(UINT64_MAX);
 
@@ -95,6 +102,193 @@ constexpr char GetHex(char c)
     return 0;
 }
 
+// vectorized hex, used by Hexlify/Unhexlify whenever they don't run at compile
+// time. each kernel handles whole blocks and returns how many input bytes /
+// characters it took, the scalar loops finish the rest. decoding checks every
+// character in the same pass (bad collects the lanes that weren't hex).
+namespace hex_simd
+{
+#if defined(__x86_64__)
+__attribute__((target("ssse3"))) inline __m128i Nibbles(__m128i c,
+                                                        __m128i& bad)
+{
+    // 'A'-'F' to 'a'-'f', digits already have the bit
+    const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    const __m128i digit =
+        _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                      _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    const __m128i alpha =
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                      _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    bad = _mm_or_si128(bad, _mm_andnot_si128(_mm_or_si128(digit, alpha),
+                                             _mm_set1_epi8(-1)));
+    // low nibble of the char, + 9 for letters ('a' is 0x61)
+    return _mm_add_epi8(_mm_and_si128(c, _mm_set1_epi8(0x0f)),
+                        _mm_and_si128(alpha, _mm_set1_epi8(9)));
+}
+
+__attribute__((target("avx2"))) inline __m256i Nibbles(__m256i c,
+                                                       __m256i& bad)
+{
+    const __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    const __m256i digit =
+        _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+    const __m256i alpha = _mm256_and_si256(
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    bad = _mm256_or_si256(bad, _mm256_andnot_si256(_mm256_or_si256(digit, alpha),
+                                                   _mm256_set1_epi8(-1)));
+    return _mm256_add_epi8(_mm256_and_si256(c, _mm256_set1_epi8(0x0f)),
+                           _mm256_and_si256(alpha, _mm256_set1_epi8(9)));
+}
+
+// 32 characters -> 16 bytes per round
+__attribute__((target("ssse3"))) inline size_t UnhexlifySsse3(
+    uint8_t* dest, const char* src, size_t size, bool& valid)
+{
+    // (high nibble, low nibble) -> high * 16 + low
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i bad = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m128i a = Nibbles(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), bad);
+        const __m128i b = Nibbles(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16)),
+            bad);
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights),
+                                               _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i / 2), bytes);
+    }
+
+    valid = _mm_movemask_epi8(bad) == 0;
+    return i;
+}
+
+// 64 characters -> 32 bytes per round
+__attribute__((target("avx2"))) inline size_t UnhexlifyAvx2(uint8_t* dest,
+                                                            const char* src,
+                                                            size_t size,
+                                                            bool& valid)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    __m256i bad = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        const __m256i a = Nibbles(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)),
+            bad);
+        const __m256i b = Nibbles(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)),
+            bad);
+        // packs within 128 bit lanes: a0 b0 a1 b1 -> a0 a1 b0 b1
+        const __m256i bytes = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights),
+                                _mm256_maddubs_epi16(b, weights)),
+            _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i / 2), bytes);
+    }
+
+    valid = _mm256_testz_si256(bad, bad);
+    return i;
+}
+
+// 16 bytes -> 32 characters per round
+__attribute__((target("ssse3"))) inline size_t HexlifySsse3(char* dest,
+                                                            const uint8_t* src,
+                                                            size_t size)
+{
+    const __m128i table = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i hi = _mm_shuffle_epi8(
+            table, _mm_and_si128(_mm_srli_epi16(b, 4), mask));
+        const __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(b, mask));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2),
+                         _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2 + 16),
+                         _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// 32 bytes -> 64 characters per round
+__attribute__((target("avx2"))) inline size_t HexlifyAvx2(char* dest,
+                                                          const uint8_t* src,
+                                                          size_t size)
+{
+    const __m256i table = _mm256_setr_epi8(
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd',
+        'e', 'f', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
+        'c', 'd', 'e', 'f');
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i hi = _mm256_shuffle_epi8(
+            table, _mm256_and_si256(_mm256_srli_epi16(b, 4), mask));
+        const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(b, mask));
+
+        // unpack works within 128 bit lanes
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 2),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 2 + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+
+inline bool HasAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+inline bool HasSsse3()
+{
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    return ssse3;
+}
+#endif
+
+inline size_t Unhexlify(uint8_t* dest, const char* src, size_t size,
+                        bool& valid)
+{
+    valid = true;
+#if defined(__x86_64__)
+    if (HasAvx2()) return UnhexlifyAvx2(dest, src, size, valid);
+    if (HasSsse3()) return UnhexlifySsse3(dest, src, size, valid);
+#endif
+    return 0;
+}
+
+inline size_t Hexlify(char* dest, const uint8_t* src, size_t size)
+{
+#if defined(__x86_64__)
+    if (HasAvx2()) return HexlifyAvx2(dest, src, size);
+    if (HasSsse3()) return HexlifySsse3(dest, src, size);
+#endif
+    return 0;
+}
+}  // namespace hex_simd
+
 inline uint64_t HexToUint(const char* hex, std::size_t size)
 {
     uint64_t val = 0;
@@ -111,6 +305,18 @@ constexpr void Hexlify(char* dest, const T* src, size_t srcSize)
 {
     constexpr const char hex[] = "0123456789abcdef";
 
+    if constexpr (sizeof(T) == 1)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            const size_t done = hex_simd::Hexlify(
+                dest, reinterpret_cast<const uint8_t*>(src), srcSize);
+            dest += done * 2;
+            src += done;
+            srcSize -= done;
+        }
+    }
+
     // each byte is 2 characters in hex
     for (int i = 0; i < srcSize; i++)
     {
@@ -187,9 +393,17 @@ inline void PrintHex(const uint8_t* b, std::size_t size,
     std::cout << std::endl;
 }
 
-constexpr void Unhexlify(unsigned char* dest, const char* src,
-                         const size_t size)
+constexpr void Unhexlify(unsigned char* dest, const char* src, size_t size)
 {
+    if (!std::is_constant_evaluated())
+    {
+        bool valid;
+        const size_t done = hex_simd::Unhexlify(dest, src, size, valid);
+        dest += done / 2;
+        src += done;
+        size -= done;
+    }
+
     // each byte is 2 characters in hex
     for (int i = 0; i < size / 2; i++)
     {
@@ -199,6 +413,30 @@ constexpr void Unhexlify(unsigned char* dest, const char* src,
     }
 }
 
+// Unhexlify for untrusted input, false if size is odd or any character
+// isn't hex (dest is partly written then)
+[[nodiscard]] inline bool TryUnhexlify(unsigned char* dest, const char* src,
+                                       size_t size)
+{
+    if (size % 2) return false;
+
+    bool valid;
+    const size_t done = hex_simd::Unhexlify(dest, src, size, valid);
+
+    for (size_t i = done; i < size; i++)
+    {
+        const char c = src[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+              (c >= 'A' && c <= 'F')))
+        {
+            return false;
+        }
+    }
+
+    Unhexlify(dest + done / 2, src + done, size - done);
+    return valid;
+}
+
 template <size_t size>
 constexpr std::array<uint8_t, size / 2> Unhexlify(std::string_view src)
 {
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "stratum/binary_protocol.hpp"
+#include "crypto/target256.hpp"
+
+using MsgType = BinaryProtocol::MsgType;
+
+template <typename Msg>
+static std::string EncodeFrame(const Msg& msg)
+{
+    std::string res(Msg::MAX_SIZE, '\0');
+    res.resize(BinaryProtocol::Encode(res.data(), msg));
+    return res;
+}
+
+struct Frame
+{
+    MsgType type;
+    std::string payload;
+};
+
+static FrameStatus Split(const std::string& buff, size_t& start,
+                         std::vector<Frame>& frames)
+{
+    return BinaryProtocol::Frame(
+        buff.data(), start, buff.size(),
+        [&](MsgType type, std::string_view payload)
+        { frames.push_back(Frame{type, std::string(payload)}); });
+}
+
+// the decoded views point into payload
+template <typename Msg>
+static Msg RoundTrip(const Msg& msg, std::string& payload)
+{
+    const std::string frame = EncodeFrame(msg);
+    size_t start = 0;
+    std::vector<Frame> frames;
+    EXPECT_EQ(Split(frame, start, frames), FrameStatus::OK);
+    EXPECT_EQ(start, frame.size());
+
+    Msg res{};
+    if (frames.size() != 1) return res;
+    EXPECT_EQ(frames[0].type, Msg::TYPE);
+    payload = std::move(frames[0].payload);
+    EXPECT_TRUE(BinaryProtocol::Decode(payload, res));
+    return res;
+}
+
+TEST(BinaryProtocol, Header)
+{
+    const std::string frame =
+        EncodeFrame(BinaryProtocol::SubmitSuccess{0x01020304});
+
+    // sv2's: extension 0, type, u24 payload size, then the payload
+    const std::string expected("\x00\x00\x1c\x04\x00\x00\x04\x03\x02\x01", 10);
+    EXPECT_EQ(frame, expected);
+}
+
+TEST(BinaryProtocol, RoundTrip)
+{
+    std::string payload;
+    const BinaryProtocol::SetupConnection setup_req{
+        .min_version = 1, .max_version = 3, .flags = 7, .user_agent = "ref/1"};
+    const auto setup = RoundTrip(setup_req, payload);
+    EXPECT_EQ(setup.min_version, 1);
+    EXPECT_EQ(setup.max_version, 3);
+    EXPECT_EQ(setup.flags, 7);
+    EXPECT_EQ(setup.user_agent, "ref/1");
+
+    BinaryProtocol::OpenChannelSuccess success{.request_id = 9,
+                                               .extranonce = 0xdeadbeef};
+    for (size_t i = 0; i < success.target.size(); i++) success.target[i] = i;
+    const auto success_res = RoundTrip(success, payload);
+    EXPECT_EQ(success_res.request_id, 9);
+    EXPECT_EQ(success_res.target, success.target);
+    EXPECT_EQ(success_res.extranonce, 0xdeadbeef);
+
+    BinaryProtocol::NewMiningJob job{.job_id = 0x1a,
+                                     .clean = true,
+                                     .version = 4,
+                                     .min_time = 1700000000,
+                                     .bits = 0x1d00ffff};
+    job.prev_hash.fill(1);
+    job.merkle_root.fill(2);
+    job.final_sroot.fill(3);
+    job.solution_prefix.fill(4);
+    const auto job_res = RoundTrip(job, payload);
+    EXPECT_EQ(job_res.job_id, job.job_id);
+    EXPECT_TRUE(job_res.clean);
+    EXPECT_EQ(job_res.version, job.version);
+    EXPECT_EQ(job_res.prev_hash, job.prev_hash);
+    EXPECT_EQ(job_res.merkle_root, job.merkle_root);
+    EXPECT_EQ(job_res.final_sroot, job.final_sroot);
+    EXPECT_EQ(job_res.min_time, job.min_time);
+    EXPECT_EQ(job_res.bits, job.bits);
+    EXPECT_EQ(job_res.solution_prefix, job.solution_prefix);
+
+    const std::string nonce2(BinaryProtocol::NONCE2_SIZE, 'n');
+    const std::string solution(BinaryProtocol::SOLUTION_FIELD_SIZE, 's');
+    const auto submit = RoundTrip(BinaryProtocol::SubmitShare{
+                                      .sequence = 42,
+                                      .job_id = 0x1a,
+                                      .time = 1700000001,
+                                      .nonce2 = nonce2,
+                                      .solution = solution},
+                                  payload);
+    EXPECT_EQ(submit.sequence, 42);
+    EXPECT_EQ(submit.job_id, 0x1a);
+    EXPECT_EQ(submit.time, 1700000001);
+    EXPECT_EQ(submit.nonce2, nonce2);
+    EXPECT_EQ(submit.solution, solution);
+
+    // about half of the json submit (benchmark/submit_bench.cpp)
+    EXPECT_EQ(BinaryProtocol::HEADER_SIZE + payload.size(), 1393);
+}
+
+TEST(BinaryProtocol, LongStringsAreTruncated)
+{
+    const std::string error(300, 'e');
+    std::string payload;
+    const auto res = RoundTrip(BinaryProtocol::SubmitError{1, error}, payload);
+    EXPECT_EQ(res.error, error.substr(0, BinaryProtocol::MAX_STR_SIZE));
+}
+
+TEST(BinaryProtocol, DecodeNeedsTheExactPayload)
+{
+    std::string payload = EncodeFrame(BinaryProtocol::OpenChannel{3, "a.b"})
+                              .substr(BinaryProtocol::HEADER_SIZE);
+
+    BinaryProtocol::OpenChannel res;
+    EXPECT_TRUE(BinaryProtocol::Decode(payload, res));
+    EXPECT_FALSE(BinaryProtocol::Decode(payload + "x", res));
+    EXPECT_FALSE(
+        BinaryProtocol::Decode(payload.substr(0, payload.size() - 1), res));
+
+    // the string's size past the payload
+    payload[4] = 100;
+    EXPECT_FALSE(BinaryProtocol::Decode(payload, res));
+}
+
+TEST(BinaryProtocol, FramesSplitAcrossReads)
+{
+    const std::string stream =
+        EncodeFrame(BinaryProtocol::SubmitSuccess{1}) +
+        EncodeFrame(BinaryProtocol::SubmitError{2, "Job not found"}) +
+        EncodeFrame(BinaryProtocol::SubmitSuccess{3});
+
+    // every split point, as a partial frame waits for the rest
+    for (size_t split = 0; split <= stream.size(); split++)
+    {
+        std::string buff = stream.substr(0, split);
+        size_t start = 0;
+        std::vector<Frame> frames;
+
+        ASSERT_EQ(Split(buff, start, frames), FrameStatus::OK);
+        buff += stream.substr(split);
+        ASSERT_EQ(Split(buff, start, frames), FrameStatus::OK);
+
+        ASSERT_EQ(start, stream.size());
+        ASSERT_EQ(frames.size(), 3);
+        EXPECT_EQ(frames[0].type, MsgType::SUBMIT_SHARES_SUCCESS);
+        EXPECT_EQ(frames[1].type, MsgType::SUBMIT_SHARES_ERROR);
+        EXPECT_EQ(frames[2].type, MsgType::SUBMIT_SHARES_SUCCESS);
+    }
+}
+
+TEST(BinaryProtocol, BadFrames)
+{
+    size_t start = 0;
+    std::vector<Frame> frames;
+
+    // an extension
+    EXPECT_EQ(Split(std::string("\x01\x00\x1c\x00\x00\x00", 6), start, frames),
+              FrameStatus::BAD_FRAME);
+
+    // bigger than any message, rejected before it's all there
+    EXPECT_EQ(Split(std::string("\x00\x00\x1a\x01\x10\x00", 6), start, frames),
+              FrameStatus::BAD_FRAME);
+    EXPECT_TRUE(frames.empty());
+}
+
+TEST(BinaryProtocol, TargetBytes)
+{
+    const Target256 target = Target256::FromDiff(78960.0);
+    const std::array<uint8_t, 32> bytes = target.ToBytesLE();
+
+    // a hash equal to the target meets it, one above doesn't
+    EXPECT_TRUE(target.IsMetBy(bytes.data()));
+    std::array<uint8_t, 32> above = bytes;
+    for (auto& byte : above)
+    {
+        if (++byte != 0) break;
+    }
+    EXPECT_FALSE(target.IsMetBy(above.data()));
+
+    std::array<uint8_t, 32> max;
+    max.fill(0xff);
+    EXPECT_EQ(Target256::Max().ToBytesLE(), max);
+}
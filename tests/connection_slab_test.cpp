@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "stratum/connection_slab.hpp"
+
+using Slab = ConnectionSlab<int>;
+
+static in_addr LocalAddr()
+{
+    in_addr addr;
+    addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+TEST(ConnectionSlab, GetByHandle)
+{
+    Slab slab(4);
+    Connection<int>* a = slab.Allocate(10, LocalAddr());
+    Connection<int>* b = slab.Allocate(11, LocalAddr());
+
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(slab.Get(a->handle), a);
+    EXPECT_EQ(slab.Get(b->handle), b);
+    EXPECT_STREQ(a->ip.data(), "127.0.0.1");
+    EXPECT_EQ(slab.Size(), 2);
+
+    // never handed out
+    EXPECT_EQ(slab.Get(Slab::MakeHandle(1, 3)), nullptr);
+    EXPECT_EQ(slab.Get(Slab::MakeHandle(1, 100)), nullptr);
+}
+
+TEST(ConnectionSlab, ReusedSlotRejectsOldHandle)
+{
+    Slab slab(4);
+    Connection<int>* conn = slab.Allocate(10, LocalAddr());
+    const ConnectionHandle old_handle = conn->handle;
+
+    slab.Free(conn);
+    EXPECT_EQ(slab.Get(old_handle), nullptr);
+
+    // the same slot, a new generation
+    Connection<int>* reused = slab.Allocate(12, LocalAddr());
+    ASSERT_EQ(reused, conn);
+    EXPECT_NE(reused->handle, old_handle);
+    EXPECT_EQ(static_cast<uint32_t>(reused->handle),
+              static_cast<uint32_t>(old_handle));
+
+    // a stale event of the old connection doesn't reach the new one
+    EXPECT_EQ(slab.Get(old_handle), nullptr);
+    EXPECT_EQ(slab.Get(reused->handle), reused);
+    EXPECT_EQ(reused->sockfd, 12);
+}
+
+TEST(ConnectionSlab, Full)
+{
+    Slab slab(2);
+    Connection<int>* a = slab.Allocate(10, LocalAddr());
+    ASSERT_NE(slab.Allocate(11, LocalAddr()), nullptr);
+    EXPECT_EQ(slab.Allocate(12, LocalAddr()), nullptr);
+
+    slab.Free(a);
+    EXPECT_NE(slab.Allocate(12, LocalAddr()), nullptr);
+    EXPECT_EQ(slab.Size(), 2);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "crypto/cn/ethash/ethash-internal.hpp"
+#include "crypto/epoch_prewarmer.hpp"
+
+// the contexts are global, so the whole epoch switch is one test
+TEST(EpochPrewarmer, PrewarmAndSwitch)
+{
+    using ethash::has_global_epoch_context_full;
+    constexpr uint32_t epoch_length = ethash::epoch_length;
+
+    {
+        EpochPrewarmer prewarmer;
+
+        // the current epoch is built, the next one isn't needed yet
+        prewarmer.OnHeight(epoch_length - EpochPrewarmer::PREWARM_BLOCKS - 1);
+        EXPECT_TRUE(has_global_epoch_context_full(0));
+        EXPECT_FALSE(has_global_epoch_context_full(1));
+
+        prewarmer.OnHeight(epoch_length - EpochPrewarmer::PREWARM_BLOCKS);
+        // joins the builder
+    }
+    EXPECT_TRUE(has_global_epoch_context_full(0));
+    EXPECT_TRUE(has_global_epoch_context_full(1));
+
+    // just past the boundary, late epoch 0 shares still come in
+    {
+        EpochPrewarmer prewarmer;
+        prewarmer.OnHeight(epoch_length);
+        EXPECT_TRUE(has_global_epoch_context_full(0));
+
+        prewarmer.OnHeight(epoch_length + EpochPrewarmer::RELEASE_BLOCKS - 1);
+        EXPECT_TRUE(has_global_epoch_context_full(0));
+    }
+    const auto late = ethash::get_global_epoch_context_full(0);
+    ASSERT_TRUE(late);
+    EXPECT_EQ(late->epoch_number, 0);
+
+    // then its dataset goes, only epoch 1 stays
+    {
+        EpochPrewarmer prewarmer;
+        prewarmer.OnHeight(epoch_length + EpochPrewarmer::RELEASE_BLOCKS);
+    }
+    EXPECT_FALSE(has_global_epoch_context_full(0));
+    EXPECT_TRUE(has_global_epoch_context_full(1));
+
+    // once a thread moved on, a straggler is served a context of its own,
+    // epoch 0 isn't shared again
+    ASSERT_TRUE(ethash::get_global_epoch_context_full(1));
+    const auto straggler = ethash::get_global_epoch_context_full(0);
+    ASSERT_TRUE(straggler);
+    EXPECT_EQ(straggler->epoch_number, 0);
+    EXPECT_NE(straggler, late);
+    EXPECT_FALSE(has_global_epoch_context_full(0));
+
+    // epoch 2 is prewarmed next to epoch 1
+    {
+        EpochPrewarmer prewarmer;
+        prewarmer.OnHeight(2 * epoch_length - EpochPrewarmer::PREWARM_BLOCKS);
+    }
+    EXPECT_TRUE(has_global_epoch_context_full(1));
+    EXPECT_TRUE(has_global_epoch_context_full(2));
+
+    // an older epoch never evicts a newer one from its slot
+    ASSERT_TRUE(ethash::prepare_global_epoch_context_full(3));
+    ASSERT_TRUE(ethash::get_global_epoch_context_full(3));
+    const auto old_straggler = ethash::get_global_epoch_context_full(0);
+    ASSERT_TRUE(old_straggler);
+    EXPECT_EQ(old_straggler->epoch_number, 0);
+    EXPECT_TRUE(has_global_epoch_context_full(3));
+
+    // past epoch 3's boundary, only its context stays
+    {
+        EpochPrewarmer prewarmer;
+        prewarmer.OnHeight(3 * epoch_length + EpochPrewarmer::RELEASE_BLOCKS);
+    }
+    EXPECT_FALSE(has_global_epoch_context_full(1));
+    EXPECT_FALSE(has_global_epoch_context_full(2));
+    EXPECT_TRUE(has_global_epoch_context_full(3));
+}
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <vector>
 
 
 TEST(HashWrapperTest, VerusHash2_2)
@@ -75,6 +76,145 @@ TEST(HashWrapperTest, VerusHash2_2)
     ASSERT_EQ(std::memcmp(hex, expected, 64), 0);
 }
 
+TEST(HashWrapperTest, VerusHash2_2Batch)
+{
+    // VRSC block #1 and variations of its nonce and merkle root (shares of
+    // different jobs), every lane must match the single header hash
+    HashWrapper::InitVerusHash();
+    char data[] =
+        "04000100e79e17888885239ed18431c469b68f6a8b1f75f609d91d0593ad0700000000"
+        "00f152ad13d884b4f2b43510645c0ca0084d58e3457f334238890db8760e5e8c6f74dd"
+        "8138e98b0977ffc16dafd2da16433711d48bd11e41cdd6dc1275334a91194c050762ef"
+        "b8081bcb58e2480000000000000000140000800c000000020000000000000000000000"
+        "fd40050600000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000165355000000000000000000000000";
+
+    constexpr int count = 7;
+    unsigned char headers[count][(sizeof(data)) / 2];
+    for (int i = 0; i < count; i++)
+    {
+        Unhexlify(headers[i], data, sizeof(data) - 1);
+        // nonce
+        headers[i][108 + 31] ^= i;
+        // merkle root
+        headers[i][36 + 5] ^= i / 2;
+    }
+
+    CVerusHashV2 hasher(SOLUTION_VERUSHHASH_V2_2);
+    CVerusHashV2Batch batch_hasher(SOLUTION_VERUSHHASH_V2_2);
+
+    unsigned char expected[count][32];
+    for (int i = 0; i < count; i++)
+    {
+        HashWrapper::VerushashV2b2(expected[i], headers[i], sizeof(headers[i]),
+                                   &hasher);
+    }
+
+    // full batches, a padded batch and a single leftover
+    for (int n = 1; n <= count; n++)
+    {
+        unsigned char results[count][32] = {0};
+        uint8_t* out[count];
+        const uint8_t* in[count];
+        for (int i = 0; i < n; i++)
+        {
+            out[i] = results[i];
+            in[i] = headers[i];
+        }
+
+        HashWrapper::VerushashV2b2Batch(out, in, sizeof(headers[0]), n,
+                                        &batch_hasher);
+
+        for (int i = 0; i < n; i++)
+        {
+            ASSERT_EQ(std::memcmp(results[i], expected[i], 32), 0)
+                << "batch of " << n << ", lane " << i;
+        }
+    }
+
+    // continuing from the absorbed static header (version to final sapling
+    // root) of each header's job, odd sized so a part of it is pending
+    constexpr size_t prefix_len = 4 + 32 * 3;
+    std::vector<CVerusHashV2Prefix> prefixes;
+    for (int i = 0; i < count; i++)
+    {
+        prefixes.emplace_back(headers[i], prefix_len);
+
+        unsigned char result[32];
+        HashWrapper::VerushashV2b2(result, headers[i], sizeof(headers[i]),
+                                   prefixes[i], &hasher);
+        ASSERT_EQ(std::memcmp(result, expected[i], 32), 0) << "header " << i;
+    }
+
+    for (int n = 1; n <= count; n++)
+    {
+        unsigned char results[count][32] = {0};
+        uint8_t* out[count];
+        const uint8_t* in[count];
+        const CVerusHashV2Prefix* lane_prefixes[count];
+        for (int i = 0; i < n; i++)
+        {
+            out[i] = results[i];
+            in[i] = headers[i];
+            lane_prefixes[i] = &prefixes[i];
+        }
+
+        HashWrapper::VerushashV2b2Batch(out, in, sizeof(headers[0]), n,
+                                        &batch_hasher, lane_prefixes);
+
+        for (int i = 0; i < n; i++)
+        {
+            ASSERT_EQ(std::memcmp(results[i], expected[i], 32), 0)
+                << "prefixed batch of " << n << ", lane " << i;
+        }
+    }
+
+    char hex[64];
+    Hexlify(hex, expected[0], 32);
+    ASSERT_EQ(std::memcmp(hex,
+                          "c7860153c2390efe7481b1bbe041dd3c95404b64309852397f1e"
+                          "000000000000",
+                          64),
+              0);
+}
+
 TEST(HashWrapperTest, X25X)
 {
     // SINOVATE block #999999:
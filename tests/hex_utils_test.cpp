@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/hex_utils.hpp"
+
+// the vector kernels only run on whole blocks, the sizes cover empty, under
+// one block, the block boundaries and a scalar tail
+static const size_t SIZES[] = {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1487};
+
+static std::vector<uint8_t> RandomBytes(size_t size)
+{
+    std::mt19937 gen(size);
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) b = gen();
+    return bytes;
+}
+
+TEST(HexUtils, HexlifyMatchesScalar)
+{
+    constexpr const char hex[] = "0123456789abcdef";
+    for (size_t size : SIZES)
+    {
+        const auto bytes = RandomBytes(size);
+        std::string expected;
+        for (uint8_t b : bytes)
+        {
+            expected += hex[b >> 4];
+            expected += hex[b & 0xf];
+        }
+
+        ASSERT_EQ(HexlifyS(bytes), expected) << "size " << size;
+    }
+}
+
+TEST(HexUtils, UnhexlifyRoundTrip)
+{
+    for (size_t size : SIZES)
+    {
+        const auto bytes = RandomBytes(size);
+        std::string hex = HexlifyS(bytes);
+        // upper case is accepted too
+        for (size_t i = 0; i < hex.size(); i += 3) hex[i] = toupper(hex[i]);
+
+        std::vector<uint8_t> out(size);
+        Unhexlify(out.data(), hex.data(), hex.size());
+        ASSERT_EQ(out, bytes) << "size " << size;
+
+        std::fill(out.begin(), out.end(), 0);
+        ASSERT_TRUE(TryUnhexlify(out.data(), hex.data(), hex.size()));
+        ASSERT_EQ(out, bytes) << "size " << size;
+    }
+}
+
+TEST(HexUtils, TryUnhexlifyRejects)
+{
+    std::vector<uint8_t> out(1487);
+    const std::string valid = HexlifyS(RandomBytes(out.size()));
+
+    // odd length
+    ASSERT_FALSE(TryUnhexlify(out.data(), valid.data(), valid.size() - 1));
+
+    // one bad character anywhere, inside a vector block or in the tail
+    for (size_t pos : {size_t{0}, size_t{31}, size_t{64}, size_t{1000},
+                       valid.size() - 1})
+    {
+        for (char c : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\xff'})
+        {
+            std::string hex = valid;
+            hex[pos] = c;
+            ASSERT_FALSE(TryUnhexlify(out.data(), hex.data(), hex.size()))
+                << "pos " << pos << " char " << int(c);
+        }
+    }
+}
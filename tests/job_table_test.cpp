@@ -0,0 +1,83 @@
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "jobs/job_table.hpp"
+
+struct FakeJob
+{
+    std::string id;
+    uint32_t seq;
+    bool clean;
+};
+
+static std::shared_ptr<FakeJob> MakeJob(uint32_t seq, bool clean = false)
+{
+    return std::make_shared<FakeJob>(
+        FakeJob{fmt::format("{:08x}", seq), seq, clean});
+}
+
+using SeqTable = JobTable<FakeJob, true>;
+using HashTable = JobTable<FakeJob, false>;
+
+TEST(JobTable, RingDropsOldest)
+{
+    SeqTable table;
+    for (uint32_t seq = 0; seq <= SeqTable::SIZE; seq++)
+    {
+        table.Add(MakeJob(seq, seq == 0));
+    }
+
+    // the 65th job took the first one's slot
+    EXPECT_EQ(table.Get("00000000"), nullptr);
+    for (uint32_t seq = 1; seq <= SeqTable::SIZE; seq++)
+    {
+        const std::string id = fmt::format("{:08x}", seq);
+        const std::shared_ptr<FakeJob> job = table.Get(id);
+        ASSERT_NE(job, nullptr) << id;
+        EXPECT_EQ(job->seq, seq);
+    }
+    EXPECT_EQ(table.Last()->seq, SeqTable::SIZE);
+}
+
+TEST(JobTable, CleanJobDropsHeight)
+{
+    SeqTable table;
+    table.Add(MakeJob(0, true));
+    table.Add(MakeJob(1));
+    table.Add(MakeJob(2, true));
+
+    EXPECT_EQ(table.Get("00000000"), nullptr);
+    EXPECT_EQ(table.Get("00000001"), nullptr);
+    EXPECT_NE(table.Get("00000002"), nullptr);
+}
+
+TEST(JobTable, BadIdsGetNothing)
+{
+    SeqTable table;
+    for (uint32_t seq = 0; seq < 3; seq++) table.Add(MakeJob(seq));
+
+    // index a live slot but aren't its job
+    EXPECT_EQ(table.Get(fmt::format("{:08x}", 1 + SeqTable::SIZE)), nullptr);
+    EXPECT_EQ(table.Get("0000001"), nullptr);
+    EXPECT_EQ(table.Get("000000001"), nullptr);
+    EXPECT_EQ(table.Get("0000000g"), nullptr);
+    EXPECT_EQ(table.Get("zzzzzzzz"), nullptr);
+    EXPECT_EQ(table.Get(""), nullptr);
+}
+
+TEST(JobTable, HashIdsMatchWhole)
+{
+    HashTable table;
+    const std::string id(64, 'a');
+    table.Add(std::make_shared<FakeJob>(FakeJob{id, 0, true}));
+    ASSERT_NE(table.Get(id), nullptr);
+
+    // the same first 8 bytes (the slot's key), another template
+    std::string other = id;
+    other.back() = 'b';
+    EXPECT_EQ(table.Get(other), nullptr);
+    EXPECT_EQ(table.Get(id.substr(0, 16)), nullptr);
+}
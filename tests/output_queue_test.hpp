@@ -0,0 +1,53 @@
+#ifndef OUTPUT_QUEUE_TEST_HPP
+#define OUTPUT_QUEUE_TEST_HPP
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "shares/share.hpp"
+#include "stratum/output_queue.hpp"
+#include "stratum/stratum_reply.hpp"
+
+// a connection's output over a socket pair, the test reads the other end
+class OutputQueueTest : public ::testing::Test
+{
+   protected:
+    int fds[2];
+
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    }
+
+    void TearDown() override
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    std::string ReadAll()
+    {
+        std::string res;
+        char buff[4096];
+        ssize_t got;
+        while ((got = recv(fds[1], buff, sizeof(buff), MSG_DONTWAIT)) > 0)
+        {
+            res.append(buff, got);
+        }
+        return res;
+    }
+
+    // encodes and queues a reply the way StratumBase::SendRes does
+    static void SendReply(OutputQueue& queue, int sockfd, int64_t id,
+                          const RpcResult& res)
+    {
+        char buff[StratumReply::STACK_SIZE];
+        const size_t len =
+            StratumReply::Encode(buff, id, res.code, res.Msg());
+        queue.Write(sockfd, std::string_view(buff, len));
+    }
+};
+
+#endif
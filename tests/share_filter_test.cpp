@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "shares/share_filter.hpp"
+
+using InsertResult = ShareFilter::InsertResult;
+
+TEST(ShareFilter, InsertAndDuplicate)
+{
+    ShareFilter filter(ShareFilter::MIN_CAPACITY_LOG2);
+
+    EXPECT_EQ(filter.Insert(0x1234567890abcdef), InsertResult::INSERTED);
+    EXPECT_EQ(filter.Insert(0xfedcba0987654321), InsertResult::INSERTED);
+    EXPECT_EQ(filter.Insert(0x1234567890abcdef), InsertResult::DUPLICATE);
+    EXPECT_EQ(filter.Insert(0xfedcba0987654321), InsertResult::DUPLICATE);
+    EXPECT_EQ(filter.Size(), 2);
+    EXPECT_EQ(filter.Overflowed(), 0);
+}
+
+TEST(ShareFilter, ZeroFingerprint)
+{
+    // zero marks an empty slot, it is stored as 1
+    ShareFilter filter(ShareFilter::MIN_CAPACITY_LOG2);
+
+    EXPECT_EQ(filter.Insert(0), InsertResult::INSERTED);
+    EXPECT_EQ(filter.Insert(0), InsertResult::DUPLICATE);
+    EXPECT_EQ(filter.Insert(1), InsertResult::DUPLICATE);
+}
+
+TEST(ShareFilter, OverflowWhenProbesTaken)
+{
+    ShareFilter filter(ShareFilter::MIN_CAPACITY_LOG2);
+    const uint64_t capacity = filter.Capacity();
+
+    // all start probing at slot 1
+    for (uint64_t i = 0; i < ShareFilter::MAX_PROBES; i++)
+    {
+        ASSERT_EQ(filter.Insert(1 + i * capacity), InsertResult::INSERTED);
+    }
+
+    // past the probes it still goes in, and is still caught
+    const uint64_t overflowing = 1 + ShareFilter::MAX_PROBES * capacity;
+    EXPECT_FALSE(filter.Contains(overflowing));
+    EXPECT_EQ(filter.Insert(overflowing), InsertResult::INSERTED);
+    EXPECT_EQ(filter.Insert(overflowing), InsertResult::DUPLICATE);
+    EXPECT_TRUE(filter.Contains(overflowing));
+    EXPECT_EQ(filter.Overflowed(), 1);
+    EXPECT_EQ(filter.Size(), ShareFilter::MAX_PROBES + 1);
+
+    // the ones that made it in are still caught
+    EXPECT_EQ(filter.Insert(1), InsertResult::DUPLICATE);
+    // and other slots are unaffected
+    EXPECT_EQ(filter.Insert(capacity / 2), InsertResult::INSERTED);
+    EXPECT_EQ(filter.Overflowed(), 1);
+}
+
+TEST(ShareFilter, ContainsDoesNotInsert)
+{
+    ShareFilter filter(ShareFilter::MIN_CAPACITY_LOG2);
+
+    EXPECT_FALSE(filter.Contains(0x1234567890abcdef));
+    EXPECT_EQ(filter.Size(), 0);
+    EXPECT_EQ(filter.Insert(0x1234567890abcdef), InsertResult::INSERTED);
+    EXPECT_TRUE(filter.Contains(0x1234567890abcdef));
+    EXPECT_TRUE(filter.Contains(0x1234567890abcdef));
+    EXPECT_EQ(filter.Size(), 1);
+}
+
+TEST(ShareFilter, CapacityFor)
+{
+    EXPECT_EQ(ShareFilter::CapacityFor(0), ShareFilter::MIN_CAPACITY_LOG2);
+    EXPECT_EQ(ShareFilter::CapacityFor(1000), ShareFilter::MIN_CAPACITY_LOG2);
+
+    // 8x the last height's shares
+    EXPECT_EQ(ShareFilter::CapacityFor(1 << 13), 17);
+    EXPECT_EQ(ShareFilter::CapacityFor((1 << 14) - 1), 17);
+    EXPECT_EQ(ShareFilter::CapacityFor(1 << 14), 18);
+
+    EXPECT_EQ(ShareFilter::CapacityFor(uint64_t{1} << 40),
+              ShareFilter::MAX_CAPACITY_LOG2);
+    EXPECT_EQ(ShareFilter(ShareFilter::CapacityFor(1 << 13)).Capacity(),
+              1 << 17);
+}
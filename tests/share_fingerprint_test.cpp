@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+
+#include "shares/share_fingerprint.hpp"
+#include "static_config/config_zano.hpp"
+#include "static_config/static_config.hpp"
+
+using HeaderZec = std::array<uint8_t, VrscStatic.BLOCK_HEADER_SIZE>;
+
+static HeaderZec MakeHeader()
+{
+    HeaderZec header;
+    for (size_t i = 0; i < header.size(); i++)
+    {
+        header[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    return header;
+}
+
+TEST(ShareFingerprint, ZecStable)
+{
+    const HeaderZec header = MakeHeader();
+    const HeaderZec copy = header;
+    const ShareZec share{};
+
+    EXPECT_EQ(ShareFingerprint<VrscStatic>(header.data(), share),
+              ShareFingerprint<VrscStatic>(copy.data(), share));
+}
+
+TEST(ShareFingerprint, ZecEveryField)
+{
+    // first byte of each field: version, prev hash, merkle root, final
+    // sapling root, time, bits, nonce1, nonce2, solution size, solution, and
+    // the solution's last byte (tail of the hash)
+    constexpr std::array<size_t, 11> field_pos{
+        0, 4, 36, 68, 100, 104, 108, 112, 140, 143,
+        VrscStatic.BLOCK_HEADER_SIZE - 1};
+
+    const HeaderZec header = MakeHeader();
+    const ShareZec share{};
+    const uint64_t base = ShareFingerprint<VrscStatic>(header.data(), share);
+
+    for (const size_t pos : field_pos)
+    {
+        HeaderZec changed = header;
+        changed[pos] ^= 1;
+        EXPECT_NE(ShareFingerprint<VrscStatic>(changed.data(), share), base)
+            << "byte " << pos;
+    }
+}
+
+TEST(ShareFingerprint, CnStable)
+{
+    const std::string job_id(64, 'a');
+    const std::string job_id_copy = job_id;
+
+    ShareCn share;
+    share.job_id = job_id;
+    share.nonce = 0x1122334455667788;
+
+    ShareCn same = share;
+    same.job_id = job_id_copy;
+
+    // cn shares have no prepared header
+    EXPECT_EQ(ShareFingerprint<ZanoStatic>(nullptr, share),
+              ShareFingerprint<ZanoStatic>(nullptr, same));
+}
+
+TEST(ShareFingerprint, CnEveryField)
+{
+    const std::string job_id(64, 'a');
+    std::string other_job = job_id;
+    other_job.back() = 'b';
+
+    ShareCn share;
+    share.job_id = job_id;
+    share.nonce = 0x1122334455667788;
+    const uint64_t base = ShareFingerprint<ZanoStatic>(nullptr, share);
+
+    ShareCn changed_job = share;
+    changed_job.job_id = other_job;
+    EXPECT_NE(ShareFingerprint<ZanoStatic>(nullptr, changed_job), base);
+
+    ShareCn changed_nonce = share;
+    changed_nonce.nonce ^= 1;
+    EXPECT_NE(ShareFingerprint<ZanoStatic>(nullptr, changed_nonce), base);
+}
@@ -0,0 +1,412 @@
+#include <arpa/inet.h>
+#include <byteswap.h>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "shares/share_processor.hpp"
+#include "static_config.hpp"
+#include "stratum/stratum_proxy_zec.hpp"
+#include "stratum/submit_scanner.hpp"
+#include "stratum/upstream_session.hpp"
+
+using JobZec = Job<StratumProtocol::ZEC>;
+using ProxyZec = StratumProxyZec<VrscStatic>;
+
+static constexpr std::array<size_t, 5> POOL_SIZES{0, 0, 8, 56, 2694};
+static constexpr uint32_t UPSTREAM_NONCE1 = 0x44332211;
+
+static UpstreamNotifyZec MakeNotify()
+{
+    UpstreamNotifyZec notify;
+    notify.job_id = "1a2b";
+    notify.version = 65540;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        notify.prev_block_hash[i] = i;
+        notify.merkle_root_hash[i] = 0x40 + i;
+        notify.final_sroot_hash[i] = 0x80 + i;
+    }
+    notify.time = 1650823041;
+    notify.bits = 0x1b083611;
+    notify.clean = true;
+    notify.solution = "0700000000000000" + std::string(128, '0');
+    return notify;
+}
+
+TEST(StratumProxy, NotifyRoundTrip)
+{
+    HashWrapper::InitVerusHash();
+
+    const UpstreamNotifyZec notify = MakeNotify();
+    const JobZec job(notify, Target256::Max(), 1.0);
+
+    // the rigs' notify is the pool's, re-encoded
+    simdjson::ondemand::parser parser;
+    simdjson::padded_string msg(job.notify_msg);
+    simdjson::ondemand::document doc = parser.iterate(msg);
+    simdjson::ondemand::array params = doc["params"].get_array();
+
+    UpstreamNotifyZec parsed;
+    ASSERT_TRUE(UpstreamSession::ParseNotify(params, parsed));
+    EXPECT_EQ(parsed.job_id, notify.job_id);
+    EXPECT_EQ(parsed.version, notify.version);
+    EXPECT_EQ(parsed.prev_block_hash, notify.prev_block_hash);
+    EXPECT_EQ(parsed.merkle_root_hash, notify.merkle_root_hash);
+    EXPECT_EQ(parsed.final_sroot_hash, notify.final_sroot_hash);
+    EXPECT_EQ(parsed.time, notify.time);
+    EXPECT_EQ(parsed.bits, notify.bits);
+    EXPECT_EQ(parsed.clean, notify.clean);
+    EXPECT_EQ(parsed.solution, notify.solution);
+
+    EXPECT_EQ(JobZec(parsed, Target256::Max(), 1.0).notify_msg,
+              job.notify_msg);
+}
+
+TEST(StratumProxy, ForwardedHeaderMatchesPool)
+{
+    HashWrapper::InitVerusHash();
+
+    const UpstreamNotifyZec notify = MakeNotify();
+    JobZec job(notify, Target256::Max(), 1.0);
+    job.share_filter =
+        std::make_shared<ShareFilter>(ShareFilter::CapacityFor(0));
+
+    // the rig's nonce2 follows its extra nonce in the session's
+    const std::string nonce2 = "0a0b0c0d" + std::string(48, 'e');
+    const std::string solution = "fd4005" + std::string(2688, 'c');
+
+    ShareZec share;
+    share.worker = "rig1";
+    share.job_id = notify.job_id;
+    share.nonce2_sv = nonce2;
+    share.solution = solution;
+    share.time = notify.time + 1;
+
+    ShareResult res;
+    std::array<uint8_t, VrscStatic.BLOCK_HEADER_SIZE> proxy_header;
+    ASSERT_TRUE(ShareProcessor::Prepare<VrscStatic>(
+        res, UPSTREAM_NONCE1, proxy_header.data(), &job, share,
+        int64_t{notify.time} * 1000));
+
+    // as the pool reads the forwarded share
+    const std::string line = UpstreamSession::FormatSubmit(
+        7, "farm", job.id, proxy_header.data());
+    ScannedSubmit<5> submit;
+    ASSERT_TRUE(SubmitScanner::Scan(std::string_view(line).substr(
+                                        0, line.size() - 1),
+                                    "mining.submit", POOL_SIZES, submit));
+    EXPECT_EQ(submit.id, 7);
+    EXPECT_EQ(submit.params[0], "farm");
+    EXPECT_EQ(submit.params[1], notify.job_id);
+    EXPECT_EQ(submit.params[3], nonce2);
+    EXPECT_EQ(submit.params[4], solution);
+
+    ShareZec pool_share;
+    pool_share.nonce2_sv = submit.params[3];
+    pool_share.solution = submit.params[4];
+    std::from_chars(submit.params[2].data(),
+                    submit.params[2].data() + submit.params[2].size(),
+                    pool_share.time, 16);
+    pool_share.time = bswap_32(pool_share.time);
+
+    std::array<uint8_t, VrscStatic.BLOCK_HEADER_SIZE> pool_header;
+    ASSERT_TRUE(
+        job.GetHeaderData(pool_header.data(), pool_share, UPSTREAM_NONCE1));
+    EXPECT_EQ(pool_header, proxy_header);
+}
+
+// the pool end of an upstream session, on a local port
+class FakePool
+{
+   public:
+    static constexpr timeval TIMEOUT{.tv_sec = 5, .tv_usec = 0};
+
+    FakePool()
+    {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        socklen_t len = sizeof(addr);
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), len);
+        listen(listen_fd, 1);
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        // accept gives up too
+        setsockopt(listen_fd, SOL_SOCKET, SO_RCVTIMEO, &TIMEOUT,
+                   sizeof(TIMEOUT));
+    }
+
+    ~FakePool()
+    {
+        Drop();
+        close(listen_fd);
+    }
+
+    std::string Host() const { return "127.0.0.1:" + std::to_string(port); }
+
+    // takes the session's (re)connection, its extra nonce is nonce1_hex
+    bool Accept(std::string_view nonce1_hex)
+    {
+        conn_fd = accept(listen_fd, nullptr, nullptr);
+        if (conn_fd == -1) return false;
+        setsockopt(conn_fd, SOL_SOCKET, SO_RCVTIMEO, &TIMEOUT,
+                   sizeof(TIMEOUT));
+
+        // subscribe, authorize
+        if (ReadLine().empty() || ReadLine().empty()) return false;
+        const std::string replies =
+            "{\"id\":1,\"result\":[null,\"" + std::string(nonce1_hex) +
+            "\"],\"error\":null}\n{\"id\":2,\"result\":true,\"error\":null}\n";
+        return send(conn_fd, replies.data(), replies.size(), MSG_NOSIGNAL) ==
+               static_cast<ssize_t>(replies.size());
+    }
+
+    // the session reconnects
+    void Drop()
+    {
+        if (conn_fd != -1) close(conn_fd);
+        conn_fd = -1;
+        pending.clear();
+    }
+
+    // empty if nothing came in time
+    std::string ReadLine()
+    {
+        size_t end;
+        while ((end = pending.find('\n')) == std::string::npos)
+        {
+            char buff[4096];
+            const ssize_t got = recv(conn_fd, buff, sizeof(buff), 0);
+            if (got <= 0) return "";
+            pending.append(buff, got);
+        }
+
+        std::string line = pending.substr(0, end);
+        pending.erase(0, end + 1);
+        return line;
+    }
+
+   private:
+    int listen_fd;
+    int conn_fd = -1;
+    uint16_t port;
+    std::string pending;
+};
+
+static bool WaitForNonce1(const std::atomic<uint32_t>& nonce1, uint32_t want)
+{
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (nonce1.load() != want)
+    {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static UpstreamSession::Callbacks RecordNonce1(std::atomic<uint32_t>& nonce1)
+{
+    return UpstreamSession::Callbacks{
+        .on_subscribed = [&nonce1](uint32_t n) { nonce1.store(n); },
+        .on_target = [](const Target256&) {},
+        .on_notify = [](UpstreamNotifyZec&&) {}};
+}
+
+// a rig's share, hashed as the proxy does with its reactor's nonce1
+static bool PrepareShare(ProxyZec::ShareTaskT& task,
+                         std::shared_ptr<JobZec> job, uint32_t nonce1,
+                         const std::string& nonce2)
+{
+    static const std::string solution = "fd4005" + std::string(2688, 'c');
+
+    ShareZec share;
+    share.worker = "rig1";
+    share.job_id = job->id;
+    share.nonce2_sv = nonce2;
+    share.solution = solution;
+    share.time = job->min_time + 1;
+
+    task.cli = std::make_shared<StratumClient>(0, 1.0, 1.0, 30);
+    task.time_ms = int64_t{job->min_time} * 1000;
+    if (!ShareProcessor::Prepare<VrscStatic>(task.result, nonce1,
+                                             task.block_header.data(),
+                                             job.get(), share, task.time_ms))
+    {
+        return false;
+    }
+    task.job = std::move(job);
+
+    HashingContext ctx;
+    ProxyZec::ShareTaskT* tasks[] = {&task};
+    ShareProcessor::Hash<VrscStatic>(tasks, 1, &ctx.hasher);
+    return true;
+}
+
+TEST(StratumProxy, OnlyPoolSharesForwarded)
+{
+    HashWrapper::InitVerusHash();
+
+    FakePool pool;
+    std::atomic<uint32_t> nonce1{0};
+    UpstreamSession session(0, pool.Host(), "farm", RecordNonce1(nonce1));
+    ASSERT_TRUE(pool.Accept("11223344"));
+    ASSERT_TRUE(WaitForNonce1(nonce1, UPSTREAM_NONCE1));
+
+    const UpstreamNotifyZec notify = MakeNotify();
+    const auto filter =
+        std::make_shared<ShareFilter>(ShareFilter::CapacityFor(0));
+
+    // the rig's difficulty is 1, the pool's target no hash meets
+    auto hard_job = std::make_shared<JobZec>(notify, Target256(), 1.0);
+    hard_job->share_filter = filter;
+    ProxyZec::ShareTaskT local;
+    ASSERT_TRUE(PrepareShare(local, hard_job, UPSTREAM_NONCE1,
+                             std::string(56, 'a')));
+
+    EXPECT_EQ(ProxyZec::FinishShare(local, session).code, ResCode::OK);
+    EXPECT_EQ(session.Forwarded(), 0);
+
+    // every hash meets the pool's target
+    auto easy_job = std::make_shared<JobZec>(notify, Target256::Max(), 1.0);
+    easy_job->share_filter = filter;
+    ProxyZec::ShareTaskT forwarded;
+    ASSERT_TRUE(PrepareShare(forwarded, easy_job, UPSTREAM_NONCE1,
+                             std::string(56, 'b')));
+
+    EXPECT_EQ(ProxyZec::FinishShare(forwarded, session).code, ResCode::OK);
+    EXPECT_NE(pool.ReadLine().find(std::string(56, 'b')), std::string::npos);
+    EXPECT_EQ(session.Forwarded(), 1);
+}
+
+TEST(StratumProxy, JunkSharesDontFillFilter)
+{
+    HashWrapper::InitVerusHash();
+
+    FakePool pool;
+    std::atomic<uint32_t> nonce1{0};
+    UpstreamSession session(0, pool.Host(), "farm", RecordNonce1(nonce1));
+    ASSERT_TRUE(pool.Accept("11223344"));
+    ASSERT_TRUE(WaitForNonce1(nonce1, UPSTREAM_NONCE1));
+
+    // 16 slots, well below what either client sends
+    auto job = std::make_shared<JobZec>(MakeNotify(), Target256(), 1.0);
+    job->share_filter = std::make_shared<ShareFilter>(4);
+    const auto flooder = std::make_shared<StratumClient>(0, 1e30, 1.0, 30);
+
+    // no hash meets the flooder's difficulty, none is kept
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        ProxyZec::ShareTaskT junk;
+        ASSERT_TRUE(PrepareShare(junk, job, UPSTREAM_NONCE1,
+                                 fmt::format("{:056x}", i)));
+        junk.cli = flooder;
+        EXPECT_EQ(ProxyZec::FinishShare(junk, session).code,
+                  ResCode::LOW_DIFFICULTY_SHARE);
+    }
+    EXPECT_EQ(job->share_filter->Size(), 0);
+
+    // another client's shares, the same nonces included, all get in
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        ProxyZec::ShareTaskT share;
+        ASSERT_TRUE(PrepareShare(share, job, UPSTREAM_NONCE1,
+                                 fmt::format("{:056x}", i)));
+        EXPECT_EQ(ProxyZec::FinishShare(share, session).code, ResCode::OK);
+    }
+    EXPECT_EQ(job->share_filter->Size(), 64);
+    EXPECT_GT(job->share_filter->Overflowed(), 0);
+
+    // and are caught when replayed, the overflowed ones too
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        ProxyZec::ShareTaskT replay;
+        EXPECT_FALSE(PrepareShare(replay, job, UPSTREAM_NONCE1,
+                                  fmt::format("{:056x}", i)));
+        EXPECT_EQ(replay.result.code, ResCode::DUPLICATE_SHARE);
+    }
+}
+
+TEST(StratumProxy, StaleNonce1Dropped)
+{
+    HashWrapper::InitVerusHash();
+    constexpr uint32_t NEW_NONCE1 = 0x88776655;
+
+    FakePool pool;
+    std::atomic<uint32_t> nonce1{0};
+    UpstreamSession session(0, pool.Host(), "farm", RecordNonce1(nonce1));
+    ASSERT_TRUE(pool.Accept("11223344"));
+    ASSERT_TRUE(WaitForNonce1(nonce1, UPSTREAM_NONCE1));
+
+    auto job = std::make_shared<JobZec>(MakeNotify(), Target256::Max(), 1.0);
+    job->share_filter =
+        std::make_shared<ShareFilter>(ShareFilter::CapacityFor(0));
+
+    ProxyZec::ShareTaskT old_share;
+    ASSERT_TRUE(PrepareShare(old_share, job, UPSTREAM_NONCE1,
+                             std::string(56, 'a')));
+    session.Submit(job->id, old_share.block_header.data());
+    EXPECT_NE(pool.ReadLine().find(std::string(56, 'a')), std::string::npos);
+    EXPECT_EQ(session.Forwarded(), 1);
+
+    // resubscribed with another extra nonce
+    pool.Drop();
+    ASSERT_TRUE(pool.Accept("55667788"));
+    ASSERT_TRUE(WaitForNonce1(nonce1, NEW_NONCE1));
+
+    // hashed before the reactor was reset, the pool would reject it
+    session.Submit(job->id, old_share.block_header.data());
+
+    ProxyZec::ShareTaskT new_share;
+    ASSERT_TRUE(
+        PrepareShare(new_share, job, NEW_NONCE1, std::string(56, 'b')));
+    session.Submit(job->id, new_share.block_header.data());
+    // the next line the pool got is the new one
+    EXPECT_NE(pool.ReadLine().find(std::string(56, 'b')), std::string::npos);
+    EXPECT_EQ(session.Forwarded(), 2);
+}
+
+TEST(StratumProxy, StalledPoolDoesNotBlockReactor)
+{
+    HashWrapper::InitVerusHash();
+
+    FakePool pool;
+    std::atomic<uint32_t> nonce1{0};
+    UpstreamSession session(0, pool.Host(), "farm", RecordNonce1(nonce1));
+    ASSERT_TRUE(pool.Accept("11223344"));
+    ASSERT_TRUE(WaitForNonce1(nonce1, UPSTREAM_NONCE1));
+
+    // every hash meets the pool's target
+    auto job = std::make_shared<JobZec>(MakeNotify(), Target256::Max(), 1.0);
+    job->share_filter =
+        std::make_shared<ShareFilter>(ShareFilter::CapacityFor(0));
+    ProxyZec::ShareTaskT task;
+    ASSERT_TRUE(
+        PrepareShare(task, job, UPSTREAM_NONCE1, std::string(56, 'a')));
+
+    // the pool never reads, far more than both ends' socket buffers take
+    auto slowest = std::chrono::steady_clock::duration::zero();
+    for (int i = 0; i < 4096; i++)
+    {
+        // the same share, new to every filter
+        task.job->share_filter = std::make_shared<ShareFilter>(4);
+
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(ProxyZec::FinishShare(task, session).code, ResCode::OK);
+        slowest =
+            std::max(slowest, std::chrono::steady_clock::now() - start);
+    }
+
+    // a send waiting on the pool would have taken its timeout
+    EXPECT_LT(slowest, std::chrono::milliseconds(100));
+}
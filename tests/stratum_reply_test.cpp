@@ -0,0 +1,199 @@
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <string>
+
+#include "output_queue_test.hpp"
+#include "stratum/output_queue.hpp"
+#include "stratum/stratum_reply.hpp"
+
+// the replies as they were formatted before the encoder
+static std::string FormatReply(int64_t id, const RpcResult& res)
+{
+    if (res.code == ResCode::OK)
+    {
+        return fmt::format(
+            "{{\"id\":{},\"jsonrpc\":\"2.0\",\"error\":null,\"result\":{}}}\n",
+            id, res.Msg());
+    }
+    return fmt::format(
+        "{{\"id\":{},\"jsonrpc\":\"2.0\",\"result\":null,\"error\":[{},"
+        "\"{}\",null]}}\n",
+        id, (int)res.code, res.Msg());
+}
+
+static std::string EncodeReply(int64_t id, const RpcResult& res)
+{
+    std::string str(StratumReply::MaxSize(res.Msg().size()), '\0');
+    str.resize(StratumReply::Encode(str.data(), id, res.code, res.Msg()));
+    return str;
+}
+
+TEST(StratumReply, MatchesFormat)
+{
+    const RpcResult results[] = {
+        RpcResult(ResCode::OK),
+        RpcResult(ResCode::OK, std::string("[null,\"0a1b2c3d\"]")),
+        RpcResult(ResCode::DUPLICATE_SHARE, "Duplicate share"),
+        RpcResult(ResCode::JOB_NOT_FOUND, "Job not found"),
+        RpcResult(ResCode::LOW_DIFFICULTY_SHARE,
+                  fmt::format("Low difficulty share (Expected: {})", 1.5)),
+        RpcResult(ResCode::UNKNOWN, ""),
+    };
+    const int64_t ids[] = {0, 1, 42, -7, INT64_MAX, INT64_MIN};
+
+    for (const auto& res : results)
+    {
+        for (int64_t id : ids)
+        {
+            const std::string encoded = EncodeReply(id, res);
+            EXPECT_EQ(encoded, FormatReply(id, res));
+            EXPECT_LE(encoded.size(), StratumReply::MaxSize(res.Msg().size()));
+        }
+    }
+}
+
+TEST(StratumReply, RpcResultMessages)
+{
+    const RpcResult literal(ResCode::UNKNOWN, "Job not found");
+    EXPECT_EQ(literal.Msg(), "Job not found");
+
+    // a runtime buffer (only reachable through a pointer) is copied
+    char buff[16] = "Bad nonce";
+    const char* msg = buff;
+    const RpcResult copied(ResCode::UNKNOWN, msg);
+    buff[0] = 'X';
+    EXPECT_EQ(copied.Msg(), "Bad nonce");
+
+    EXPECT_EQ(RpcResult(ResCode::OK).Msg(), "true");
+    EXPECT_EQ(RpcResult(ResCode::UNKNOWN, "").Msg(), "");
+}
+
+TEST_F(OutputQueueTest, CorkedRepliesInOrder)
+{
+    OutputQueue queue;
+    std::string expected;
+
+    queue.Cork();
+    for (int64_t id = 0; id < 100; id++)
+    {
+        const RpcResult res = id % 3 ? RpcResult(ResCode::OK)
+                                     : RpcResult(ResCode::DUPLICATE_SHARE,
+                                                 "Duplicate share");
+        SendReply(queue, fds[0], id, res);
+        expected += FormatReply(id, res);
+    }
+
+    EXPECT_EQ(queue.Uncork(fds[0]), 0);
+    EXPECT_EQ(ReadAll(), expected);
+}
+
+// shares are hashed after the requests that follow them were answered, their
+// replies still go out in the requests' order
+TEST_F(OutputQueueTest, ReservedRepliesInOrder)
+{
+    OutputQueue queue;
+
+    const ReplySlot first = queue.Reserve();
+    queue.Write(fds[0], "b\n");
+    const ReplySlot second = queue.Reserve();
+    queue.Write(fds[0], "d\n");
+
+    // held back behind the first reply
+    EXPECT_EQ(ReadAll(), "");
+
+    EXPECT_EQ(queue.Fill(fds[0], second, "c\n"), 6);
+    EXPECT_EQ(ReadAll(), "");
+
+    EXPECT_EQ(queue.Fill(fds[0], first, "a\n"), 0);
+    EXPECT_EQ(ReadAll(), "a\nb\nc\nd\n");
+
+    // nothing open, straight to the socket again
+    EXPECT_EQ(queue.Write(fds[0], "e\n"), 0);
+    EXPECT_EQ(ReadAll(), "e\n");
+}
+
+TEST_F(OutputQueueTest, CorkedFillsInOneWrite)
+{
+    OutputQueue queue;
+    std::string expected;
+
+    ReplySlot slots[32];
+    for (int64_t id = 0; id < 32; id++)
+    {
+        slots[id] = queue.Reserve();
+    }
+
+    // a drain fills them in whatever order the workers finished
+    queue.Cork();
+    for (int64_t id = 31; id >= 0; id--)
+    {
+        char buff[StratumReply::STACK_SIZE];
+        const size_t len =
+            StratumReply::Encode(buff, id, ResCode::OK, "true");
+        queue.Fill(fds[0], slots[id], std::string_view(buff, len));
+    }
+    EXPECT_EQ(ReadAll(), "");
+
+    for (int64_t id = 0; id < 32; id++)
+    {
+        expected += FormatReply(id, RpcResult(ResCode::OK));
+    }
+    EXPECT_EQ(queue.Uncork(fds[0]), 0);
+    EXPECT_EQ(ReadAll(), expected);
+}
+
+// the io_uring engine sends what TakeSend hands out, one send at a time
+TEST_F(OutputQueueTest, ExternalSendsInOrder)
+{
+    OutputQueue queue;
+    queue.SetExternalSend();
+
+    // never straight to the socket
+    EXPECT_FALSE(queue.CanTakeSend());
+    EXPECT_EQ(queue.Write(fds[0], "a\n"), 2);
+    const ReplySlot slot = queue.Reserve();
+    queue.Write(fds[0], "c\n");
+    EXPECT_EQ(ReadAll(), "");
+
+    // up to the open slot
+    ASSERT_TRUE(queue.CanTakeSend());
+    std::string_view taken = queue.TakeSend();
+    EXPECT_EQ(taken, "a\n");
+    EXPECT_FALSE(queue.CanTakeSend());
+
+    // filled while the first is in flight, it waits for it
+    EXPECT_EQ(queue.Fill(fds[0], slot, "b\n"), 6);
+    EXPECT_FALSE(queue.CanTakeSend());
+    EXPECT_EQ(taken, "a\n");
+
+    ASSERT_EQ(send(fds[0], taken.data(), 1, 0), 1);
+    EXPECT_EQ(queue.SendDone(1), 5);
+
+    // the rest of a partial send goes first
+    ASSERT_TRUE(queue.CanTakeSend());
+    taken = queue.TakeSend();
+    EXPECT_EQ(taken, "\n");
+    ASSERT_EQ(send(fds[0], taken.data(), taken.size(), 0), 1);
+    EXPECT_EQ(queue.SendDone(1), 4);
+
+    taken = queue.TakeSend();
+    EXPECT_EQ(taken, "b\nc\n");
+    ASSERT_EQ(send(fds[0], taken.data(), taken.size(), 0), 4);
+    EXPECT_EQ(queue.SendDone(4), 0);
+    EXPECT_FALSE(queue.CanTakeSend());
+    EXPECT_EQ(ReadAll(), "a\nb\nc\n");
+
+    // corked writes wait for Uncork
+    queue.Cork();
+    queue.Write(fds[0], "d\n");
+    EXPECT_FALSE(queue.CanTakeSend());
+    EXPECT_EQ(queue.Uncork(fds[0]), 2);
+    EXPECT_EQ(queue.TakeSend(), "d\n");
+
+    // a failed send closes it
+    EXPECT_EQ(queue.SendDone(-EPIPE), SEND_ERROR);
+    EXPECT_FALSE(queue.CanTakeSend());
+    EXPECT_EQ(queue.Write(fds[0], "e\n"), SEND_ERROR);
+}
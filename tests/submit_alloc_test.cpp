@@ -0,0 +1,223 @@
+#include <byteswap.h>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "output_queue_test.hpp"
+#include "shares/share_processor.hpp"
+#include "static_config.hpp"
+#include "stratum/stratum_server.hpp"
+#include "stratum/submit_scanner.hpp"
+
+// every allocation of this binary's threads is counted, the tests compare
+// the count before and after. its own binary, so the other tests keep the
+// default allocator
+static thread_local size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    allocations++;
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+TEST_F(OutputQueueTest, SubmitReplyDoesNotAllocate)
+{
+    OutputQueue queue;
+
+    const auto burst = [&]
+    {
+        // straight to the socket
+        for (int64_t id = 0; id < 64; id++)
+        {
+            SendReply(queue, fds[0], id, RpcResult(ResCode::OK));
+        }
+
+        // queued while handling a read
+        queue.Cork();
+        for (int64_t id = 0; id < 64; id++)
+        {
+            SendReply(queue, fds[0], id, RpcResult(ResCode::OK));
+            SendReply(queue, fds[0], id,
+                      RpcResult(ResCode::DUPLICATE_SHARE, "Duplicate share"));
+            SendReply(queue, fds[0], id,
+                      RpcResult(ResCode::JOB_NOT_FOUND, "Job not found"));
+        }
+        return queue.Uncork(fds[0]);
+    };
+
+    // the queue's buffer grows to the burst once
+    ASSERT_EQ(burst(), 0);
+    ReadAll();
+
+    const size_t before = allocations;
+    const int64_t pending = burst();
+    const size_t after = allocations;
+
+    EXPECT_EQ(after, before);
+    EXPECT_EQ(pending, 0);
+}
+
+TEST_F(OutputQueueTest, ReservedReplyDoesNotAllocate)
+{
+    OutputQueue queue;
+
+    const auto burst = [&]
+    {
+        ReplySlot slots[64];
+        queue.Cork();
+        for (int64_t id = 0; id < 64; id++)
+        {
+            slots[id] = queue.Reserve();
+            SendReply(queue, fds[0], id,
+                      RpcResult(ResCode::JOB_NOT_FOUND, "Job not found"));
+        }
+        queue.Uncork(fds[0]);
+
+        queue.Cork();
+        for (int64_t id = 0; id < 64; id++)
+        {
+            char buff[StratumReply::STACK_SIZE];
+            const size_t len =
+                StratumReply::Encode(buff, id, ResCode::OK, "true");
+            queue.Fill(fds[0], slots[id], std::string_view(buff, len));
+        }
+        return queue.Uncork(fds[0]);
+    };
+
+    ASSERT_EQ(burst(), 0);
+    ReadAll();
+
+    const size_t before = allocations;
+    const int64_t pending = burst();
+    const size_t after = allocations;
+
+    EXPECT_EQ(after, before);
+    EXPECT_EQ(pending, 0);
+}
+
+// a vrsc submit the way StratumServerZec takes it: scanned, prepared into a
+// recycled task, batch hashed, verified and its reply filled into the slot
+// reserved for it. the stats and round bookkeeping of FinishShare aren't
+// part of it
+TEST_F(OutputQueueTest, SubmitPathDoesNotAllocate)
+{
+    using ShareTaskT = ShareTask<VrscStatic>;
+    using JobZec = Job<StratumProtocol::ZEC>;
+    static constexpr std::array<size_t, 5> SUBMIT_SIZES{0, 8, 8, 56, 2694};
+    static constexpr int64_t SHARES = 64;
+
+    HashWrapper::InitVerusHash();
+
+    UpstreamNotifyZec notify;
+    notify.job_id = "0000001a";
+    notify.version = 65540;
+    notify.time = 1650823041;
+    notify.bits = 0x1b083611;
+    notify.clean = true;
+    notify.solution = "0700000000000000" + std::string(128, '0');
+
+    // no hash meets a zero block target, every share is just a share
+    auto job = std::make_shared<JobZec>(notify, Target256(), 1.0);
+    job->share_filter =
+        std::make_shared<ShareFilter>(ShareFilter::CapacityFor(0));
+    auto cli = std::make_shared<StratumClient>(0, 1.0, 1.0, 30);
+    const int64_t time_ms = int64_t{notify.time} * 1000;
+
+    // a share is only accepted once, each burst gets its own
+    const std::string solution = "fd4005" + std::string(2688, 'c');
+    std::vector<std::string> requests;
+    for (int64_t id = 0; id < SHARES * 2; id++)
+    {
+        requests.push_back(fmt::format(
+            "{{\"id\":{},\"method\":\"mining.submit\",\"params\":[\"rig1\","
+            "\"{}\",\"{:08x}\",\"{:056x}\",\"{}\"]}}",
+            id, notify.job_id, bswap_32(notify.time + 1), id, solution));
+    }
+
+    OutputQueue queue;
+    ShareCompletions<ShareTaskT> completions;
+    HashingContext ctx;
+
+    const auto burst = [&](int64_t first)
+    {
+        for (int64_t i = first; i < first + SHARES; i++)
+        {
+            ScannedSubmit<5> submit;
+            if (!SubmitScanner::Scan(requests[i], "mining.submit",
+                                     SUBMIT_SIZES, submit))
+            {
+                return false;
+            }
+
+            ShareZec share;
+            share.worker = submit.params[0];
+            share.job_id = submit.params[1];
+            share.nonce2_sv = submit.params[3];
+            share.solution = submit.params[4];
+            std::from_chars(submit.params[2].data(),
+                            submit.params[2].data() + submit.params[2].size(),
+                            share.time, 16);
+            share.time = bswap_32(share.time);
+
+            std::unique_ptr<ShareTaskT> task = completions.TakeTask();
+            if (!ShareProcessor::Prepare<VrscStatic>(
+                    task->result, cli.get(), task->block_header.data(),
+                    job.get(), share, time_ms))
+            {
+                return false;
+            }
+            task->cli = cli;
+            task->req_id = submit.id;
+            task->reply_slot = queue.Reserve();
+            task->job = job;
+            completions.read_batch.push_back(task.release());
+        }
+
+        // what a hashing worker does with its pick up
+        ShareProcessor::Hash<VrscStatic>(completions.read_batch.data(),
+                                        completions.read_batch.size(),
+                                        &ctx.hasher);
+
+        queue.Cork();
+        for (ShareTaskT* raw : completions.read_batch)
+        {
+            std::unique_ptr<ShareTaskT> task(raw);
+            ShareProcessor::Verify<VrscStatic>(task->result, task->cli.get(),
+                                               task->job.get(), time_ms);
+            if (task->result.code != ResCode::VALID_SHARE) return false;
+
+            const RpcResult res(ResCode::OK);
+            char buff[StratumReply::STACK_SIZE];
+            const size_t len =
+                StratumReply::Encode(buff, task->req_id, res.code, res.Msg());
+            queue.Fill(fds[0], task->reply_slot, std::string_view(buff, len));
+            completions.ReturnTask(std::move(task));
+        }
+        completions.read_batch.clear();
+        return queue.Uncork(fds[0]) == 0;
+    };
+
+    // the spare tasks, the batches and the queue's buffer grow once
+    ASSERT_TRUE(burst(0));
+    ReadAll();
+
+    const size_t before = allocations;
+    const bool replied = burst(SHARES);
+    const size_t after = allocations;
+
+    EXPECT_TRUE(replied);
+    EXPECT_EQ(after, before);
+    const std::string replies = ReadAll();
+    EXPECT_EQ(std::count(replies.begin(), replies.end(), '\n'), SHARES);
+}
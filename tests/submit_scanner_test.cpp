@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "stratum/submit_scanner.hpp"
+
+static const std::string SOLUTION = "fd4005" + std::string(2688, 'a');
+static constexpr std::array<size_t, 5> ZEC_SIZES{0, 8, 8, 56, 2694};
+static constexpr std::array<size_t, 3> CN_SIZES{18, 66, 66};
+
+static std::string ZecSubmit(std::string_view id = "4")
+{
+    return "{\"id\":" + std::string(id) +
+           ",\"method\":\"mining.submit\",\"params\":[\"RSicKPooLFbBeWZEgVrAkCx"
+           "fAkPRQYwSnC.worker\",\"0000001a\",\"6e3b8b63\",\"" +
+           std::string(56, '0') + "\",\"" + SOLUTION + "\"]}";
+}
+
+TEST(SubmitScanner, Zec)
+{
+    // the views point into the request
+    const std::string req = ZecSubmit();
+    ScannedSubmit<5> res;
+    ASSERT_TRUE(SubmitScanner::Scan(req, "mining.submit", ZEC_SIZES, res));
+    EXPECT_EQ(res.id, 4);
+    EXPECT_FALSE(res.worker);
+    EXPECT_EQ(res.params[0], "RSicKPooLFbBeWZEgVrAkCxfAkPRQYwSnC.worker");
+    EXPECT_EQ(res.params[1], "0000001a");
+    EXPECT_EQ(res.params[2], "6e3b8b63");
+    EXPECT_EQ(res.params[3], std::string(56, '0'));
+    EXPECT_EQ(res.params[4], SOLUTION);
+
+    ScannedSubmit<5> neg;
+    ASSERT_TRUE(SubmitScanner::Scan(ZecSubmit("-9223372036854775808"),
+                                    "mining.submit", ZEC_SIZES, neg));
+    EXPECT_EQ(neg.id, INT64_MIN);
+}
+
+TEST(SubmitScanner, Cn)
+{
+    const std::string req =
+        "{\"id\":7,\"jsonrpc\":\"2.0\",\"method\":\"eth_submitWork\","
+        "\"worker\":\"rig1\",\"params\":[\"0x00000000deadbeef\",\"0x" +
+        std::string(64, 'b') + "\",\"0x" + std::string(64, 'c') + "\"]}";
+
+    ScannedSubmit<3> res;
+    ASSERT_TRUE(SubmitScanner::Scan(req, "eth_submitWork", CN_SIZES, res));
+    EXPECT_EQ(res.id, 7);
+    ASSERT_TRUE(res.worker);
+    EXPECT_EQ(*res.worker, "rig1");
+    EXPECT_EQ(res.params[0], "0x00000000deadbeef");
+    EXPECT_EQ(res.params[1], "0x" + std::string(64, 'b'));
+}
+
+TEST(SubmitScanner, OrderAndSpaces)
+{
+    const std::string req =
+        " { \"params\" : [ \"w\" , \"0000001a\",\"6e3b8b63\", \"" +
+        std::string(56, '0') + "\" ,\"" + SOLUTION +
+        "\"] , \"method\": \"mining.submit\",\t\"id\": 12 }\r";
+
+    ScannedSubmit<5> res;
+    ASSERT_TRUE(SubmitScanner::Scan(req, "mining.submit", ZEC_SIZES, res));
+    EXPECT_EQ(res.id, 12);
+    EXPECT_EQ(res.params[0], "w");
+}
+
+// everything the scanner doesn't fully understand goes to simdjson
+TEST(SubmitScanner, FallsBack)
+{
+    const std::string ok = ZecSubmit();
+    const auto replace = [&](std::string_view from, std::string_view to)
+    {
+        std::string res = ok;
+        res.replace(res.find(from), from.size(), to);
+        return res;
+    };
+
+    const std::string rejected[] = {
+        "",
+        ok.substr(0, ok.size() - 1),
+        ok.substr(0, 100),
+        ok + "x",
+        ok + "{}",
+        replace("\"id\":4", "\"id\":\"4\""),
+        replace("\"id\":4", "\"id\":null"),
+        replace("\"id\":4", "\"id\":4.5"),
+        replace("\"id\":4", "\"id\":1e3"),
+        replace("\"id\":4", "\"id\":99999999999999999999"),
+        replace("\"id\":4,", ""),
+        replace("\"id\":4", "\"id\":4,\"id\":5"),
+        replace("mining.submit", "mining.subscribe"),
+        replace(".worker", ".wor\\\"ker"),
+        replace("\"0000001a\"", "\"00001a\""),
+        replace("\"0000001a\"", "1"),
+        replace("\"6e3b8b63\",", ""),
+        replace("\"]}", "\",\"extra\"]}"),
+        replace("\"params\"", "\"extra\":1,\"params\""),
+    };
+
+    for (const std::string& req : rejected)
+    {
+        ScannedSubmit<5> res;
+        EXPECT_FALSE(
+            SubmitScanner::Scan(req, "mining.submit", ZEC_SIZES, res))
+            << req.substr(0, 120);
+    }
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "crypto/target256.hpp"
+#include "crypto/utils.hpp"
+#include "crypto/verushash/uint256.h"
+
+static const unsigned char* HashBytes(const uint256& hash)
+{
+    return hash.begin();
+}
+
+TEST(TargetTest, FromDiffEdges)
+{
+    ASSERT_EQ(Target256::FromDiff(1), Target256::Max());
+    ASSERT_EQ(Target256::FromDiff(0.5), Target256::Max());
+    ASSERT_EQ(Target256::FromDiff(2), Target256(arith_uint256(1) << 255));
+    ASSERT_EQ(Target256::FromDiff(1024), Target256(arith_uint256(1) << 246));
+}
+
+TEST(TargetTest, IsMetByBoundary)
+{
+    const arith_uint256 target = (arith_uint256(0x1234) << 200) + 77;
+    const Target256 t(target);
+
+    ASSERT_TRUE(t.IsMetBy(HashBytes(ArithToUint256(target))));
+    ASSERT_TRUE(t.IsMetBy(HashBytes(ArithToUint256(target - 1))));
+    ASSERT_FALSE(t.IsMetBy(HashBytes(ArithToUint256(target + 1))));
+    // decided by a lower word
+    const arith_uint256 above = target + (arith_uint256(1) << 64);
+    ASSERT_FALSE(t.IsMetBy(HashBytes(ArithToUint256(above))));
+    ASSERT_TRUE(
+        Target256::Max().IsMetBy(HashBytes(ArithToUint256(~arith_uint256()))));
+}
+
+TEST(TargetTest, FromDiffMatchesExact)
+{
+    for (uint64_t diff : {3ull, 1000ull, 123456789ull, 987654321987ull})
+    {
+        const arith_uint256 exact = ~arith_uint256() / arith_uint256(diff);
+        const Target256 t = Target256::FromDiff(static_cast<double>(diff));
+
+        // within the double's precision of the exact target
+        const arith_uint256 below = exact - (exact >> 40);
+        const arith_uint256 above = exact + (exact >> 40);
+        ASSERT_TRUE(t.IsMetBy(HashBytes(ArithToUint256(below)))) << diff;
+        ASSERT_FALSE(t.IsMetBy(HashBytes(ArithToUint256(above)))) << diff;
+    }
+}
+
+TEST(TargetTest, FromHex)
+{
+    const Target256 t = Target256::FromHex(
+        "0000000000ffff00000000000000000000000000000000000000000000000001");
+    const arith_uint256 target = (arith_uint256(0xffff) << 200) + 1;
+
+    ASSERT_EQ(t, Target256(target));
+    ASSERT_FALSE(t.IsMetBy(HashBytes(ArithToUint256(target + 1))));
+}
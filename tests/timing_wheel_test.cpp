@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "stratum/timing_wheel.hpp"
+
+using Wheel = TimingWheel<512>;
+
+class TimingWheelTest : public ::testing::Test
+{
+   protected:
+    // 1ms ticks, the test drives the clock from here on
+    Wheel wheel{1};
+    uint64_t start = Wheel::GetNowMs();
+    std::vector<TimerNode*> fired;
+
+    void SetUp() override { AdvanceTo(0); }
+
+    void AdvanceTo(uint64_t ms)
+    {
+        wheel.Advance(start + ms,
+                      [this](TimerNode* node) { fired.push_back(node); });
+    }
+};
+
+TEST_F(TimingWheelTest, FiresOnTime)
+{
+    TimerNode node;
+    wheel.Schedule(&node, 10);
+
+    AdvanceTo(9);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_TRUE(node.IsLinked());
+
+    AdvanceTo(10);
+    ASSERT_EQ(fired.size(), 1);
+    EXPECT_EQ(fired[0], &node);
+    EXPECT_FALSE(node.IsLinked());
+}
+
+TEST_F(TimingWheelTest, WrapsPastSlots)
+{
+    // the slot of 1000 is passed once before, at 488
+    TimerNode far;
+    TimerNode near;
+    wheel.Schedule(&far, 1000);
+    wheel.Schedule(&near, 1000 - 512);
+
+    AdvanceTo(488);
+    ASSERT_EQ(fired.size(), 1);
+    EXPECT_EQ(fired[0], &near);
+    EXPECT_TRUE(far.IsLinked());
+
+    AdvanceTo(999);
+    EXPECT_EQ(fired.size(), 1);
+
+    AdvanceTo(1000);
+    ASSERT_EQ(fired.size(), 2);
+    EXPECT_EQ(fired[1], &far);
+}
+
+TEST_F(TimingWheelTest, RearmMovesTimer)
+{
+    // what every readable event does to its connection's idle timer, each
+    // re-arm unlinks and links once, whatever's scheduled around it
+    std::vector<TimerNode> others(1000);
+    for (auto& other : others) wheel.Schedule(&other, 5000);
+
+    TimerNode node;
+    uint64_t delay = 0;
+    for (uint64_t i = 0; i < 100000; i++)
+    {
+        delay = 10 + i % 700;
+        wheel.Schedule(&node, delay);
+    }
+    AdvanceTo(delay - 1);
+    EXPECT_TRUE(fired.empty());
+
+    AdvanceTo(delay);
+    ASSERT_EQ(fired.size(), 1);
+    EXPECT_EQ(fired[0], &node);
+
+    wheel.Schedule(&node, 10);
+    wheel.Cancel(&node);
+    AdvanceTo(4999);
+    EXPECT_EQ(fired.size(), 1);
+
+    AdvanceTo(5000);
+    EXPECT_EQ(fired.size(), 1 + others.size());
+}
+
+TEST_F(TimingWheelTest, RearmFromCallback)
+{
+    TimerNode node;
+    int count = 0;
+    wheel.Schedule(&node, 1);
+
+    for (uint64_t ms = 1; ms <= 100; ms++)
+    {
+        wheel.Advance(start + ms,
+                      [&](TimerNode* fired_node)
+                      {
+                          count++;
+                          wheel.Schedule(fired_node, 1);
+                      });
+    }
+    EXPECT_EQ(count, 100);
+}
@@ -0,0 +1,178 @@
+#ifdef WITH_KTLS
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+#include "stratum/tls_acceptor.hpp"
+
+using HandshakeStatus = TlsAcceptor::HandshakeStatus;
+
+// a self signed p-256 certificate and its key, in the test's temp dir
+static TlsFiles WriteCertificate()
+{
+    const TlsFiles files{testing::TempDir() + "tls_acceptor_test.crt",
+                         testing::TempDir() + "tls_acceptor_test.key"};
+
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN",
+                               MBSTRING_ASC,
+                               reinterpret_cast<const uint8_t*>("localhost"),
+                               -1, -1, 0);
+    X509_set_issuer_name(cert, X509_get_subject_name(cert));
+    X509_sign(cert, key, EVP_sha256());
+
+    FILE* cert_file = fopen(files.cert_file.c_str(), "w");
+    PEM_write_X509(cert_file, cert);
+    fclose(cert_file);
+
+    FILE* key_file = fopen(files.key_file.c_str(), "w");
+    PEM_write_PrivateKey(key_file, key, nullptr, nullptr, 0, nullptr,
+                         nullptr);
+    fclose(key_file);
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return files;
+}
+
+class TlsAcceptorTest : public ::testing::Test
+{
+   protected:
+    TlsAcceptor acceptor{WriteCertificate()};
+    int client_fd = -1;
+    int server_fd = -1;
+
+    // a loopback tcp pair, kTLS is tcp only
+    void SetUp() override
+    {
+        const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        ASSERT_EQ(bind(listen_fd, reinterpret_cast<sockaddr*>(&addr),
+                       sizeof(addr)),
+                  0);
+        ASSERT_EQ(listen(listen_fd, 1), 0);
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+
+        client_fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(connect(client_fd, reinterpret_cast<sockaddr*>(&addr),
+                          sizeof(addr)),
+                  0);
+        server_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+        ASSERT_NE(server_fd, -1);
+        close(listen_fd);
+
+        fcntl(client_fd, F_SETFL, O_NONBLOCK);
+    }
+
+    void TearDown() override
+    {
+        close(client_fd);
+        close(server_fd);
+    }
+
+    // both sides in turns, as the reactor would on each readiness event
+    HandshakeStatus Handshake(SSL* client, ssl_st* server)
+    {
+        HandshakeStatus status = HandshakeStatus::PENDING;
+        for (int i = 0; i < 100 && status == HandshakeStatus::PENDING; i++)
+        {
+            SSL_do_handshake(client);
+            status = acceptor.Continue(server, "127.0.0.1");
+        }
+        return status;
+    }
+};
+
+TEST_F(TlsAcceptorTest, HandsTheKeysToTheKernel)
+{
+    SSL_CTX* client_ctx = SSL_CTX_new(TLS_client_method());
+    SSL* client = SSL_new(client_ctx);
+    SSL_set_fd(client, client_fd);
+    SSL_set_connect_state(client);
+
+    ssl_st* server = acceptor.Start(server_fd, "127.0.0.1");
+    ASSERT_NE(server, nullptr);
+
+    const HandshakeStatus status = Handshake(client, server);
+    EXPECT_TRUE(SSL_is_init_finished(client));
+
+    if (status == HandshakeStatus::DONE)
+    {
+        acceptor.Release(server);
+
+        // plain recv / send on the server side from here on
+        const std::string req = "{\"id\":1,\"method\":\"mining.subscribe\"}\n";
+        ASSERT_EQ(SSL_write(client, req.data(), req.size()),
+                  static_cast<int>(req.size()));
+
+        char buff[256];
+        ssize_t got = -1;
+        for (int i = 0; i < 1000 && got == -1; i++)
+        {
+            got = recv(server_fd, buff, sizeof(buff), 0);
+        }
+        EXPECT_EQ(std::string(buff, got), req);
+
+        const std::string res = "{\"id\":1,\"result\":true,\"error\":null}\n";
+        ASSERT_EQ(send(server_fd, res.data(), res.size(), 0),
+                  static_cast<ssize_t>(res.size()));
+
+        int read = -1;
+        for (int i = 0; i < 1000 && read <= 0; i++)
+        {
+            read = SSL_read(client, buff, sizeof(buff));
+        }
+        EXPECT_EQ(std::string(buff, read), res);
+    }
+    else
+    {
+        EXPECT_EQ(status, HandshakeStatus::FAILED);
+        acceptor.Release(server);
+    }
+
+    SSL_free(client);
+    SSL_CTX_free(client_ctx);
+
+    if (status != HandshakeStatus::DONE)
+    {
+        GTEST_SKIP() << "no kernel tls (modprobe tls)";
+    }
+}
+
+TEST_F(TlsAcceptorTest, RefusesPlaintext)
+{
+    ssl_st* server = acceptor.Start(server_fd, "127.0.0.1");
+    ASSERT_NE(server, nullptr);
+
+    const std::string req = "{\"id\":1,\"method\":\"mining.subscribe\"}\n";
+    ASSERT_EQ(send(client_fd, req.data(), req.size(), 0),
+              static_cast<ssize_t>(req.size()));
+
+    EXPECT_EQ(acceptor.Continue(server, "127.0.0.1"), HandshakeStatus::FAILED);
+    acceptor.Release(server);
+}
+
+TEST(TlsAcceptor, BadCertificate)
+{
+    EXPECT_THROW(TlsAcceptor(TlsFiles{"no.crt", "no.key"}),
+                 std::invalid_argument);
+}
+#endif